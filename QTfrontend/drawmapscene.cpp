@@ -336,34 +336,34 @@ QByteArray DrawMapScene::encode()
     return b;
 }
 
-void DrawMapScene::decode(QByteArray data)
+void DrawMapScene::decode(const QByteArray & data)
 {
     hideCursor();
 
     // Remember erasing mode
     bool erasing = m_isErasing;
 
-    // Use seperate for decoding the map, don't mess with the user pen
-    QPen load_pen = QPen(m_pen);
-
     oldItems.clear();
     oldPaths.clear();
     clear();
     paths.clear();
     m_specialPoints.clear();
 
+    // Read all points first, walking the data once, then create the
+    // scene items in one go. Points are 5 bytes: x, y (big endian) and flags.
+    const uchar * point = reinterpret_cast<const uchar *>(data.constData());
+    const uchar * end = point + data.size() - data.size() % 5;
+
+    QList<QPoint> specialPoints;
     PathParams params;
 
     bool isSpecial = true;
 
-    while(data.size() >= 5)
+    for(; point < end; point += 5)
     {
-        qint16 px = qFromBigEndian(*(qint16 *)data.data());
-        data.remove(0, 2);
-        qint16 py = qFromBigEndian(*(qint16 *)data.data());
-        data.remove(0, 2);
-        quint8 flags = *(quint8 *)data.data();
-        data.remove(0, 1);
+        qint16 px = qFromBigEndian<qint16>(point);
+        qint16 py = qFromBigEndian<qint16>(point + 2);
+        quint8 flags = point[4];
         //qDebug() << px << py;
         if(flags & 0x80)
         {
@@ -371,34 +371,18 @@ void DrawMapScene::decode(QByteArray data)
 
             if(params.points.size())
             {
-                addPath(pointsToPath(params.points), load_pen);
-
                 paths.prepend(params);
 
                 params.points.clear();
             }
 
-            quint8 penWidth = flags & 0x3f;
-            load_pen.setWidth(deserializePenWidth(penWidth));
+            params.width = flags & 0x3f;
             params.erasing = flags & 0x40;
-            if(params.erasing)
-                load_pen.setBrush(m_eraser);
-            else
-                load_pen.setBrush(m_brush);
-            params.width = penWidth;
         } else
             if(isSpecial)
             {
-                QPainterPath path;
-                path.addEllipse(QPointF(px, py), 10, 10);
-
-                addPath(path);
-
-                qint16 x = qToBigEndian(px);
-                qint16 y = qToBigEndian(py);
-                m_specialPoints.append((const char *)&x, 2);
-                m_specialPoints.append((const char *)&y, 2);
-                m_specialPoints.append((const char *)&flags, 1);
+                specialPoints.append(QPoint(px, py));
+                m_specialPoints.append(reinterpret_cast<const char *>(point), 5);
             }
 
         if(!isSpecial)
@@ -406,9 +390,28 @@ void DrawMapScene::decode(QByteArray data)
     }
 
     if(params.points.size())
-    {
-        addPath(pointsToPath(params.points), load_pen);
         paths.prepend(params);
+
+    foreach(const QPoint & p, specialPoints)
+    {
+        QPainterPath path;
+        path.addEllipse(p, 10, 10);
+
+        addPath(path);
+    }
+
+    // Use seperate for decoding the map, don't mess with the user pen
+    QPen load_pen = QPen(m_pen);
+
+    // paths are stored newest first, add them to the scene in drawing order
+    for(int i = paths.size() - 1; i >= 0; --i)
+    {
+        const PathParams & pp = paths.at(i);
+
+        load_pen.setWidth(deserializePenWidth(pp.width));
+        load_pen.setBrush(pp.erasing ? m_eraser : m_brush);
+
+        addPath(pointsToPath(pp.points), load_pen);
     }
 
     emit pathChanged();
@@ -457,7 +460,7 @@ int DrawMapScene::pointsCount()
     return cnt;
 }
 
-QPainterPath DrawMapScene::pointsToPath(const QList<QPoint> points)
+QPainterPath DrawMapScene::pointsToPath(const QList<QPoint> & points)
 {
     QPainterPath path;
 
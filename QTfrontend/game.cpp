@@ -568,15 +568,9 @@ void HWGame::FromNetError(const QString & msg)
 
 void HWGame::onClientRead()
 {
-    quint8 msglen;
-    quint32 bufsize;
-    while (!readbuffer.isEmpty() && ((bufsize = readbuffer.size()) > 0) &&
-            ((msglen = readbuffer.data()[0]) < bufsize))
-    {
-        QByteArray msg = readbuffer.left(msglen + 1);
-        readbuffer.remove(0, msglen + 1);
+    QByteArray msg;
+    while (takeMessage(msg))
         ParseMessage(msg);
-    }
 
     flushNetBuffer();
 }
@@ -598,8 +592,7 @@ QStringList HWGame::getArguments()
     QString nick = config->netNick().toUtf8().toBase64();
 
     arguments << "--internal"; //Must be passed as first argument
-    arguments << "--port";
-    arguments << QString("%1").arg(ipc_port);
+    arguments << ipcArguments();
 #ifdef _WIN32
     {
         QString path = datadir->absolutePath();
@@ -0,0 +1,110 @@
+/*
+ * Hedgewars, a free turn based strategy game
+ * Copyright (c) 2004-2018 Andrey Korotaev <unC0Rr@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/**
+ * @file
+ * @brief RoomsFilterProxyModel class implementation
+ */
+
+#include "roomslistmodel.h"
+#include "RoomsFilterProxyModel.h"
+
+RoomsFilterProxyModel::RoomsFilterProxyModel(QObject *parent)
+    : QSortFilterProxyModel(parent)
+{
+    showInLobby = true;
+    showInProgress = true;
+    showPassword = true;
+    showJoinRestricted = true;
+    showIncompatible = true;
+
+    setDynamicSortFilter(true);
+    setSortCaseSensitivity(Qt::CaseInsensitive);
+}
+
+bool RoomsFilterProxyModel::filterAcceptsRow(int sourceRow, const QModelIndex & sourceParent) const
+{
+    // cheap checks first, the search is the only one looking at text
+    QModelIndex index = sourceModel()->index(sourceRow, 0, sourceParent);
+
+    int flags = index.data(RoomsListModel::StateFlagsRole).toInt();
+    if (flags & RoomsListModel::InProgressFlag)
+    {
+        if (!showInProgress)
+            return false;
+    }
+    else if (!showInLobby)
+        return false;
+
+    if (!showPassword && (flags & RoomsListModel::PasswordFlag))
+        return false;
+    if (!showJoinRestricted && (flags & RoomsListModel::RestrictedFlag))
+        return false;
+
+    if (!showIncompatible && !index.data(RoomsListModel::CompatibleRole).toBool())
+        return false;
+
+    if (searchText.isEmpty())
+        return true;
+
+    return index.data(RoomsListModel::SearchKeyRole).toString().contains(searchText);
+}
+
+void RoomsFilterProxyModel::setFlag(bool & flag, bool value)
+{
+    if (flag == value)
+        return;
+
+    flag = value;
+    invalidateFilter();
+}
+
+void RoomsFilterProxyModel::setShowInLobby(bool show)
+{
+    setFlag(showInLobby, show);
+}
+
+void RoomsFilterProxyModel::setShowInProgress(bool show)
+{
+    setFlag(showInProgress, show);
+}
+
+void RoomsFilterProxyModel::setShowPassword(bool show)
+{
+    setFlag(showPassword, show);
+}
+
+void RoomsFilterProxyModel::setShowJoinRestricted(bool show)
+{
+    setFlag(showJoinRestricted, show);
+}
+
+void RoomsFilterProxyModel::setShowIncompatible(bool show)
+{
+    setFlag(showIncompatible, show);
+}
+
+void RoomsFilterProxyModel::setSearchText(const QString & text)
+{
+    QString lowerText = text.toLower();
+    if (lowerText == searchText)
+        return;
+
+    searchText = lowerText;
+    invalidateFilter();
+}
@@ -0,0 +1,64 @@
+/*
+ * Hedgewars, a free turn based strategy game
+ * Copyright (c) 2004-2018 Andrey Korotaev <unC0Rr@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/**
+ * @file
+ * @brief Class definition of RoomsFilterProxyModel
+ */
+
+#ifndef HEDGEWARS_ROOMSFILTERPROXYMODEL_H
+#define HEDGEWARS_ROOMSFILTERPROXYMODEL_H
+
+#include <QSortFilterProxyModel>
+
+/**
+ * @brief Filters and sorts a RoomsListModel for the rooms list page
+ *
+ * All filters of the page are checked in one filterAcceptsRow() call,
+ * using data that RoomsListModel precomputes for every room.
+ * With dynamic filtering enabled, a room update only re-checks the
+ * rows that changed.
+ */
+class RoomsFilterProxyModel : public QSortFilterProxyModel
+{
+        Q_OBJECT
+
+    public:
+        RoomsFilterProxyModel(QObject *parent = 0);
+        void setShowInLobby(bool show);
+        void setShowInProgress(bool show);
+        void setShowPassword(bool show);
+        void setShowJoinRestricted(bool show);
+        void setShowIncompatible(bool show);
+        void setSearchText(const QString & text);
+
+    protected:
+        bool filterAcceptsRow(int sourceRow, const QModelIndex &sourceParent) const;
+
+    private:
+        bool showInLobby;
+        bool showInProgress;
+        bool showPassword;
+        bool showJoinRestricted;
+        bool showIncompatible;
+        QString searchText; ///< lowercase, like RoomsListModel::SearchKeyRole
+
+        void setFlag(bool & flag, bool value);
+};
+
+#endif // HEDGEWARS_ROOMSFILTERPROXYMODEL_H
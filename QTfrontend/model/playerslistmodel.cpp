@@ -26,7 +26,10 @@
 
 
 PlayersListModel::PlayersListModel(QObject *parent) :
-    QAbstractListModel(parent)
+    QAbstractListModel(parent),
+    m_batchDepth(0),
+    m_changedFirst(-1),
+    m_changedLast(-1)
 {
     m_fontInRoom = QFont();
     m_fontInRoom.setItalic(true);
@@ -63,12 +66,60 @@ bool PlayersListModel::setData(const QModelIndex &index, const QVariant &value,
 
     m_data[index.row()].insert(role, value);
 
-    emit dataChanged(index, index);
+    rowChanged(index.row());
 
     return true;
 }
 
 
+void PlayersListModel::rowChanged(int row)
+{
+    if(m_batchDepth == 0)
+    {
+        emit dataChanged(index(row), index(row));
+        return;
+    }
+
+    if(m_changedFirst < 0)
+    {
+        m_changedFirst = row;
+        m_changedLast = row;
+    }
+    else
+    {
+        m_changedFirst = qMin(m_changedFirst, row);
+        m_changedLast = qMax(m_changedLast, row);
+    }
+}
+
+
+void PlayersListModel::flushChanges()
+{
+    if(m_changedFirst < 0)
+        return;
+
+    int first = m_changedFirst;
+    int last = m_changedLast;
+    m_changedFirst = -1;
+    m_changedLast = -1;
+
+    emit dataChanged(index(first), index(last));
+}
+
+
+void PlayersListModel::beginBatch()
+{
+    ++m_batchDepth;
+}
+
+
+void PlayersListModel::endBatch()
+{
+    if(m_batchDepth > 0 && --m_batchDepth == 0)
+        flushChanges();
+}
+
+
 bool PlayersListModel::insertRow(int row, const QModelIndex &parent)
 {
     return insertRows(row, 1, parent);
@@ -80,6 +131,9 @@ bool PlayersListModel::insertRows(int row, int count, const QModelIndex &parent)
     if(parent.isValid() || row > rowCount() || row < 0 || count < 1)
         return false;
 
+    // pending changes refer to row numbers before the insertion
+    flushChanges();
+
     beginInsertRows(parent, row, row + count - 1);
 
     for(int i = 0; i < count; ++i)
@@ -96,6 +150,8 @@ bool PlayersListModel::removeRows(int row, int count, const QModelIndex &parent)
     if(parent.isValid() || row + count > rowCount() || row < 0 || count < 1)
         return false;
 
+    flushChanges();
+
     beginRemoveRows(parent, row, row + count - 1);
 
     for(int i = 0; i < count; ++i)
@@ -130,6 +186,31 @@ void PlayersListModel::addPlayer(const QString & nickname, bool notify)
 }
 
 
+void PlayersListModel::addPlayers(const QStringList & nicknames, bool notify)
+{
+    if(nicknames.isEmpty())
+        return;
+
+    int first = rowCount();
+    insertRows(first, nicknames.size());
+
+    beginBatch();
+
+    for(int i = 0; i < nicknames.size(); ++i)
+    {
+        QModelIndex mi = index(first + i);
+        setData(mi, nicknames[i]);
+
+        checkFriendIgnore(mi);
+    }
+
+    endBatch();
+
+    foreach(const QString & nickname, nicknames)
+        emit nickAddedLobby(nickname, notify);
+}
+
+
 void PlayersListModel::removePlayer(const QString & nickname, const QString &msg)
 {
     if(msg.isEmpty())
@@ -57,8 +57,13 @@ public:
 
     QModelIndex nicknameIndex(const QString & nickname);
 
+    // dataChanged() of rows modified between these calls is emitted once, at the end
+    void beginBatch();
+    void endBatch();
+
 public slots:
     void addPlayer(const QString & nickname, bool notify);
+    void addPlayers(const QStringList & nicknames, bool notify);
     void removePlayer(const QString & nickname, const QString & msg = QString());
     void playerJoinedRoom(const QString & nickname, bool notify);
     void playerLeftRoom(const QString & nickname);
@@ -80,9 +85,13 @@ private:
     QString m_nickname;
     QFont m_fontInRoom;
     QSet<QString> m_ignoredIpHashes;
+    int m_batchDepth;
+    int m_changedFirst, m_changedLast; // rows changed during batch, -1 if none
     // QString m_salt; // Removed
     QHash<QString, QString> m_playerIpMap; // To store IP HASH for nicknames
 
+    void rowChanged(int row);
+    void flushChanges();
     void updateIcon(const QModelIndex & index);
     void updateSortData(const QModelIndex & index);
     void loadSet(QSet<QString> & set, const QString & suffix);
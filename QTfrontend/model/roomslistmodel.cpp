@@ -31,7 +31,10 @@
 
 RoomsListModel::RoomsListModel(QObject *parent) :
     QAbstractTableModel(parent),
-    c_nColumns(10)
+    c_nColumns(10),
+    m_batchDepth(0),
+    m_changedFirst(-1),
+    m_changedLast(-1)
 {
     m_headerData = QStringList();
     m_headerData << tr("In progress");
@@ -49,6 +52,9 @@ RoomsListModel::RoomsListModel(QObject *parent) :
 
     m_staticMapModel = DataManager::instance().staticMapModel();
     m_missionMapModel = DataManager::instance().missionMapModel();
+
+    connect(m_staticMapModel, SIGNAL(modelReset()), this, SLOT(updateMapAvailability()));
+    connect(m_missionMapModel, SIGNAL(modelReset()), this, SLOT(updateMapAvailability()));
 }
 
 
@@ -66,7 +72,7 @@ int RoomsListModel::rowCount(const QModelIndex & parent) const
     if(parent.isValid())
         return 0;
     else
-        return m_data.size();
+        return m_rooms.size();
 }
 
 
@@ -142,13 +148,20 @@ QVariant RoomsListModel::data(const QModelIndex &index, int role) const
         return QVariant();
 
     // invalid row
-    if ((row < 0) || (row >= m_data.size()))
+    if ((row < 0) || (row >= m_rooms.size()))
         return QVariant();
 
     // invalid column
     if ((column < 0) || (column >= c_nColumns))
         return QVariant();
 
+    if (role == StateFlagsRole)
+        return m_rooms.at(rowToPos(row)).stateFlags;
+    if (role == CompatibleRole)
+        return m_rooms.at(rowToPos(row)).compatible;
+    if (role == SearchKeyRole)
+        return m_rooms.at(rowToPos(row)).searchKey;
+
     // not a role we have data for
     if (role != Qt::DisplayRole)
         // only custom-align counters
@@ -157,68 +170,22 @@ QVariant RoomsListModel::data(const QModelIndex &index, int role) const
                 // only decorate name column
                 if ((role != Qt::DecorationRole) || (column != NameColumn))
                     if ((role != Qt::ForegroundRole))
-                        // UserRole is used for version column filtering
-                        if ((role != Qt::UserRole))
-                            return QVariant();
+                        return QVariant();
+
+    const Room & room = m_rooms.at(rowToPos(row));
 
     // decorate room name based on room state
     if (role == Qt::DecorationRole)
-    {
-        const QIcon roomBusyIcon(":/res/iconDamage.png");
-        const QIcon roomBusyIconGreen(":/res/iconDamageLockG.png");
-        const QIcon roomBusyIconRed(":/res/iconDamageLockR.png");
-        const QIcon roomWaitingIcon(":/res/iconTime.png");
-        const QIcon roomWaitingIconGreen(":/res/iconTimeLockG.png");
-        const QIcon roomWaitingIconRed(":/res/iconTimeLockR.png");
-
-        QString flags = m_data.at(row).at(StateColumn);
-
-        if (flags.contains("g"))
-        {
-            if (flags.contains("j"))
-                return QVariant(roomBusyIconRed);
-            else if (flags.contains("p"))
-                return QVariant(roomBusyIconGreen);
-            else
-                return QVariant(roomBusyIcon);
-        }
-        else
-        {
-            if (flags.contains("j"))
-                return QVariant(roomWaitingIconRed);
-            else if (flags.contains("p"))
-                return QVariant(roomWaitingIconGreen);
-            else
-                return QVariant(roomWaitingIcon);
-        }
-    }
+        return QVariant(stateIcons().at(room.stateIcon));
 
-    QString content = m_data.at(row).at(column);
+    const QString & content = room.column(column);
 
     if (role == Qt::DisplayRole)
     {
-        // display room names
-        if (column == 5)
-        {
-            // special names
-            if (content[0] == '+')
-            {
-                if (content == "+rnd+") return tr("Random Map");
-                if (content == "+maze+") return tr("Random Maze");
-                if (content == "+perlin+") return tr("Random Perlin");
-                if (content == "+drawn+") return tr("Hand-drawn");
-                if (content == "+forts+") return tr("Forts");
-            }
-
-            // prefix ? if map not available
-            if (!m_staticMapModel->mapExists(content) &&
-                !m_missionMapModel->mapExists(content))
-                return QString ("? %1").arg(content);
-        }
+        if (column == MapColumn)
+            return room.mapText;
         else if (column == VersionColumn)
-        {
-            return protoToVersion(content);
-        }
+            return room.versionText;
 
         return content;
     }
@@ -226,22 +193,12 @@ QVariant RoomsListModel::data(const QModelIndex &index, int role) const
     // dye map names red if map not available
     if (role == Qt::ForegroundRole)
     {
-        if (m_data[row][VersionColumn] != *cProtoVer)
+        if (!room.compatible)
             return QBrush(QColor("darkgrey"));
 
-        if (column == MapColumn)
-        {
-            if (content == "+rnd+" ||
-                content == "+maze+" ||
-                content == "+perlin+" ||
-                content == "+drawn+" ||
-                content == "+forts+" ||
-                m_staticMapModel->mapExists(content) ||
-                m_missionMapModel->mapExists(content))
-                return QVariant();
-            else
-                return QBrush(QColor("darkred"));
-        }
+        if ((column == MapColumn) && !room.mapAvailable)
+            return QBrush(QColor("darkred"));
+
         return QVariant();
     }
 
@@ -250,36 +207,160 @@ QVariant RoomsListModel::data(const QModelIndex &index, int role) const
         return (int)(Qt::AlignHCenter | Qt::AlignVCenter);
     }
 
-    if (role == Qt::UserRole && column == VersionColumn)
-        return content;
-
     Q_ASSERT(false);
     return QVariant();
 }
 
 
-void RoomsListModel::setRoomsList(const QStringList & rooms)
+const QVector<QIcon> & RoomsListModel::stateIcons()
 {
-    beginResetModel();
+    // order matches Room::stateIcon computed in updateDerivedData()
+    static const QVector<QIcon> icons = QVector<QIcon>()
+        << QIcon(":/res/iconTime.png")
+        << QIcon(":/res/iconTimeLockG.png")
+        << QIcon(":/res/iconTimeLockR.png")
+        << QIcon(":/res/iconDamage.png")
+        << QIcon(":/res/iconDamageLockG.png")
+        << QIcon(":/res/iconDamageLockR.png");
+
+    return icons;
+}
+
+
+bool RoomsListModel::isMapAvailable(const QString & map)
+{
+    return map == "+rnd+" ||
+           map == "+maze+" ||
+           map == "+perlin+" ||
+           map == "+drawn+" ||
+           map == "+forts+" ||
+           m_staticMapModel->mapExists(map) ||
+           m_missionMapModel->mapExists(map);
+}
+
+
+// Computes everything data() would otherwise have to work out on each call.
+void RoomsListModel::updateDerivedData(Room & room)
+{
+    room.stateFlags = 0;
+    if (room.flags.contains("g"))
+        room.stateFlags |= InProgressFlag;
+    if (room.flags.contains("p"))
+        room.stateFlags |= PasswordFlag;
+    if (room.flags.contains("j"))
+        room.stateFlags |= RestrictedFlag;
+
+    // busy rooms come after waiting ones, then no lock, password, restricted
+    room.stateIcon = (room.stateFlags & InProgressFlag) ? 3 : 0;
+    if (room.stateFlags & RestrictedFlag)
+        room.stateIcon += 2;
+    else if (room.stateFlags & PasswordFlag)
+        room.stateIcon += 1;
+
+    room.compatible = (room.version == *cProtoVer);
+    room.mapAvailable = isMapAvailable(room.map);
+    room.versionText = protoToVersion(room.version);
+
+    if (room.map == "+rnd+") room.mapText = tr("Random Map");
+    else if (room.map == "+maze+") room.mapText = tr("Random Maze");
+    else if (room.map == "+perlin+") room.mapText = tr("Random Perlin");
+    else if (room.map == "+drawn+") room.mapText = tr("Hand-drawn");
+    else if (room.map == "+forts+") room.mapText = tr("Forts");
+    // prefix ? if map not available
+    else if (!room.mapAvailable) room.mapText = QString("? %1").arg(room.map);
+    else room.mapText = room.map;
+
+    // the search box matches the displayed text of the visible columns,
+    // separated so that a search can't match across two of them
+    room.searchKey = (QStringList()
+        << room.name << room.clients << room.teams << room.owner
+        << room.mapText << room.script << room.scheme << room.weapons
+        << room.versionText).join('\n').toLower();
+}
+
+
+void RoomsListModel::updateMapAvailability()
+{
+    if (m_rooms.isEmpty())
+        return;
 
-    m_data.clear();
+    for (int pos = 0; pos < m_rooms.size(); ++pos)
+        updateDerivedData(m_rooms[pos]);
 
-    int nRooms = rooms.size();
+    emit dataChanged(index(0, 0), index(m_rooms.size() - 1, c_nColumns - 1));
+}
+
+
+void RoomsListModel::rowChanged(int row)
+{
+    if (m_batchDepth == 0)
+    {
+        emit dataChanged(index(row, 0), index(row, c_nColumns - 1));
+        return;
+    }
 
-    for (int i = 0; i < nRooms; i += c_nColumns)
+    if (m_changedFirst < 0)
+    {
+        m_changedFirst = row;
+        m_changedLast = row;
+    }
+    else
     {
-        QStringList l;
+        m_changedFirst = qMin(m_changedFirst, row);
+        m_changedLast = qMax(m_changedLast, row);
+    }
+}
+
+
+void RoomsListModel::flushChanges()
+{
+    if (m_changedFirst < 0)
+        return;
+
+    int first = m_changedFirst;
+    int last = m_changedLast;
+    m_changedFirst = -1;
+    m_changedLast = -1;
+
+    emit dataChanged(index(first, 0), index(last, c_nColumns - 1));
+}
+
+
+void RoomsListModel::beginBatch()
+{
+    ++m_batchDepth;
+}
+
+
+void RoomsListModel::endBatch()
+{
+    if (m_batchDepth > 0 && --m_batchDepth == 0)
+        flushChanges();
+}
+
+
+void RoomsListModel::setRoomsList(const QStringList & rooms)
+{
+    // whole model is reset anyway
+    m_changedFirst = -1;
+    m_changedLast = -1;
+
+    beginResetModel();
 
-#if QT_VERSION >= QT_VERSION_CHECK(4, 7, 0)
-        l.reserve(c_nColumns);  // small optimisation not supported in old Qt
-#endif
+    int nRooms = rooms.size() / c_nColumns;
 
-        for (int t = 0; t < c_nColumns; t++)
-        {
-            l.append(rooms[i + t]);
-        }
+    m_rooms.clear();
+    m_rooms.resize(nRooms);
+    m_roomPos.clear();
+    m_roomPos.reserve(nRooms);
 
-        m_data.append(l);
+    // the server lists rooms newest first
+    for (int row = 0; row < nRooms; ++row)
+    {
+        int pos = rowToPos(row);
+        m_rooms[pos].set(rooms, row * c_nColumns);
+        updateDerivedData(m_rooms[pos]);
+        m_roomPos.insert(m_rooms[pos].name, pos);
     }
 
     endResetModel();
@@ -288,9 +369,16 @@ void RoomsListModel::setRoomsList(const QStringList & rooms)
 
 void RoomsListModel::addRoom(const QStringList & info)
 {
+    // pending changes refer to row numbers before the insertion
+    flushChanges();
+
     beginInsertRows(QModelIndex(), 0, 0);
 
-    m_data.prepend(info);
+    Room room;
+    room.set(info);
+    updateDerivedData(room);
+    m_roomPos.insert(room.name, m_rooms.size());
+    m_rooms.append(room);
 
     endInsertRows();
 }
@@ -298,35 +386,34 @@ void RoomsListModel::addRoom(const QStringList & info)
 
 int RoomsListModel::rowOfRoom(const QString & name)
 {
-    int size = m_data.size();
+    int pos = m_roomPos.value(name, -1);
 
-    if (size < 1)
+    if (pos < 0)
         return -1;
 
-    int i = 0;
-
-    // search for record with matching room name
-    while(m_data[i].at(NameColumn) != name)
-    {
-        i++;
-        if(i >= size)
-            return -1;
-    }
-
-    return i;
+    return posToRow(pos);
 }
 
 
 void RoomsListModel::removeRoom(const QString & name)
 {
-    int i = rowOfRoom(name);
+    int pos = m_roomPos.value(name, -1);
 
-    if (i < 0)
+    if (pos < 0)
         return;
 
+    int i = posToRow(pos);
+
+    flushChanges();
+
     beginRemoveRows(QModelIndex(), i, i);
 
-    m_data.removeAt(i);
+    m_roomPos.remove(name);
+    m_rooms.remove(pos);
+
+    // only rooms newer than the removed one move
+    for (int p = pos; p < m_rooms.size(); ++p)
+        m_roomPos[m_rooms[p].name] = p;
 
     endRemoveRows();
 }
@@ -334,12 +421,54 @@ void RoomsListModel::removeRoom(const QString & name)
 
 void RoomsListModel::updateRoom(const QString & name, const QStringList & info)
 {
-    int i = rowOfRoom(name);
+    int pos = m_roomPos.value(name, -1);
 
-    if (i < 0)
+    if (pos < 0)
         return;
 
-    m_data[i] = info;
+    Room & room = m_rooms[pos];
+    room.set(info);
+    updateDerivedData(room);
+
+    // room might have been renamed
+    if (room.name != name)
+    {
+        m_roomPos.remove(name);
+        m_roomPos.insert(room.name, pos);
+    }
+
+    rowChanged(posToRow(pos));
+}
+
+
+void RoomsListModel::Room::set(const QStringList & info, int offset)
+{
+    flags = info[offset + StateColumn];
+    name = info[offset + NameColumn];
+    clients = info[offset + PlayerCountColumn];
+    teams = info[offset + TeamCountColumn];
+    owner = info[offset + OwnerColumn];
+    map = info[offset + MapColumn];
+    script = info[offset + ScriptColumn];
+    scheme = info[offset + SchemeColumn];
+    weapons = info[offset + WeaponsColumn];
+    version = info[offset + VersionColumn];
+}
+
 
-    emit dataChanged(index(i, 0), index(i, columnCount(QModelIndex()) - 1));
+const QString & RoomsListModel::Room::column(int column) const
+{
+    switch (column)
+    {
+        case StateColumn: return flags;
+        case NameColumn: return name;
+        case PlayerCountColumn: return clients;
+        case TeamCountColumn: return teams;
+        case OwnerColumn: return owner;
+        case MapColumn: return map;
+        case ScriptColumn: return script;
+        case SchemeColumn: return scheme;
+        case WeaponsColumn: return weapons;
+        default: return version;
+    }
 }
@@ -25,7 +25,10 @@
 #define HEDGEWARS_ROOMSLISTMODEL_H
 
 #include <QAbstractTableModel>
+#include <QHash>
+#include <QIcon>
 #include <QStringList>
+#include <QVector>
 
 #include "DataManager.h"
 
@@ -48,6 +51,19 @@ public:
         VersionColumn,
     };
 
+    // roles used by RoomsFilterProxyModel, valid for any column of a row
+    enum Role {
+        StateFlagsRole = Qt::UserRole + 1, ///< combination of StateFlag values
+        CompatibleRole,                    ///< same protocol version as ours
+        SearchKeyRole                      ///< lowercase text matched by the search box
+    };
+
+    enum StateFlag {
+        InProgressFlag = 1,
+        PasswordFlag = 2,
+        RestrictedFlag = 4
+    };
+
     explicit RoomsListModel(QObject *parent = 0);
 
     QVariant headerData(int section, Qt::Orientation orientation, int role) const;
@@ -56,6 +72,10 @@ public:
     int columnCountSupported() const { return c_nColumns; };
     QVariant data(const QModelIndex &index, int role) const;
 
+    // dataChanged() of rooms updated between these calls is emitted once, at the end
+    void beginBatch();
+    void endBatch();
+
 public slots:
     void setRoomsList(const QStringList & rooms);
     void addRoom(const QStringList & info);
@@ -63,12 +83,55 @@ public slots:
     void updateRoom(const QString & name, const QStringList & info);
     int rowOfRoom(const QString & name);
 
+private slots:
+    void updateMapAvailability();
+
 private:
+    /// room record as announced by the server
+    struct Room
+    {
+        QString flags;
+        QString name;
+        QString clients;
+        QString teams;
+        QString owner;
+        QString map;
+        QString script;
+        QString scheme;
+        QString weapons;
+        QString version;
+
+        // derived from the fields above when the room is set
+        int stateIcon;       ///< index into stateIcons()
+        int stateFlags;      ///< combination of StateFlag values
+        bool compatible;     ///< same protocol version as ours
+        bool mapAvailable;   ///< map is special or installed locally
+        QString mapText;     ///< map column display text
+        QString versionText; ///< version column display text
+        QString searchKey;   ///< lowercase displayed columns, for searching
+
+        void set(const QStringList & info, int offset = 0);
+        const QString & column(int column) const;
+    };
+
     const int c_nColumns;
-    QList<QStringList> m_data;
+    // rooms are stored oldest first, while row 0 shows the newest one,
+    // so adding a room doesn't shift the stored positions of the others
+    QVector<Room> m_rooms;
+    QHash<QString, int> m_roomPos; ///< room name -> position in m_rooms
     QStringList m_headerData;
     MapModel * m_staticMapModel;
     MapModel * m_missionMapModel;
+    int m_batchDepth;
+    int m_changedFirst, m_changedLast; // rows changed during batch, -1 if none
+
+    int rowToPos(int row) const { return m_rooms.size() - 1 - row; }
+    int posToRow(int pos) const { return m_rooms.size() - 1 - pos; }
+    void rowChanged(int row);
+    void flushChanges();
+    void updateDerivedData(Room & room);
+    bool isMapAvailable(const QString & map);
+    static const QVector<QIcon> & stateIcons();
     static QString protoToVersion(const QString & proto);
 };
 
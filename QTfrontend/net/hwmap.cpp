@@ -20,9 +20,30 @@
 #include <QPainter>
 #include <QBitmap>
 #include <QLinearGradient>
+#include <QThread>
 
 #include "hwconsts.h"
 #include "hwmap.h"
+#include "proto.h"
+#include "MapPreviewCache.h"
+
+// Previews are rendered by several engines at once, each one connecting to
+// its own IPC port. Requests exceeding the pool size wait in previewQueue.
+static QList<HWMap*> runningList;
+static QList<HWMap*> previewQueue;
+// time from request to result of the previews rendered by the engine
+static qint64 totalLatency = 0;
+static int numRendered = 0;
+
+static int maxPreviews()
+{
+#ifdef HWLIBRARY
+    // engine library is not reentrant
+    return 1;
+#else
+    return qMax(1, QThread::idealThreadCount());
+#endif
+}
 
 HWMap::HWMap(QObject * parent) :
     TCPBase(false, false, parent)
@@ -31,10 +52,64 @@ HWMap::HWMap(QObject * parent) :
     m_mapgen = MAPGEN_REGULAR;
     m_maze_size = 0;
     m_feature_size = 50;
+    m_running = false;
+
+#ifndef HWLIBRARY
+    listenPrivately();
+#endif
 }
 
 HWMap::~HWMap()
 {
+    previewQueue.removeOne(this);
+    finishPreview();
+}
+
+int HWMap::runningPreviews()
+{
+    return runningList.size();
+}
+
+int HWMap::queuedPreviews()
+{
+    return previewQueue.size();
+}
+
+int HWMap::averageLatency()
+{
+    return numRendered > 0 ? int(totalLatency / numRendered) : 0;
+}
+
+void HWMap::startPreview()
+{
+    m_running = true;
+    runningList.append(this);
+    Start(true);
+}
+
+void HWMap::finishPreview()
+{
+    if(!m_running)
+        return;
+
+    m_running = false;
+    runningList.removeOne(this);
+
+    startQueuedPreviews();
+}
+
+// The widget asked for another preview, this one isn't needed anymore:
+// stop its engine and give its slot to the next preview right away.
+void HWMap::cancelPreview()
+{
+    finishPreview();
+    Abort();
+}
+
+void HWMap::startQueuedPreviews()
+{
+    while((runningList.size() < maxPreviews()) && !previewQueue.isEmpty())
+        previewQueue.takeFirst()->startPreview();
 }
 
 bool HWMap::couldBeRemoved()
@@ -52,15 +127,52 @@ void HWMap::getImage(const QString & seed, int filter, MapGenerator mapgen, int
     m_maze_size = maze_size;
     m_feature_size = feature_size;
     if(mapgen == MAPGEN_DRAWN) m_drawMapData = drawMapData;
-    Start(true);
+
+    // queued requests of the same widget are outdated now, drop them
+    QMutableListIterator<HWMap*> it(previewQueue);
+    while(it.hasNext())
+    {
+        HWMap * map = it.next();
+        if(map->parent() == parent())
+        {
+            it.remove();
+            map->deleteLater();
+        }
+    }
+
+#ifndef HWLIBRARY
+    // and so are running ones (the engine library can't be stopped,
+    // it only runs one preview at a time anyway)
+    foreach(HWMap * map, QList<HWMap*>(runningList))
+    {
+        if((map != this) && (map->parent() == parent()))
+            map->cancelPreview();
+    }
+#endif
+
+    m_latency.start();
+
+    m_config = previewConfig();
+    m_cacheKey = MapPreviewCache::key(m_config);
+    QByteArray preview;
+    if(MapPreviewCache::instance().find(m_cacheKey, preview))
+    {
+        emitPreview(preview);
+        deleteLater();
+        return;
+    }
+
+    if(runningList.size() < maxPreviews())
+        startPreview();
+    else
+        previewQueue.append(this);
 }
 
 QStringList HWMap::getArguments()
 {
     QStringList arguments;
     arguments << "--internal";
-    arguments << "--port";
-    arguments << QString("%1").arg(ipc_port);
+    arguments << ipcArguments();
     arguments << "--user-prefix";
     arguments << cfgdir->absolutePath();
     arguments << "--prefix";
@@ -70,14 +182,32 @@ QStringList HWMap::getArguments()
 }
 
 void HWMap::onClientDisconnect()
-{    
+{
+    finishPreview();
+
+    if ((readbuffer.size() == 128 * 32 + 1) || (readbuffer.size() == 128 * 256 + 1))
+    {
+        totalLatency += m_latency.elapsed();
+        numRendered++;
+#ifdef QT_DEBUG
+        qDebug("Map preview took %lld ms (%d running, %d queued)",
+               m_latency.elapsed(), runningList.size(), previewQueue.size());
+#endif
+
+        MapPreviewCache::instance().insert(m_cacheKey, readbuffer);
+        emitPreview(readbuffer);
+    }
+}
+
+void HWMap::emitPreview(const QByteArray & preview)
+{
     QLinearGradient linearGrad(QPoint(128, 0), QPoint(128, 128));
     linearGrad.setColorAt(1, QColor(0, 0, 192));
     linearGrad.setColorAt(0, QColor(66, 115, 225));
 
-    if (readbuffer.size() == 128 * 32 + 1)
+    if (preview.size() == 128 * 32 + 1)
     {
-        quint8 *buf = (quint8*) readbuffer.constData();
+        quint8 *buf = (quint8*) preview.constData();
         QImage im(buf, 256, 128, QImage::Format_Mono);
         im.setColorCount(2);
 
@@ -94,14 +224,14 @@ void HWMap::onClientDisconnect()
 
         emit HHLimitReceived(buf[128 * 32]);
         emit ImageReceived(px);
-    } else if (readbuffer.size() == 128 * 256 + 1)
+    } else if (preview.size() == 128 * 256 + 1)
     {
         QVector<QRgb> colorTable;
         colorTable.resize(256);
         for(int i = 0; i < 256; ++i)
             colorTable[i] = qRgba(255, 255, 0, i);
 
-        const quint8 *buf = (const quint8*) readbuffer.constData();
+        const quint8 *buf = (const quint8*) preview.constData();
         QImage im(buf, 256, 128, QImage::Format_Indexed8);
         im.setColorTable(colorTable);
 
@@ -117,40 +247,40 @@ void HWMap::onClientDisconnect()
     }
 }
 
-void HWMap::SendToClientFirst()
+QByteArray HWMap::previewConfig() const
 {
-    SendIPC(QString("eseed %1").arg(m_seed).toUtf8());
-    SendIPC(QString("e$template_filter %1").arg(templateFilter).toUtf8());
-    SendIPC(QString("e$mapgen %1").arg(m_mapgen).toUtf8());
-    SendIPC(QString("e$feature_size %1").arg(m_feature_size).toUtf8());
+    QByteArray config;
+
+    HWProto::addStringToBuffer(config, QString("eseed %1").arg(m_seed));
+    HWProto::addStringToBuffer(config, QString("e$template_filter %1").arg(templateFilter));
+    HWProto::addStringToBuffer(config, QString("e$mapgen %1").arg(m_mapgen));
+    HWProto::addStringToBuffer(config, QString("e$feature_size %1").arg(m_feature_size));
     if (!m_script.isEmpty())
     {
-        SendIPC(QString("escript Scripts/Multiplayer/%1.lua").arg(m_script).toUtf8());
-        SendIPC(QString("e$scriptparam %1").arg(m_scriptparam).toUtf8());
+        HWProto::addStringToBuffer(config, QString("escript Scripts/Multiplayer/%1.lua").arg(m_script));
+        HWProto::addStringToBuffer(config, QString("e$scriptparam %1").arg(m_scriptparam));
     }
 
     switch (m_mapgen)
     {
         case MAPGEN_MAZE:
         case MAPGEN_PERLIN:
-            SendIPC(QString("e$maze_size %1").arg(m_maze_size).toUtf8());
+            HWProto::addStringToBuffer(config, QString("e$maze_size %1").arg(m_maze_size));
             break;
 
         case MAPGEN_DRAWN:
-        {
-            QByteArray data = m_drawMapData;
-            while(data.size() > 0)
-            {
-                QByteArray tmp = data;
-                tmp.truncate(200);
-                SendIPC("edraw " + tmp);
-                data.remove(0, 200);
-            }
+            HWProto::addDrawnMapToBuffer(config, m_drawMapData);
             break;
-        }
+
         default:
             ;
     }
 
-    SendIPC("!");
+    return config;
+}
+
+void HWMap::SendToClientFirst()
+{
+    HWProto::addStringToBuffer(m_config, "!");
+    RawSendIPC(m_config);
 }
@@ -23,6 +23,7 @@
 #include <QByteArray>
 #include <QString>
 #include <QPixmap>
+#include <QElapsedTimer>
 
 #include "tcpBase.h"
 
@@ -46,6 +47,11 @@ class HWMap : public TCPBase
         void getImage(const QString & seed, int templateFilter, MapGenerator mapgen, int maze_size, const QByteArray & drawMapData, QString & script, QString & scriptparam, int feature_size);
         bool couldBeRemoved();
 
+        // for the statistics on the options page
+        static int runningPreviews();
+        static int queuedPreviews();
+        static int averageLatency(); ///< in ms, of the previews the engine rendered
+
     protected:
         virtual QStringList getArguments();
         virtual void onClientDisconnect();
@@ -64,6 +70,18 @@ class HWMap : public TCPBase
         int m_maze_size;  // going to try and deprecate this one
         int m_feature_size;
         QByteArray m_drawMapData;
+        bool m_running;
+        QElapsedTimer m_latency;
+        QByteArray m_config; ///< messages sent to the engine, see previewConfig()
+        QByteArray m_cacheKey;
+
+        QByteArray previewConfig() const;
+        void emitPreview(const QByteArray & preview);
+
+        void startPreview();
+        void finishPreview();
+        void cancelPreview();
+        static void startQueuedPreviews();
 
     private slots:
 };
@@ -22,8 +22,7 @@ QStringList HWMapOptimizer::getArguments()
 {
     QStringList arguments;
     arguments << "--internal";
-    arguments << "--port";
-    arguments << QString("%1").arg(ipc_port);
+    arguments << ipcArguments();
     arguments << "--user-prefix";
     arguments << cfgdir->absolutePath();
     arguments << "--prefix";
@@ -42,6 +42,9 @@ HWNewNet::HWNewNet() :
     m_private_game = false;
     m_nick_registered = false;
     m_demo_data_pending = false;
+    m_reading = false;
+    m_readCalls = 0;
+    m_readMessages = 0;
 
     m_roomsListModel = new RoomsListModel(this);
 
@@ -67,8 +70,6 @@ HWNewNet::HWNewNet() :
     connect(&NetSocket, SIGNAL(disconnected()), this, SLOT(OnDisconnect()));
     connect(&NetSocket, SIGNAL(error(QAbstractSocket::SocketError)), this,
             SLOT(displayError(QAbstractSocket::SocketError)));
-
-    connect(this, SIGNAL(messageProcessed()), this, SLOT(ClientRead()), Qt::QueuedConnection);
 }
 
 HWNewNet::~HWNewNet()
@@ -200,13 +201,28 @@ void HWNewNet::RawSendNet(const QString & str)
 
 void HWNewNet::RawSendNet(const QByteArray & buf)
 {
+#ifdef QT_DEBUG
     qDebug() << "Client: " << QString(QString::fromUtf8(buf)).split("\n");
+#endif
     NetSocket.write(buf);
     NetSocket.write("\n\n", 2);
 }
 
 void HWNewNet::ClientRead()
 {
+    // a message handler might run a nested event loop (e.g. a message box),
+    // the outer loop picks up whatever arrives meanwhile
+    if (m_reading)
+        return;
+
+    m_reading = true;
+
+    // model updates are signalled once per read, not once per message
+    m_roomsListModel->beginBatch();
+    m_playersModel->beginBatch();
+
+    int messages = 0;
+
     while (NetSocket.canReadLine())
     {
         QString s = QString::fromUtf8(NetSocket.readLine());
@@ -216,12 +232,27 @@ void HWNewNet::ClientRead()
         {
             ParseCmd(cmdbuf);
             cmdbuf.clear();
-            emit messageProcessed();
-            return ;
+            ++messages;
         }
         else
             cmdbuf << s;
     }
+
+    m_playersModel->endBatch();
+    m_roomsListModel->endBatch();
+
+    m_reading = false;
+
+    if (messages > 0)
+    {
+        ++m_readCalls;
+        m_readMessages += messages;
+#ifdef QT_DEBUG
+        if (messages > 1)
+            qDebug("Net: %d messages in one read (%.1f on average)",
+                   messages, (double)m_readMessages / m_readCalls);
+#endif
+    }
 }
 
 void HWNewNet::OnConnect()
@@ -282,7 +313,9 @@ void HWNewNet::ContinueConnection()
 
 void HWNewNet::ParseCmd(const QStringList & lst)
 {
+#ifdef QT_DEBUG
     qDebug() << "Server: " << lst;
+#endif
 
     if(!lst.size())
     {
@@ -290,490 +323,530 @@ void HWNewNet::ParseCmd(const QStringList & lst)
         return;
     }
 
-    if (lst[0] == "NICK")
-    {
-        mynick = lst[1];
-        m_playersModel->setNickname(mynick);
-        m_nick_registered = false;
-        return ;
-    }
+    static const QHash<QString, CommandHandler> commands = commandHandlers();
+
+    CommandHandler handler = commands.value(lst[0], &HWNewNet::handleUnknown);
+    (this->*handler)(lst);
+}
+
+QHash<QString, HWNewNet::CommandHandler> HWNewNet::commandHandlers()
+{
+    QHash<QString, CommandHandler> commands;
+
+    commands.insert("ADD_TEAM", &HWNewNet::handleAddTeam);
+    commands.insert("ASKPASSWORD", &HWNewNet::handleAskPassword);
+    commands.insert("BANLIST", &HWNewNet::handleBanList);
+    commands.insert("BYE", &HWNewNet::handleBye);
+    commands.insert("CF", &HWNewNet::handleClientFlags);
+    commands.insert("CFG", &HWNewNet::handleCfg);
+    commands.insert("CHAT", &HWNewNet::handleChat);
+    commands.insert("CLIENT_FLAGS", &HWNewNet::handleClientFlags);
+    commands.insert("CONNECTED", &HWNewNet::handleConnected);
+    commands.insert("EM", &HWNewNet::handleEm);
+    commands.insert("ERROR", &HWNewNet::handleError);
+    commands.insert("HH_NUM", &HWNewNet::handleHhNum);
+    commands.insert("INFO", &HWNewNet::handleInfo);
+    commands.insert("JOINED", &HWNewNet::handleJoined);
+    commands.insert("JOINING", &HWNewNet::handleJoining);
+    commands.insert("KICKED", &HWNewNet::handleKicked);
+    commands.insert("LEFT", &HWNewNet::handleLeft);
+    commands.insert("LOBBY:JOINED", &HWNewNet::handleLobbyJoined);
+    commands.insert("LOBBY:LEFT", &HWNewNet::handleLobbyLeft);
+    commands.insert("NICK", &HWNewNet::handleNick);
+    commands.insert("NOTICE", &HWNewNet::handleNotice);
+    commands.insert("PING", &HWNewNet::handlePing);
+    commands.insert("PROTO", &HWNewNet::handleProto);
+    commands.insert("REDIRECT", &HWNewNet::handleRedirect);
+    commands.insert("REMOVE_TEAM", &HWNewNet::handleRemoveTeam);
+    commands.insert("REPLAY_START", &HWNewNet::handleReplayStart);
+    commands.insert("ROOM", &HWNewNet::handleRoom);
+    commands.insert("ROOMABANDONED", &HWNewNet::handleRoomAbandoned);
+    commands.insert("ROOMS", &HWNewNet::handleRooms);
+    commands.insert("ROUND_FINISHED", &HWNewNet::handleRoundFinished);
+    commands.insert("RUN_GAME", &HWNewNet::handleRunGame);
+    commands.insert("SERVER_AUTH", &HWNewNet::handleServerAuth);
+    commands.insert("SERVER_MESSAGE", &HWNewNet::handleServerMessage);
+    commands.insert("SERVER_VARS", &HWNewNet::handleServerVars);
+    commands.insert("TEAM_ACCEPTED", &HWNewNet::handleTeamAccepted);
+    commands.insert("TEAM_COLOR", &HWNewNet::handleTeamColor);
+    commands.insert("WARNING", &HWNewNet::handleWarning);
+
+    return commands;
+}
+
+bool HWNewNet::inRoomState()
+{
+    return netClientState == InRoom || netClientState == InGame;
+}
+
+void HWNewNet::handleUnknown(const QStringList & lst)
+{
+    qWarning() << "Net: Unknown message or wrong state:" << lst;
+}
+
+void HWNewNet::handleNick(const QStringList & lst)
+{
+    mynick = lst[1];
+    m_playersModel->setNickname(mynick);
+    m_nick_registered = false;
+}
+
+void HWNewNet::handleProto(const QStringList & lst)
+{
+    Q_UNUSED(lst);
+}
+
+void HWNewNet::handleError(const QStringList & lst)
+{
+    if (lst.size() == 2)
+        emit Error(HWApplication::translate("server", lst[1].toLatin1().constData()));
+    else
+        emit Error("Unknown error");
+}
 
-    if (lst[0] == "PROTO")
-        return ;
+void HWNewNet::handleWarning(const QStringList & lst)
+{
+    if (lst.size() == 2)
+        emit Warning(HWApplication::translate("server", lst[1].toLatin1().constData()));
+    else
+        emit Warning("Unknown warning");
+}
 
-    if (lst[0] == "ERROR")
+void HWNewNet::handleRedirect(const QStringList & lst)
+{
+    if (lst.size() < 2 || lst[1].toInt() == 0)
     {
-        if (lst.size() == 2)
-            emit Error(HWApplication::translate("server", lst[1].toLatin1().constData()));
-        else
-            emit Error("Unknown error");
+        qWarning("Net: Malformed REDIRECT message");
         return;
     }
 
-    if (lst[0] == "WARNING")
+    quint16 port = lst[1].toInt();
+    if (port == 0)
     {
-        if (lst.size() == 2)
-            emit Warning(HWApplication::translate("server", lst[1].toLatin1().constData()));
-        else
-            emit Warning("Unknown warning");
-        return;
+        qWarning() << "Invalid redirection port";
     }
+    else
+    {
+        netClientState = Redirected;
+        emit redirected(port);
+    }
+}
 
-    if (lst[0] == "REDIRECT")
-    {        
-        if (lst.size() < 2 || lst[1].toInt() == 0)
-        {
-            qWarning("Net: Malformed REDIRECT message");
-            return;            
-        }
-
-        quint16 port = lst[1].toInt();
-        if (port == 0) 
-        {
-            qWarning() << "Invalid redirection port";            
-        }
-        else 
-        {
-            netClientState = Redirected;
-            emit redirected(port);
-        }
+void HWNewNet::handleConnected(const QStringList & lst)
+{
+    if(lst.size() < 3 || lst[2].toInt() < cMinServerVersion)
+    {
+        // TODO: Warn user, disconnect
+        qWarning() << "Server too old";
+        RawSendNet(QString("QUIT%1%2").arg(delimiter).arg("Server too old"));
+        Disconnect();
+        emit disconnected(tr("The server is too old. Disconnecting now."));
         return;
     }
 
-    if (lst[0] == "CONNECTED")
+    ClientState lastState = netClientState;
+    netClientState = Connected;
+    if (lastState != Redirected)
     {
-        if(lst.size() < 3 || lst[2].toInt() < cMinServerVersion)
-        {
-            // TODO: Warn user, disconnect
-            qWarning() << "Server too old";
-            RawSendNet(QString("QUIT%1%2").arg(delimiter).arg("Server too old"));
-            Disconnect();
-            emit disconnected(tr("The server is too old. Disconnecting now."));
-            return;
-        }
+        ContinueConnection();
+    }
+}
 
-        ClientState lastState = netClientState;
-        netClientState = Connected;      
-        if (lastState != Redirected)
-        {
-            ContinueConnection();
-        }
+void HWNewNet::handleServerAuth(const QStringList & lst)
+{
+    if(lst.size() < 2)
+    {
+        qWarning("Net: Malformed SERVER_AUTH message");
         return;
     }
 
-    if (lst[0] == "SERVER_AUTH")
+    if(lst[1] != m_serverHash)
     {
-        if(lst.size() < 2)
-        {
-            qWarning("Net: Malformed SERVER_AUTH message");
-            return;
-        }
+        Error("Server authentication error");
+        Disconnect();
+    } else
+    {
+        // empty m_serverHash variable means no authentication was performed
+        // or server passed authentication
+        m_serverHash.clear();
+    }
+}
 
-        if(lst[1] != m_serverHash)
-        {
-            Error("Server authentication error");
-            Disconnect();
-        } else
-        {
-            // empty m_serverHash variable means no authentication was performed
-            // or server passed authentication
-            m_serverHash.clear();
-        }
+void HWNewNet::handlePing(const QStringList & lst)
+{
+    if (lst.size() > 1)
+        RawSendNet(QString("PONG%1%2").arg(delimiter).arg(lst[1]));
+    else
+        RawSendNet(QString("PONG"));
+}
 
+void HWNewNet::handleRooms(const QStringList & lst)
+{
+    if(lst.size() % m_roomsListModel->columnCountSupported() != 1)
+    {
+        qWarning("Net: Malformed ROOMS message");
         return;
     }
-
-    if (lst[0] == "PING")
+    m_roomsListModel->setRoomsList(lst.mid(1));
+    if (m_private_game == false && m_nick_registered == false)
     {
-        if (lst.size() > 1)
-            RawSendNet(QString("PONG%1%2").arg(delimiter).arg(lst[1]));
-        else
-            RawSendNet(QString("PONG"));
-        return;
+        emit NickNotRegistered(mynick);
     }
+}
 
-    if (lst[0] == "ROOMS")
+void HWNewNet::handleServerMessage(const QStringList & lst)
+{
+    if(lst.size() < 2)
     {
-        if(lst.size() % m_roomsListModel->columnCountSupported() != 1)
-        {
-            qWarning("Net: Malformed ROOMS message");
-            return;
-        }
-        m_roomsListModel->setRoomsList(lst.mid(1));
-        if (m_private_game == false && m_nick_registered == false)
-        {
-            emit NickNotRegistered(mynick);
-        }
+        qWarning("Net: Empty SERVERMESSAGE message");
         return;
     }
+    emit serverMessage(lst[1]);
+}
 
-    if (lst[0] == "SERVER_MESSAGE")
+void HWNewNet::handleChat(const QStringList & lst)
+{
+    if(lst.size() < 3)
     {
-        if(lst.size() < 2)
-        {
-            qWarning("Net: Empty SERVERMESSAGE message");
-            return;
-        }
-        emit serverMessage(lst[1]);
+        qWarning("Net: Empty CHAT message");
         return;
     }
 
-    if (lst[0] == "CHAT")
+    QString action;
+    QString message;
+    QString sender = lst[1];
+    // '[' is a special character used in fake nick names of server messages.
+    // Those are supposed to be translated
+    if(!sender.startsWith('['))
     {
-        if(lst.size() < 3)
+        // Normal message
+        message = lst[2];
+        // Another kind of fake nick. '(' nicks are server messages, but they must not be translated
+        if(!sender.startsWith('('))
         {
-            qWarning("Net: Empty CHAT message");
-            return;
-        }
-
-        QString action;
-        QString message;
-        QString sender = lst[1];
-        // '[' is a special character used in fake nick names of server messages.
-        // Those are supposed to be translated
-        if(!sender.startsWith('['))
-        {
-            // Normal message
-            message = lst[2];
-            // Another kind of fake nick. '(' nicks are server messages, but they must not be translated
-            if(!sender.startsWith('('))
-            {
-                // Check for action (/me command)
-                action = HWProto::chatStringToAction(message);
-            }
-            else
-            {
-                // If parenthesis were used, replace them with square brackets
-                // for a consistent style.
-                sender.replace(0, 1, '[');
-                sender.replace(sender.length()-1, 1, ']');
-            }
+            // Check for action (/me command)
+            action = HWProto::chatStringToAction(message);
         }
         else
         {
-            // Server message
-            // Server messages are translated client-side
-            message = HWApplication::translate("server", lst[2].toLatin1().constData());
+            // If parenthesis were used, replace them with square brackets
+            // for a consistent style.
+            sender.replace(0, 1, '[');
+            sender.replace(sender.length()-1, 1, ']');
         }
+    }
+    else
+    {
+        // Server message
+        // Server messages are translated client-side
+        message = HWApplication::translate("server", lst[2].toLatin1().constData());
+    }
 
-        if (netClientState == InLobby)
-        {
-            if (!action.isNull())
-                emit lobbyChatAction(sender, action);
-            else
-                emit lobbyChatMessage(sender, message);
-        }
+    if (netClientState == InLobby)
+    {
+        if (!action.isNull())
+            emit lobbyChatAction(sender, action);
         else
-        {
-            emit chatStringFromNet(HWProto::formatChatMsg(sender, message));
-            if (!action.isNull())
-                emit roomChatAction(sender, action);
-            else
-                emit roomChatMessage(sender, message);
-        }
-        return;
+            emit lobbyChatMessage(sender, message);
+    }
+    else
+    {
+        emit chatStringFromNet(HWProto::formatChatMsg(sender, message));
+        if (!action.isNull())
+            emit roomChatAction(sender, action);
+        else
+            emit roomChatMessage(sender, message);
     }
+}
 
-    if (lst[0] == "INFO")
+void HWNewNet::handleInfo(const QStringList & lst)
+{
+    if(lst.size() < 5)
     {
-        if(lst.size() < 5)
-        {
-            qWarning("Net: Malformed INFO message");
-            return;
-        }
-        emit playerInfo(lst[1], lst[2], lst[3], lst[4]);
-        if (netClientState != InLobby)
-        {
-            QStringList tmp = lst;
-            tmp.removeFirst();
-            emit chatStringFromNet(tmp.join(" ").prepend('\x01'));
-        }
+        qWarning("Net: Malformed INFO message");
         return;
     }
+    emit playerInfo(lst[1], lst[2], lst[3], lst[4]);
+    if (netClientState != InLobby)
+    {
+        emit chatStringFromNet(lst.mid(1).join(" ").prepend('\x01'));
+    }
+}
 
-    if (lst[0] == "SERVER_VARS")
+void HWNewNet::handleServerVars(const QStringList & lst)
+{
+    for (int i = 1; i + 1 < lst.size(); i += 2)
     {
-        QStringList tmp = lst;
-        tmp.removeFirst();
-        while (tmp.size() >= 2)
-        {
-            if(tmp[0] == "MOTD_NEW") emit serverMessageNew(tmp[1]);
-            else if(tmp[0] == "MOTD_OLD") emit serverMessageOld(tmp[1]);
-            else if(tmp[0] == "LATEST_PROTO") emit latestProtocolVar(tmp[1].toInt());
+        const QString & name = lst[i];
+        const QString & value = lst[i + 1];
 
-            tmp.removeFirst();
-            tmp.removeFirst();
-        }
-        return;
+        if(name == "MOTD_NEW") emit serverMessageNew(value);
+        else if(name == "MOTD_OLD") emit serverMessageOld(value);
+        else if(name == "LATEST_PROTO") emit latestProtocolVar(value.toInt());
     }
+}
+
+void HWNewNet::handleBanList(const QStringList & lst)
+{
+    emit bansList(lst.mid(1));
+}
 
-    if (lst[0] == "BANLIST")
+void HWNewNet::handleClientFlags(const QStringList & lst)
+{
+    if(lst.size() < 3 || lst[1].size() < 2)
     {
-        QStringList tmp = lst;
-        tmp.removeFirst();
-        emit bansList(tmp);
+        qWarning("Net: Malformed CLIENT_FLAGS message");
         return;
     }
 
-    if (lst[0] == "CLIENT_FLAGS" || lst[0] == "CF")
-    {
-        if(lst.size() < 3 || lst[1].size() < 2)
-        {
-            qWarning("Net: Malformed CLIENT_FLAGS message");
-            return;
-        }
+    const QString & flags = lst[1];
+    bool setFlag = flags[0] == '+';
+    const QStringList nicks = lst.mid(2);
+    bool inRoom = inRoomState();
 
-        QString flags = lst[1];
-        bool setFlag = flags[0] == '+';
-        const QStringList nicks = lst.mid(2);
+    for(int f = 1; f < flags.size(); ++f)
+    {
+        char c = flags[f].toLatin1();
 
-        while(flags.size() > 1)
+        switch(c)
         {
-            flags.remove(0, 1);
-            char c = flags[0].toLatin1();
-            bool inRoom = (netClientState == InRoom || netClientState == InGame);
-
-            switch(c)
-            {
-                // flag indicating if a player is ready to start a game
-                case 'r':
-                    if(inRoom)
-                        foreach (const QString & nick, nicks)
+            // flag indicating if a player is ready to start a game
+            case 'r':
+                if(inRoom)
+                    foreach (const QString & nick, nicks)
+                    {
+                        if (nick == mynick)
                         {
-                            if (nick == mynick)
-                            {
-                                emit setMyReadyStatus(setFlag);
-                            }
-                            m_playersModel->setFlag(nick, PlayersListModel::Ready, setFlag);
+                            emit setMyReadyStatus(setFlag);
                         }
-                        break;
-
-                // flag indicating if a player is a registered user
-                case 'u':
-                        foreach(const QString & nick, nicks)
-                            m_playersModel->setFlag(nick, PlayersListModel::Registered, setFlag);
-                        break;
-                // flag indicating if a player is in room
-                case 'i':
-                        foreach(const QString & nick, nicks)
-                            m_playersModel->setFlag(nick, PlayersListModel::InRoom, setFlag);
-                        break;
-                // flag indicating if a player is contributor
-                case 'c':
-                        foreach(const QString & nick, nicks)
-                            m_playersModel->setFlag(nick, PlayersListModel::Contributor, setFlag);
-                        break;
-                // flag indicating if a player has engine running
-                case 'g':
-                    if(inRoom)
-                        foreach(const QString & nick, nicks)
-                            m_playersModel->setFlag(nick, PlayersListModel::InGame, setFlag);
-                        break;
-
-                // flag indicating if a player is the host/master of the room
-                case 'h':
-                    if(inRoom)
-                        foreach (const QString & nick, nicks)
+                        m_playersModel->setFlag(nick, PlayersListModel::Ready, setFlag);
+                    }
+                    break;
+
+            // flag indicating if a player is a registered user
+            case 'u':
+                    foreach(const QString & nick, nicks)
+                        m_playersModel->setFlag(nick, PlayersListModel::Registered, setFlag);
+                    break;
+            // flag indicating if a player is in room
+            case 'i':
+                    foreach(const QString & nick, nicks)
+                        m_playersModel->setFlag(nick, PlayersListModel::InRoom, setFlag);
+                    break;
+            // flag indicating if a player is contributor
+            case 'c':
+                    foreach(const QString & nick, nicks)
+                        m_playersModel->setFlag(nick, PlayersListModel::Contributor, setFlag);
+                    break;
+            // flag indicating if a player has engine running
+            case 'g':
+                if(inRoom)
+                    foreach(const QString & nick, nicks)
+                        m_playersModel->setFlag(nick, PlayersListModel::InGame, setFlag);
+                    break;
+
+            // flag indicating if a player is the host/master of the room
+            case 'h':
+                if(inRoom)
+                    foreach (const QString & nick, nicks)
+                    {
+                        if (nick == mynick)
                         {
-                            if (nick == mynick)
-                            {
-                                isChief = setFlag;
-                                emit roomMaster(isChief);
-                            }
-
-                            m_playersModel->setFlag(nick, PlayersListModel::RoomAdmin, setFlag);
+                            isChief = setFlag;
+                            emit roomMaster(isChief);
                         }
-                        break;
 
-                // flag indicating if a player is admin (if so -> worship them!)
-                case 'a':
-                        foreach (const QString & nick, nicks)
-                        {
-                            if (nick == mynick)
-                                emit adminAccess(setFlag);
+                        m_playersModel->setFlag(nick, PlayersListModel::RoomAdmin, setFlag);
+                    }
+                    break;
 
-                            m_playersModel->setFlag(nick, PlayersListModel::ServerAdmin, setFlag);
-                        }
-                        break;
+            // flag indicating if a player is admin (if so -> worship them!)
+            case 'a':
+                    foreach (const QString & nick, nicks)
+                    {
+                        if (nick == mynick)
+                            emit adminAccess(setFlag);
 
-                default:
-                        qWarning() << "Net: Unknown client-flag: " << c;
-            }
-        }
+                        m_playersModel->setFlag(nick, PlayersListModel::ServerAdmin, setFlag);
+                    }
+                    break;
 
-        return;
+            default:
+                    qWarning() << "Net: Unknown client-flag: " << c;
+        }
     }
+}
 
-    if(lst[0] == "KICKED")
-    {
-        netClientState = InLobby;
-        askRoomsList();
-        emit LeftRoom(tr("You got kicked"));
-        m_playersModel->resetRoomFlags();
+void HWNewNet::handleKicked(const QStringList & lst)
+{
+    Q_UNUSED(lst);
 
+    netClientState = InLobby;
+    askRoomsList();
+    emit LeftRoom(tr("You got kicked"));
+    m_playersModel->resetRoomFlags();
+}
+
+void HWNewNet::handleLobbyJoined(const QStringList & lst)
+{
+    if(lst.size() < 2)
+    {
+        qWarning("Net: Bad JOINED message");
         return;
     }
 
-    if(lst[0] == "LOBBY:JOINED")
+    const QStringList nicks = lst.mid(1);
+
+    if (nicks.contains(mynick))
     {
-        if(lst.size() < 2)
+        // check if server is authenticated or no authentication was performed at all
+        if(!m_serverHash.isEmpty())
         {
-            qWarning("Net: Bad JOINED message");
-            return;
-        }
+            Error(tr("Server authentication error"));
 
-        for(int i = 1; i < lst.size(); ++i)
-        {
-            if (lst[i] == mynick)
-            {
-                // check if server is authenticated or no authentication was performed at all
-                if(!m_serverHash.isEmpty())
-                {
-                    Error(tr("Server authentication error"));
+            Disconnect();
+        }
 
-                    Disconnect();
-                }
+        netClientState = InLobby;
+        //RawSendNet(QString("LIST")); //deprecated
+        emit connected();
+    }
 
-                netClientState = InLobby;
-                //RawSendNet(QString("LIST")); //deprecated
-                emit connected();
-            }
+    m_playersModel->addPlayers(nicks, false);
+}
 
-            m_playersModel->addPlayer(lst[i], false);
-        }
-        return;
-    }
+void HWNewNet::handleRoom(const QStringList & lst)
+{
+    const int columns = m_roomsListModel->columnCountSupported();
 
-    if(lst[0] == "ROOM" && lst.size() == m_roomsListModel->columnCountSupported() + 2 && lst[1] == "ADD")
+    if(lst.size() == columns + 2 && lst[1] == "ADD")
     {
-        QStringList tmp = lst;
-        tmp.removeFirst();
-        tmp.removeFirst();
-
-        m_roomsListModel->addRoom(tmp);
+        m_roomsListModel->addRoom(lst.mid(2));
         return;
     }
 
-    if(lst[0] == "ROOM" && lst.size() == m_roomsListModel->columnCountSupported() + 3 && lst[1] == "UPD")
+    if(lst.size() == columns + 3 && lst[1] == "UPD")
     {
-        QStringList tmp = lst;
-        tmp.removeFirst();
-        tmp.removeFirst();
-
-        QString roomName = tmp.takeFirst();
-        m_roomsListModel->updateRoom(roomName, tmp);
+        const QString & roomName = lst[2];
+        const QString & newName = lst[4];
+        m_roomsListModel->updateRoom(roomName, lst.mid(3));
 
         // keep track of room name so correct name is displayed
-        if(myroom == roomName && myroom != tmp[1])
+        if(myroom == roomName && myroom != newName)
         {
-            myroom = tmp[1];
+            myroom = newName;
             emit roomNameUpdated(myroom);
         }
 
         return;
     }
 
-    if(lst[0] == "ROOM" && lst.size() == 3 && lst[1] == "DEL")
+    if(lst.size() == 3 && lst[1] == "DEL")
     {
         m_roomsListModel->removeRoom(lst[2]);
         return;
     }
 
-    if(lst[0] == "LOBBY:LEFT")
-    {
-        if(lst.size() < 2)
-        {
-            qWarning("Net: Bad LOBBY:LEFT message");
-            return;
-        }
-
-        if (lst.size() < 3)
-            m_playersModel->removePlayer(lst[1]);
-        else
-            m_playersModel->removePlayer(lst[1], lst[2]);
+    handleUnknown(lst);
+}
 
+void HWNewNet::handleLobbyLeft(const QStringList & lst)
+{
+    if(lst.size() < 2)
+    {
+        qWarning("Net: Bad LOBBY:LEFT message");
         return;
     }
 
-    if (lst[0] == "ASKPASSWORD")
-    {
-        // server should send us salt of at least 16 characters
+    if (lst.size() < 3)
+        m_playersModel->removePlayer(lst[1]);
+    else
+        m_playersModel->removePlayer(lst[1], lst[2]);
+}
 
-        if(lst.size() < 2 || lst[1].size() < 16)
-        {
-            qWarning("Net: Bad ASKPASSWORD message");
-            return;
-        }
+void HWNewNet::handleAskPassword(const QStringList & lst)
+{
+    // server should send us salt of at least 16 characters
 
-        emit NickRegistered(mynick);
-        m_nick_registered = true;
+    if(lst.size() < 2 || lst[1].size() < 16)
+    {
+        qWarning("Net: Bad ASKPASSWORD message");
+        return;
+    }
 
-        // store server salt
-        // when this variable is set, it is assumed that server asked us for a password
-        m_serverSalt = lst[1];
-        m_clientSalt = QUuid::createUuid().toString();
+    emit NickRegistered(mynick);
+    m_nick_registered = true;
 
-        maybeSendPassword();
+    // store server salt
+    // when this variable is set, it is assumed that server asked us for a password
+    m_serverSalt = lst[1];
+    m_clientSalt = QUuid::createUuid().toString();
 
+    maybeSendPassword();
+}
+
+void HWNewNet::handleNotice(const QStringList & lst)
+{
+    if(lst.size() < 2)
+    {
+        qWarning("Net: Bad NOTICE message");
         return;
     }
 
-    if (lst[0] == "NOTICE")
+    bool ok;
+    int n = lst[1].toInt(&ok);
+    if(!ok)
     {
-        if(lst.size() < 2)
-        {
-            qWarning("Net: Bad NOTICE message");
-            return;
-        }
-
-        bool ok;
-        int n = lst[1].toInt(&ok);
-        if(!ok)
-        {
-            qWarning("Net: Bad NOTICE message");
-            return;
-        }
+        qWarning("Net: Bad NOTICE message");
+        return;
+    }
 
-        handleNotice(n);
+    switch(n)
+    {
+        case 0:
+            emit NickTaken(mynick);
+            break;
+        case 2:
+            emit askForRoomPassword();
+            break;
+    }
+}
 
+void HWNewNet::handleBye(const QStringList & lst)
+{
+    if (lst.size() < 2)
+    {
+        qWarning("Net: Bad BYE message");
         return;
     }
-
-    if (lst[0] == "BYE")
+    if (lst[1] == "Authentication failed")
     {
-        if (lst.size() < 2)
-        {
-            qWarning("Net: Bad BYE message");
-            return;
-        }
-        if (lst[1] == "Authentication failed")
-        {
-            emit AuthFailed();
-            m_game_connected = false;
-            Disconnect();
-            //omitted 'emit disconnected()', we don't want the error message
-            return;
-        }
+        emit AuthFailed();
         m_game_connected = false;
         Disconnect();
-        emit disconnected(HWApplication::translate("server", lst[1].toLatin1().constData()));
+        //omitted 'emit disconnected()', we don't want the error message
         return;
     }
+    m_game_connected = false;
+    Disconnect();
+    emit disconnected(HWApplication::translate("server", lst[1].toLatin1().constData()));
+}
 
-    if(lst[0] == "JOINING")
+void HWNewNet::handleJoining(const QStringList & lst)
+{
+    if(lst.size() != 2)
     {
-        if(lst.size() != 2)
-        {
-            qWarning("Net: Bad JOINING message");
-            return;
-        }
-
-        myroom = lst[1];
-        emit roomNameUpdated(myroom);
+        qWarning("Net: Bad JOINING message");
         return;
     }
 
-    if(netClientState == InLobby && lst[0] == "JOINED")
+    myroom = lst[1];
+    emit roomNameUpdated(myroom);
+}
+
+void HWNewNet::handleJoined(const QStringList & lst)
+{
+    if(netClientState == InLobby)
     {
         if(lst.size() < 2 || lst[1] != mynick)
         {
@@ -799,185 +872,234 @@ void HWNewNet::ParseCmd(const QStringList & lst)
         return;
     }
 
-    if(netClientState == InLobby && lst[0] == "REPLAY_START")
+    if(!inRoomState())
     {
-        netClientState = InRoom;
-        m_demo_data_pending = true;
-        emit EnteredGame();
-        emit roomMaster(false);
+        handleUnknown(lst);
         return;
     }
 
-    if(netClientState == InRoom || netClientState == InGame || netClientState == InDemo)
+    if(lst.size() < 2)
     {
-        if (lst[0] == "EM")
-        {
-            if(lst.size() < 2)
-            {
-                qWarning("Net: Bad EM message");
-                m_demo_data_pending = false;
-                return;
-            }
-            for(int i = 1; i < lst.size(); ++i)
-            {
-                QByteArray em = QByteArray::fromBase64(lst[i].toLatin1());
-                emit FromNet(em);
-            }
-            m_demo_data_pending = false;
-            return;
-        }
+        qWarning("Net: Bad JOINED message");
+        return;
     }
 
-    if(netClientState == InRoom || netClientState == InGame)
+    for(int i = 1; i < lst.size(); ++i)
     {
-        if (lst[0] == "ROUND_FINISHED")
-        {
-            emit FromNet(QByteArray("\x01o"));
-            return;
-        }
+        m_playersModel->playerJoinedRoom(lst[i], isChief && (lst[i] != mynick));
+        if(!m_playersModel->isFlagSet(lst[i], PlayersListModel::Ignore))
+                emit chatStringFromNet(tr("%1 *** %2 has joined the room").arg('\x03').arg(lst[i]));
+    }
+}
 
-        if (lst[0] == "ADD_TEAM")
-        {
-            if(lst.size() != 24)
-            {
-                qWarning("Net: Bad ADDTEAM message");
-                return;
-            }
-            QStringList tmp = lst;
-            tmp.removeFirst();
-            HWTeam team(tmp);
-            emit AddNetTeam(team);
-            return;
-        }
+void HWNewNet::handleReplayStart(const QStringList & lst)
+{
+    if(netClientState != InLobby)
+    {
+        handleUnknown(lst);
+        return;
+    }
 
-        if (lst[0] == "REMOVE_TEAM")
-        {
-            if(lst.size() != 2)
-            {
-                qWarning("Net: Bad REMOVETEAM message");
-                return;
-            }
-            emit RemoveNetTeam(HWTeam(lst[1]));
-            return;
-        }
+    netClientState = InRoom;
+    m_demo_data_pending = true;
+    emit EnteredGame();
+    emit roomMaster(false);
+}
 
-        if(lst[0] == "ROOMABANDONED")
-        {
-            netClientState = InLobby;
-            m_playersModel->resetRoomFlags();
-            emit LeftRoom(tr("Room destroyed"));
-            return;
-        }
+void HWNewNet::handleEm(const QStringList & lst)
+{
+    if(!inRoomState() && netClientState != InDemo)
+    {
+        handleUnknown(lst);
+        return;
+    }
 
-        if (lst[0] == "RUN_GAME")
-        {
-            if(m_demo_data_pending)
-            {
-                netClientState = InDemo;
-                emit AskForOfficialServerDemo();
-            }
-            else
-            {
-                netClientState = InGame;
-                emit AskForRunGame();
-            }
-            return;
-        }
+    if(lst.size() < 2)
+    {
+        qWarning("Net: Bad EM message");
+        m_demo_data_pending = false;
+        return;
+    }
+    for(int i = 1; i < lst.size(); ++i)
+    {
+        QByteArray em = QByteArray::fromBase64(lst[i].toLatin1());
+        emit FromNet(em);
+    }
+    m_demo_data_pending = false;
+}
 
-        if (lst[0] == "TEAM_ACCEPTED")
-        {
-            if (lst.size() != 2)
-            {
-                qWarning("Net: Bad TEAM_ACCEPTED message");
-                return;
-            }
-            emit TeamAccepted(lst[1]);
-            return;
-        }
+void HWNewNet::handleRoundFinished(const QStringList & lst)
+{
+    if(!inRoomState())
+    {
+        handleUnknown(lst);
+        return;
+    }
 
-        if (lst[0] == "CFG")
-        {
-            if(lst.size() < 3)
-            {
-                qWarning("Net: Bad CFG message");
-                return;
-            }
-            QStringList tmp = lst;
-            tmp.removeFirst();
-            tmp.removeFirst();
-            if (lst[1] == "SCHEME")
-                emit netSchemeConfig(tmp);
-            else
-                emit paramChanged(lst[1], tmp);
-            return;
-        }
+    emit FromNet(QByteArray("\x01o"));
+}
 
-        if (lst[0] == "HH_NUM")
-        {
-            if (lst.size() != 3)
-            {
-                qWarning("Net: Bad TEAM_ACCEPTED message");
-                return;
-            }
-            HWTeam tmptm(lst[1]);
-            tmptm.setNumHedgehogs(lst[2].toUInt());
-            emit hhnumChanged(tmptm);
-            return;
-        }
+void HWNewNet::handleAddTeam(const QStringList & lst)
+{
+    if(!inRoomState())
+    {
+        handleUnknown(lst);
+        return;
+    }
 
-        if (lst[0] == "TEAM_COLOR")
-        {
-            if (lst.size() != 3)
-            {
-                qWarning("Net: Bad TEAM_COLOR message");
-                return;
-            }
-            HWTeam tmptm(lst[1]);
-            tmptm.setColor(lst[2].toInt());
-            emit teamColorChanged(tmptm);
-            return;
-        }
+    if(lst.size() != 24)
+    {
+        qWarning("Net: Bad ADDTEAM message");
+        return;
+    }
+    HWTeam team(lst.mid(1));
+    emit AddNetTeam(team);
+}
 
-        if(lst[0] == "JOINED")
-        {
-            if(lst.size() < 2)
-            {
-                qWarning("Net: Bad JOINED message");
-                return;
-            }
+void HWNewNet::handleRemoveTeam(const QStringList & lst)
+{
+    if(!inRoomState())
+    {
+        handleUnknown(lst);
+        return;
+    }
 
-            for(int i = 1; i < lst.size(); ++i)
-            {
-                m_playersModel->playerJoinedRoom(lst[i], isChief && (lst[i] != mynick));
-                if(!m_playersModel->isFlagSet(lst[i], PlayersListModel::Ignore))
-                        emit chatStringFromNet(tr("%1 *** %2 has joined the room").arg('\x03').arg(lst[i]));
-            }
-            return;
-        }
+    if(lst.size() != 2)
+    {
+        qWarning("Net: Bad REMOVETEAM message");
+        return;
+    }
+    emit RemoveNetTeam(HWTeam(lst[1]));
+}
 
-        if(lst[0] == "LEFT")
-        {
-            if(lst.size() < 2)
-            {
-                qWarning("Net: Bad LEFT message");
-                return;
-            }
+void HWNewNet::handleRoomAbandoned(const QStringList & lst)
+{
+    if(!inRoomState())
+    {
+        handleUnknown(lst);
+        return;
+    }
 
-            if(!m_playersModel->isFlagSet(lst[1], PlayersListModel::Ignore)) {
-				if (lst.size() < 3)
-					emit chatStringFromNet(tr("%1 *** %2 has left").arg('\x03').arg(lst[1]));
-				else
-				{
-					QString leaveMsg = QString(lst[2]);
-					emit chatStringFromNet(tr("%1 *** %2 has left (%3)").arg('\x03').arg(lst[1]).arg(HWApplication::translate("server", leaveMsg.toLatin1().constData())));
-				}
-            }
-            m_playersModel->playerLeftRoom(lst[1]);
-            return;
-        }
+    netClientState = InLobby;
+    m_playersModel->resetRoomFlags();
+    emit LeftRoom(tr("Room destroyed"));
+}
+
+void HWNewNet::handleRunGame(const QStringList & lst)
+{
+    if(!inRoomState())
+    {
+        handleUnknown(lst);
+        return;
     }
 
-    qWarning() << "Net: Unknown message or wrong state:" << lst;
+    if(m_demo_data_pending)
+    {
+        netClientState = InDemo;
+        emit AskForOfficialServerDemo();
+    }
+    else
+    {
+        netClientState = InGame;
+        emit AskForRunGame();
+    }
+}
+
+void HWNewNet::handleTeamAccepted(const QStringList & lst)
+{
+    if(!inRoomState())
+    {
+        handleUnknown(lst);
+        return;
+    }
+
+    if (lst.size() != 2)
+    {
+        qWarning("Net: Bad TEAM_ACCEPTED message");
+        return;
+    }
+    emit TeamAccepted(lst[1]);
+}
+
+void HWNewNet::handleCfg(const QStringList & lst)
+{
+    if(!inRoomState())
+    {
+        handleUnknown(lst);
+        return;
+    }
+
+    if(lst.size() < 3)
+    {
+        qWarning("Net: Bad CFG message");
+        return;
+    }
+    if (lst[1] == "SCHEME")
+        emit netSchemeConfig(lst.mid(2));
+    else
+        emit paramChanged(lst[1], lst.mid(2));
+}
+
+void HWNewNet::handleHhNum(const QStringList & lst)
+{
+    if(!inRoomState())
+    {
+        handleUnknown(lst);
+        return;
+    }
+
+    if (lst.size() != 3)
+    {
+        qWarning("Net: Bad TEAM_ACCEPTED message");
+        return;
+    }
+    HWTeam tmptm(lst[1]);
+    tmptm.setNumHedgehogs(lst[2].toUInt());
+    emit hhnumChanged(tmptm);
+}
+
+void HWNewNet::handleTeamColor(const QStringList & lst)
+{
+    if(!inRoomState())
+    {
+        handleUnknown(lst);
+        return;
+    }
+
+    if (lst.size() != 3)
+    {
+        qWarning("Net: Bad TEAM_COLOR message");
+        return;
+    }
+    HWTeam tmptm(lst[1]);
+    tmptm.setColor(lst[2].toInt());
+    emit teamColorChanged(tmptm);
+}
+
+void HWNewNet::handleLeft(const QStringList & lst)
+{
+    if(!inRoomState())
+    {
+        handleUnknown(lst);
+        return;
+    }
+
+    if(lst.size() < 2)
+    {
+        qWarning("Net: Bad LEFT message");
+        return;
+    }
+
+    if(!m_playersModel->isFlagSet(lst[1], PlayersListModel::Ignore)) {
+		if (lst.size() < 3)
+			emit chatStringFromNet(tr("%1 *** %2 has left").arg('\x03').arg(lst[1]));
+		else
+		{
+			QString leaveMsg = QString(lst[2]);
+			emit chatStringFromNet(tr("%1 *** %2 has left (%3)").arg('\x03').arg(lst[1]).arg(HWApplication::translate("server", leaveMsg.toLatin1().constData())));
+		}
+    }
+    m_playersModel->playerLeftRoom(lst[1]);
 }
 
 void HWNewNet::onHedgehogsNumChanged(const HWTeam& team)
@@ -1226,19 +1348,6 @@ void HWNewNet::askServerVars()
     RawSendNet(QString("GET_SERVER_VAR"));
 }
 
-void HWNewNet::handleNotice(int n)
-{
-    switch(n)
-    {
-        case 0:
-            emit NickTaken(mynick);
-            break;
-        case 2:
-            emit askForRoomPassword();
-            break;
-    }
-}
-
 RoomsListModel * HWNewNet::roomsListModel()
 {
     return m_roomsListModel;
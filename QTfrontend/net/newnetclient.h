@@ -24,6 +24,7 @@
 #include <QString>
 #include <QSslSocket>
 #include <QMap>
+#include <QHash>
 
 #include "team.h"
 #include "game.h" // for GameState
@@ -74,6 +75,9 @@ class HWNewNet : public QObject
         bool m_game_connected;
         bool m_nick_registered;
         bool m_demo_data_pending;
+        bool m_reading;
+        int m_readCalls;
+        int m_readMessages;
         RoomsListModel * m_roomsListModel;
         PlayersListModel * m_playersModel;
         QSortFilterProxyModel * m_lobbyPlayersModel;
@@ -89,8 +93,49 @@ class HWNewNet : public QObject
         int  ByteLength(const QString & str);
         void RawSendNet(const QString & buf);
         void RawSendNet(const QByteArray & buf);
-        void ParseCmd(const QStringList & lst);        
-        void handleNotice(int n);
+        void ParseCmd(const QStringList & lst);
+
+        // server message handlers, lst[0] is the command name
+        typedef void (HWNewNet::*CommandHandler)(const QStringList & lst);
+        static QHash<QString, CommandHandler> commandHandlers();
+        bool inRoomState();
+        void handleUnknown(const QStringList & lst);
+        void handleAddTeam(const QStringList & lst);
+        void handleAskPassword(const QStringList & lst);
+        void handleBanList(const QStringList & lst);
+        void handleBye(const QStringList & lst);
+        void handleCfg(const QStringList & lst);
+        void handleChat(const QStringList & lst);
+        void handleClientFlags(const QStringList & lst);
+        void handleConnected(const QStringList & lst);
+        void handleEm(const QStringList & lst);
+        void handleError(const QStringList & lst);
+        void handleHhNum(const QStringList & lst);
+        void handleInfo(const QStringList & lst);
+        void handleJoined(const QStringList & lst);
+        void handleJoining(const QStringList & lst);
+        void handleKicked(const QStringList & lst);
+        void handleLeft(const QStringList & lst);
+        void handleLobbyJoined(const QStringList & lst);
+        void handleLobbyLeft(const QStringList & lst);
+        void handleNick(const QStringList & lst);
+        void handleNotice(const QStringList & lst);
+        void handlePing(const QStringList & lst);
+        void handleProto(const QStringList & lst);
+        void handleRedirect(const QStringList & lst);
+        void handleRemoveTeam(const QStringList & lst);
+        void handleReplayStart(const QStringList & lst);
+        void handleRoom(const QStringList & lst);
+        void handleRoomAbandoned(const QStringList & lst);
+        void handleRooms(const QStringList & lst);
+        void handleRoundFinished(const QStringList & lst);
+        void handleRunGame(const QStringList & lst);
+        void handleServerAuth(const QStringList & lst);
+        void handleServerMessage(const QStringList & lst);
+        void handleServerVars(const QStringList & lst);
+        void handleTeamAccepted(const QStringList & lst);
+        void handleTeamColor(const QStringList & lst);
+        void handleWarning(const QStringList & lst);
 
         void maybeSendPassword();
 
@@ -145,8 +190,6 @@ class HWNewNet : public QObject
 
         void setMyReadyStatus(bool isReady);
 
-        void messageProcessed();
-
     public slots:
         void ToggleReady();
         void chatLineToNet(const QString& str);
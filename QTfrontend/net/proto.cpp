@@ -45,6 +45,27 @@ QByteArray & HWProto::addStringListToBuffer(QByteArray & buf, const QStringList
     return buf;
 }
 
+QByteArray & HWProto::addDrawnMapToBuffer(QByteArray & buf, const QByteArray & drawnMap)
+{
+    // engine takes drawn map data in chunks of up to 200 bytes
+    static const int chunkSize = 200;
+    static const char prefix[] = "edraw ";
+    const int prefixSize = sizeof(prefix) - 1;
+
+    const int chunks = (drawnMap.size() + chunkSize - 1) / chunkSize;
+    buf.reserve(buf.size() + drawnMap.size() + chunks * (1 + prefixSize));
+
+    for (int offset = 0; offset < drawnMap.size(); offset += chunkSize)
+    {
+        int size = qMin(chunkSize, drawnMap.size() - offset);
+        buf.append(char(prefixSize + size));
+        buf.append(prefix, prefixSize);
+        buf.append(drawnMap.constData() + offset, size);
+    }
+
+    return buf;
+}
+
 QString HWProto::formatChatMsg(const QString & nick, const QString & msg)
 {
     // Messages using the /me command.
@@ -33,6 +33,13 @@ class HWProto : public QObject
         static QByteArray & addStringToBuffer(QByteArray & buf, const QString & string);
         static QByteArray & addByteArrayToBuffer(QByteArray & buf, const QByteArray & msg);
         static QByteArray & addStringListToBuffer(QByteArray & buf, const QStringList & strList);
+        /**
+         * @brief Appends drawn map data as a sequence of "edraw" messages.
+         * @param buf buffer to append the messages to
+         * @param drawnMap encoded drawn map, see DrawMapScene::encode()
+         * @return buf
+         */
+        static QByteArray & addDrawnMapToBuffer(QByteArray & buf, const QByteArray & drawnMap);
         static QString formatChatMsg(const QString & nick, const QString & msg);
         static QString formatChatMsgForFrontend(const QString & msg);
         /**
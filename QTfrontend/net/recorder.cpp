@@ -20,19 +20,13 @@
 #include <QByteArray>
 
 #include "recorder.h"
+#include "recorderscheduler.h"
 #include "gameuiconfig.h"
 #include "hwconsts.h"
 #include "game.h"
 #include "util/MessageDialog.h"
 #include "LibavInteraction.h"
 
-// Encoding is memory expensive process, so we need to limit maximum number
-// of simultaneous encoders.
-static const int maxRecorders = 3;
-static int numRecorders = 0;
-
-static QList<HWRecorder*> queue;
-
 HWRecorder::HWRecorder(GameUIConfig * config, const QString &prefix) :
     TCPBase(false, !config->language().isEmpty())
 {
@@ -47,10 +41,6 @@ HWRecorder::HWRecorder(GameUIConfig * config, const QString &prefix) :
 HWRecorder::~HWRecorder()
 {
     emit encodingFinished(finished);
-    if (queue.empty())
-        numRecorders--;
-    else
-        queue.takeFirst()->Start(false);
 }
 
 void HWRecorder::onClientDisconnect()
@@ -59,13 +49,9 @@ void HWRecorder::onClientDisconnect()
 
 void HWRecorder::onClientRead()
 {
-    quint8 msglen;
-    quint32 bufsize;
-    while (!readbuffer.isEmpty() && ((bufsize = readbuffer.size()) > 0) &&
-            ((msglen = readbuffer.data()[0]) < bufsize))
+    QByteArray msg;
+    while (takeMessage(msg))
     {
-        QByteArray msg = readbuffer.left(msglen + 1);
-        readbuffer.remove(0, msglen + 1);
         switch (msg.at(1))
         {
         case '?':
@@ -99,13 +85,23 @@ void HWRecorder::EncodeVideo(const QByteArray & record)
     toSendBuf.replace(QByteArray("\x02TN"), QByteArray("\x02TV"));
     toSendBuf.replace(QByteArray("\x02TS"), QByteArray("\x02TV"));
 
-    if (numRecorders < maxRecorders)
-    {
-        numRecorders++;
-        Start(false); // run engine
-    }
-    else
-        queue.push_back(this);
+    // the scheduler starts the engine once there is room for another encode
+    RecorderScheduler::instance().enqueue(this);
+}
+
+void HWRecorder::startEncoding()
+{
+    Start(false); // run engine
+}
+
+QSize HWRecorder::resolution() const
+{
+    return config->rec_Resolution().size();
+}
+
+QString HWRecorder::videoCodec() const
+{
+    return config->videoCodec();
 }
 
 QStringList HWRecorder::getArguments()
@@ -115,8 +111,7 @@ QStringList HWRecorder::getArguments()
     QString nick = config->netNick().toUtf8().toBase64();
 
     arguments << "--internal";
-    arguments << "--port";
-    arguments << QString("%1").arg(ipc_port);
+    arguments << ipcArguments();
     arguments << "--prefix";
     arguments << datadir->absolutePath();
     arguments << "--user-prefix";
@@ -169,7 +164,7 @@ bool HWRecorder::simultaneousRun()
 
 void HWRecorder::abort()
 {
-    queue.removeOne(this);
+    RecorderScheduler::instance().remove(this);
     aborted = true;
     deleteLater();
 }
@@ -21,6 +21,7 @@
 
 #include <QString>
 #include <QByteArray>
+#include <QSize>
 
 #include "tcpBase.h"
 
@@ -35,9 +36,13 @@ class HWRecorder : public TCPBase
         virtual ~HWRecorder();
 
         void EncodeVideo(const QByteArray & record);
+        void startEncoding(); // called by RecorderScheduler
         void abort();
         bool simultaneousRun();
 
+        QSize resolution() const;
+        QString videoCodec() const;
+
         VideoItem * item; // used by pagevideos
         QString name;
         QString prefix;
@@ -0,0 +1,280 @@
+/*
+ * Hedgewars, a free turn based strategy game
+ * Copyright (c) 2004-2015 Andrey Korotaev <unC0Rr@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#include <QThread>
+#include <QFile>
+#include <QSize>
+
+#ifdef Q_OS_WIN
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+#ifdef Q_OS_MAC
+#include <sys/types.h>
+#include <sys/sysctl.h>
+#endif
+
+#include "recorderscheduler.h"
+#include "recorder.h"
+#include "hwconsts.h"
+
+// size of TFrame in uVideoRec.pas, the records of the camera file
+static const int cameraFrameSize = 20;
+// used for the remaining time of recordings of unknown length
+static const qint64 defaultDuration = 60*1000;
+
+// total physical memory in bytes, 0 if unknown
+static qint64 physicalMemory()
+{
+#if defined(Q_OS_WIN)
+    MEMORYSTATUSEX status;
+    status.dwLength = sizeof(status);
+    if (GlobalMemoryStatusEx(&status))
+        return status.ullTotalPhys;
+#elif defined(Q_OS_MAC)
+    quint64 memsize;
+    size_t len = sizeof(memsize);
+    int mib[2] = { CTL_HW, HW_MEMSIZE };
+    if (sysctl(mib, 2, &memsize, &len, NULL, 0) == 0)
+        return memsize;
+#elif defined(_SC_PHYS_PAGES)
+    long pages = sysconf(_SC_PHYS_PAGES);
+    long pageSize = sysconf(_SC_PAGE_SIZE);
+    if (pages > 0 && pageSize > 0)
+        return (qint64)pages * pageSize;
+#endif
+    return 0;
+}
+
+// length of a recording in ms, read from the time stamp of the last camera position
+static qint64 recordedDuration(const QString & prefix)
+{
+    QFile file(cfgdir->absoluteFilePath("VideoTemp/" + prefix + ".txtin"));
+    if (!file.open(QIODevice::ReadOnly))
+        return 0;
+    qint64 frames = file.size() / cameraFrameSize;
+    quint32 realTicks;
+    if (frames == 0 || !file.seek((frames - 1) * cameraFrameSize) ||
+        file.read((char*)&realTicks, sizeof(realTicks)) != sizeof(realTicks))
+        return 0;
+    return realTicks;
+}
+
+RecorderScheduler::RecorderScheduler()
+{
+}
+
+RecorderScheduler & RecorderScheduler::instance()
+{
+    static RecorderScheduler instance;
+    return instance;
+}
+
+void RecorderScheduler::enqueue(HWRecorder * pRecorder)
+{
+    Job job;
+    job.pRecorder = pRecorder;
+    job.pObject = pRecorder;
+    job.duration = recordedDuration(pRecorder->prefix);
+    job.progress = 0;
+    job.paused = false;
+    m_queued.append(job);
+
+    connect(pRecorder, SIGNAL(onProgress(float)), this, SLOT(updateProgress(float)));
+    connect(pRecorder, SIGNAL(destroyed(QObject*)), this, SLOT(recorderDestroyed(QObject*)));
+    schedule();
+}
+
+void RecorderScheduler::remove(HWRecorder * pRecorder)
+{
+    recorderDestroyed(pRecorder);
+}
+
+int RecorderScheduler::findQueued(HWRecorder * pRecorder) const
+{
+    for (int i = 0; i < m_queued.size(); i++)
+        if (m_queued[i].pRecorder == pRecorder)
+            return i;
+    return -1;
+}
+
+bool RecorderScheduler::isQueued(HWRecorder * pRecorder) const
+{
+    return findQueued(pRecorder) != -1;
+}
+
+bool RecorderScheduler::isPaused(HWRecorder * pRecorder) const
+{
+    int i = findQueued(pRecorder);
+    return i != -1 && m_queued[i].paused;
+}
+
+void RecorderScheduler::setPaused(HWRecorder * pRecorder, bool paused)
+{
+    int i = findQueued(pRecorder);
+    if (i == -1)
+        return;
+    m_queued[i].paused = paused;
+    schedule();
+}
+
+void RecorderScheduler::prioritize(HWRecorder * pRecorder)
+{
+    int i = findQueued(pRecorder);
+    if (i == -1)
+        return;
+    m_queued.move(i, 0);
+    emit statusChanged();
+}
+
+int RecorderScheduler::numRunning() const
+{
+    return m_running.size();
+}
+
+int RecorderScheduler::numQueued() const
+{
+    return m_queued.size();
+}
+
+int RecorderScheduler::maxRunning() const
+{
+    return m_queued.isEmpty() ? limitFor(NULL) : limitFor(m_queued.first().pRecorder);
+}
+
+// Encoding is memory and cpu expensive. One encode keeps a core busy with
+// rendering, plus what the conversion and the codec threads need for its
+// picture size; codecs doing heavy motion search need a lot more of both.
+int RecorderScheduler::limitFor(HWRecorder * pRecorder) const
+{
+#ifdef HWLIBRARY
+    // engine library is not reentrant
+    Q_UNUSED(pRecorder);
+    return 1;
+#else
+    QSize resolution(1280, 720);
+    QString codec;
+    if (pRecorder)
+    {
+        resolution = pRecorder->resolution();
+        codec = pRecorder->videoCodec();
+    }
+    bool heavy = codec.startsWith("libx26") || codec.startsWith("libvpx") ||
+                 codec.startsWith("libaom") || codec.startsWith("libsvtav1");
+    double pixels = (double)resolution.width() * resolution.height();
+
+    double cores = 1 + pixels/1e6 * (heavy ? 2.0 : 0.75);
+    qint64 memory = 192*1024*1024 + (qint64)(pixels * (heavy ? 64 : 24));
+
+    int limit = qMax(1, (int)(QThread::idealThreadCount() / cores));
+    // leave half of the memory to everything else
+    qint64 total = physicalMemory();
+    if (total > 0)
+        limit = qMin(limit, (int)qMax<qint64>(1, total / 2 / memory));
+    return limit;
+#endif
+}
+
+void RecorderScheduler::schedule()
+{
+    for (int i = 0; i < m_queued.size() && m_running.size() < limitFor(m_queued[i].pRecorder);)
+    {
+        if (m_queued[i].paused)
+        {
+            i++;
+            continue;
+        }
+        Job job = m_queued.takeAt(i);
+        job.timer.start();
+        m_running.append(job);
+        job.pRecorder->startEncoding();
+    }
+    emit statusChanged();
+}
+
+qint64 RecorderScheduler::jobDuration(const Job & job) const
+{
+    return job.duration > 0 ? job.duration : defaultDuration;
+}
+
+double RecorderScheduler::speed() const
+{
+    double result = 0;
+    foreach (const Job & job, m_running)
+    {
+        // the first second is mostly engine startup
+        qint64 elapsed = job.timer.elapsed();
+        if (elapsed > 1000 && job.progress > 0)
+            result += jobDuration(job) * job.progress / elapsed;
+    }
+    return result;
+}
+
+qint64 RecorderScheduler::remainingTime() const
+{
+    double currentSpeed = speed();
+    if (currentSpeed <= 0)
+        return -1;
+
+    double remaining = 0;
+    foreach (const Job & job, m_running)
+        remaining += jobDuration(job) * (1 - job.progress);
+    foreach (const Job & job, m_queued)
+        if (!job.paused)
+            remaining += jobDuration(job);
+    return (qint64)(remaining / currentSpeed);
+}
+
+void RecorderScheduler::updateProgress(float progress)
+{
+    QObject * pObject = sender();
+    for (int i = 0; i < m_running.size(); i++)
+    {
+        if (m_running[i].pObject == pObject)
+        {
+            m_running[i].progress = progress;
+            emit statusChanged();
+            return;
+        }
+    }
+}
+
+// only compares the pointer, the recorder is already gone when it is destroyed
+void RecorderScheduler::recorderDestroyed(QObject * pObject)
+{
+    for (int i = 0; i < m_queued.size(); i++)
+    {
+        if (m_queued[i].pObject == pObject)
+        {
+            m_queued.removeAt(i);
+            schedule();
+            return;
+        }
+    }
+    for (int i = 0; i < m_running.size(); i++)
+    {
+        if (m_running[i].pObject == pObject)
+        {
+            m_running.removeAt(i);
+            schedule();
+            return;
+        }
+    }
+}
@@ -0,0 +1,93 @@
+/*
+ * Hedgewars, a free turn based strategy game
+ * Copyright (c) 2004-2015 Andrey Korotaev <unC0Rr@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#ifndef RECORDERSCHEDULER_H
+#define RECORDERSCHEDULER_H
+
+#include <QObject>
+#include <QList>
+#include <QElapsedTimer>
+
+class HWRecorder;
+
+/**
+ * @brief Decides which video encodes run and which wait.
+ *
+ * The number of simultaneous encodes is derived from the number of cores
+ * and the amount of memory, weighed against the resolution and the codec
+ * of the next encode. Waiting encodes can be moved to the front of the
+ * queue or paused, running ones report their progress here so that the
+ * total speed and remaining time can be shown.
+ *
+ * @see <a href="https://en.wikipedia.org/wiki/Singleton_pattern">singleton pattern</a>
+ */
+class RecorderScheduler : public QObject
+{
+        Q_OBJECT
+
+        RecorderScheduler();
+
+    public:
+        static RecorderScheduler & instance();
+
+        void enqueue(HWRecorder * pRecorder);
+        void remove(HWRecorder * pRecorder);
+
+        bool isQueued(HWRecorder * pRecorder) const;
+        bool isPaused(HWRecorder * pRecorder) const;
+        void setPaused(HWRecorder * pRecorder, bool paused);
+        void prioritize(HWRecorder * pRecorder); // encode next
+
+        int numRunning() const;
+        int numQueued() const;
+        int maxRunning() const; // for the current recording settings
+
+        // recorded time encoded per second, summed over running encodes; 0 if not known yet
+        double speed() const;
+        // estimated milliseconds until all encodes which are not paused are done, -1 if not known
+        qint64 remainingTime() const;
+
+    signals:
+        void statusChanged();
+
+    private:
+        struct Job
+        {
+            HWRecorder * pRecorder;
+            QObject * pObject; // same object, kept for comparing after it was destroyed
+            qint64 duration;   // length of the recording in ms, 0 if unknown
+            float progress;
+            bool paused;
+            QElapsedTimer timer;
+        };
+
+        QList<Job> m_queued;
+        QList<Job> m_running;
+
+        int findQueued(HWRecorder * pRecorder) const;
+        int limitFor(HWRecorder * pRecorder) const;
+        qint64 jobDuration(const Job & job) const;
+        void schedule();
+
+    private slots:
+        void updateProgress(float progress);
+        void recorderDestroyed(QObject * pObject);
+};
+
+#endif // RECORDERSCHEDULER_H
@@ -22,6 +22,7 @@
 #include <QThread>
 #include <QApplication>
 #include <QProcessEnvironment>
+#include <QLocalSocket>
 
 #include "tcpBase.h"
 #include "hwconsts.h"
@@ -84,7 +85,11 @@ TCPBase::~TCPBase()
     if(m_hasStarted)
     {
         if(IPCSocket)
+        {
+            // don't lose what was sent in the current event loop turn
+            FlushIPC();
             IPCSocket->close();
+        }
 
         if(m_connected)
         {
@@ -112,10 +117,20 @@ TCPBase::TCPBase(bool demoMode, bool usesCustomLanguage, QObject *parent) :
     m_isDemoMode(demoMode),
     m_connected(false),
     m_usesCustomLanguage(usesCustomLanguage),
+    m_private(false),
+    m_readPos(0),
+    m_readDepth(0),
+    m_readPending(false),
+    m_writePending(false),
+    m_bytesWritten(0),
     IPCSocket(0)
 {
     process = 0;
 
+    // reserved capacity is kept when the buffer runs empty
+    readbuffer.reserve(4096);
+    m_writeBuf.reserve(4096);
+
     if(!IPCServer)
     {
         IPCServer = new QTcpServer(0);
@@ -127,9 +142,92 @@ TCPBase::TCPBase(bool demoMode, bool usesCustomLanguage, QObject *parent) :
         }
     }
 
+    m_server = IPCServer;
     ipc_port=IPCServer->serverPort();
 }
 
+// Whether engines connect over a unix domain socket, see listenLocally().
+static bool useLocalIPC()
+{
+#ifdef HW_LOCAL_IPC
+    // HEDGEWARS_IPC=tcp switches back to the loopback TCP server
+    return qgetenv("HEDGEWARS_IPC") != "tcp";
+#else
+    return false;
+#endif
+}
+
+// Listens on a unix domain socket only this instance's engine is told
+// about, which spares the TCP stack. Keeps the TCP server if it fails.
+bool TCPBase::listenLocally()
+{
+    static int serverCount = 0;
+
+    QString name = QString("hedgewars-ipc-%1-%2")
+        .arg(QCoreApplication::applicationPid()).arg(++serverCount);
+
+    QLocalServer * server = new QLocalServer(this);
+    server->setMaxPendingConnections(1);
+    // in case a crashed instance with the same pid left it behind
+    QLocalServer::removeServer(name);
+    if (!server->listen(name))
+    {
+        qWarning("Unable to start local IPC server: %s", qPrintable(server->errorString()));
+        delete server;
+        return false;
+    }
+
+    m_localServer = server;
+    return true;
+}
+
+QStringList TCPBase::ipcArguments() const
+{
+    QStringList arguments;
+
+    if(m_localServer)
+        arguments << "--ipc-socket" << m_localServer->fullServerName();
+    else
+        arguments << "--port" << QString::number(ipc_port);
+
+    return arguments;
+}
+
+// Makes this instance accept its engine on its own listening socket instead
+// of the shared one, so it doesn't have to wait in srvsList for other engines
+// to connect first. Falls back to the shared server if listening fails.
+bool TCPBase::listenPrivately()
+{
+    if(m_hasStarted)
+        return false;
+
+    // a local server is private, it is created when the engine is started
+    if(useLocalIPC())
+    {
+        m_private = true;
+        return true;
+    }
+
+    return listenOnPrivatePort();
+}
+
+bool TCPBase::listenOnPrivatePort()
+{
+    QTcpServer * server = new QTcpServer(this);
+    server->setMaxPendingConnections(1);
+    if (!server->listen(QHostAddress::LocalHost))
+    {
+        qWarning("Unable to start private IPC server: %s", qPrintable(server->errorString()));
+        delete server;
+        return false;
+    }
+
+    m_server = server;
+    ipc_port = server->serverPort();
+    m_private = true;
+    return true;
+}
+
 void TCPBase::NewConnection()
 {
     if(IPCSocket)
@@ -138,10 +236,27 @@ void TCPBase::NewConnection()
         return;
     }
 
-    disconnect(IPCServer, SIGNAL(newConnection()), this, SLOT(NewConnection()));
-    IPCSocket = IPCServer->nextPendingConnection();
+    if(m_localServer)
+    {
+        disconnect(m_localServer, SIGNAL(newConnection()), this, SLOT(NewConnection()));
+        IPCSocket = m_localServer->nextPendingConnection();
 
-    if(!IPCSocket) return;
+        if(!IPCSocket) return;
+
+        // nobody else is expected, this also removes the socket file
+        m_localServer->close();
+    }
+    else
+    {
+        disconnect(m_server, SIGNAL(newConnection()), this, SLOT(NewConnection()));
+        IPCSocket = m_server->nextPendingConnection();
+
+        if(!IPCSocket) return;
+
+        // a private server has served its purpose, release the port
+        if(m_server != IPCServer)
+            m_server->close();
+    }
 
     m_connected = true;
 
@@ -158,8 +273,21 @@ void TCPBase::NewConnection()
 
 void TCPBase::RealStart()
 {
-    connect(IPCServer, SIGNAL(newConnection()), this, SLOT(NewConnection()));
+    // only listen once there is an engine to connect, instances that never
+    // start one (e.g. previews found in the cache) need no socket file
+    if(useLocalIPC() && !m_localServer && !listenLocally())
+    {
+        // a private instance wasn't queued, it must not share the TCP server
+        if(m_private && (m_server == IPCServer))
+            listenOnPrivatePort();
+    }
+
+    if(m_localServer)
+        connect(m_localServer, SIGNAL(newConnection()), this, SLOT(NewConnection()));
+    else
+        connect(m_server, SIGNAL(newConnection()), this, SLOT(NewConnection()));
     IPCSocket = 0;
+    m_startTime.start();
 
 #ifdef HWLIBRARY
     thread = new QThread(this);
@@ -203,6 +331,20 @@ void TCPBase::RealStart()
     m_hasStarted = true;
 }
 
+void TCPBase::Abort()
+{
+#ifndef HWLIBRARY
+    if(process)
+    {
+        disconnect(process, 0, this, 0);
+        process->kill();
+    }
+#endif
+    if(IPCSocket)
+        disconnect(IPCSocket, SIGNAL(disconnected()), this, SLOT(ClientDisconnect()));
+    ClientDisconnect();
+}
+
 void TCPBase::ClientDisconnect()
 {
     onClientDisconnect();
@@ -227,10 +369,57 @@ void TCPBase::ClientDisconnect()
 
 void TCPBase::ClientRead()
 {
-    QByteArray read = IPCSocket->readAll();
-    if(read.isEmpty()) return;
-    readbuffer.append(read);
-    onClientRead();
+    // Called from a nested event loop (e.g. a message box shown while
+    // handling a message): the messages handed out by the outer call still
+    // point into readbuffer, and growing it could move them. Leave the data
+    // in the socket until the outer call is done.
+    if(m_readDepth > 0)
+    {
+        m_readPending = true;
+        return;
+    }
+
+    do
+    {
+        m_readPending = false;
+
+        // the connection may have been closed while handling messages
+        if(!IPCSocket) return;
+
+        qint64 available = IPCSocket->bytesAvailable();
+        if(available <= 0) return;
+
+        // drop the messages taken so far: one move per read instead of one per message
+        if(m_readPos > 0)
+        {
+            readbuffer.remove(0, m_readPos);
+            m_readPos = 0;
+        }
+
+        // read straight into the buffer, its capacity is kept between reads
+        int size = readbuffer.size();
+        readbuffer.resize(size + int(available));
+        qint64 read = IPCSocket->read(readbuffer.data() + size, available);
+        readbuffer.resize(size + qMax<qint64>(read, 0));
+        if(read <= 0) return;
+
+        ++m_readDepth;
+        onClientRead();
+        --m_readDepth;
+    } while(m_readPending);
+}
+
+bool TCPBase::takeMessage(QByteArray & msg)
+{
+    int available = readbuffer.size() - m_readPos;
+    if(available <= 0) return false;
+
+    int size = quint8(readbuffer.at(m_readPos)) + 1;
+    if(size > available) return false;
+
+    msg = QByteArray::fromRawData(readbuffer.constData() + m_readPos, size);
+    m_readPos += size;
+    return true;
 }
 
 void TCPBase::StartProcessError(QProcess::ProcessError error)
@@ -279,6 +468,13 @@ void TCPBase::tcpServerReady()
 
 void TCPBase::Start(bool couldCancelPreviousRequest)
 {
+    // nobody else can connect to a private server, no need to queue
+    if(m_private)
+    {
+        RealStart();
+        return;
+    }
+
     if(srvsList.isEmpty())
     {
         srvsList.push_back(this);
@@ -318,30 +514,59 @@ void TCPBase::SendToClientFirst()
 void TCPBase::SendIPC(const QByteArray & buf)
 {
     if (buf.size() > MAXMSGCHARS) return;
-    quint8 len = buf.size();
-    RawSendIPC(QByteArray::fromRawData((char *)&len, 1) + buf);
+    char len = buf.size();
+    RawSendIPC(QByteArray::fromRawData(&len, 1));
+    RawSendIPC(buf);
 }
 
+// Messages sent while connected are collected and written to the socket
+// in one go once control returns to the event loop, so a config of
+// hundreds of lines doesn't cost hundreds of writes.
+// They go to the demo right away to keep their order relative to the
+// engine messages recorded by subclasses.
 void TCPBase::RawSendIPC(const QByteArray & buf)
 {
     if (!IPCSocket)
     {
         toSendBuf += buf;
+        return;
     }
-    else
+
+    if (toSendBuf.size() > 0)
     {
-        if (toSendBuf.size() > 0)
-        {
-            IPCSocket->write(toSendBuf);
-            if(m_isDemoMode) demo.append(toSendBuf);
-            toSendBuf.clear();
-        }
-        if(!buf.isEmpty())
-        {
-            IPCSocket->write(buf);
-            if(m_isDemoMode) demo.append(buf);
-        }
+        m_writeBuf.append(toSendBuf);
+        if(m_isDemoMode) demo.append(toSendBuf);
+        toSendBuf.clear();
+    }
+    if(!buf.isEmpty())
+    {
+        m_writeBuf.append(buf);
+        if(m_isDemoMode) demo.append(buf);
     }
+
+    if(!m_writePending && !m_writeBuf.isEmpty())
+    {
+        m_writePending = true;
+        QMetaObject::invokeMethod(this, "FlushIPC", Qt::QueuedConnection);
+    }
+}
+
+void TCPBase::FlushIPC()
+{
+    m_writePending = false;
+
+    if(!IPCSocket || m_writeBuf.isEmpty())
+        return;
+
+#ifdef QT_DEBUG
+    if(m_bytesWritten == 0)
+        qDebug("IPC: first %d bytes sent %lld ms after engine start", m_writeBuf.size(), m_startTime.elapsed());
+#endif
+
+    IPCSocket->write(m_writeBuf);
+    m_bytesWritten += m_writeBuf.size();
+    // keeps the reserved capacity
+    m_writeBuf.resize(0);
 }
 
 bool TCPBase::couldBeRemoved()
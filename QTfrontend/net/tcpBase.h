@@ -23,12 +23,14 @@
 #include <QObject>
 #include <QTcpServer>
 #include <QTcpSocket>
+#include <QLocalServer>
 #include <QByteArray>
 #include <QString>
 #include <QDir>
 #include <QProcess>
 #include <QThread>
 #include <QPointer>
+#include <QElapsedTimer>
 #include <QVector>
 #include <QList>
 
@@ -57,9 +59,25 @@ class TCPBase : public QObject
         quint16 ipc_port;
 
         void Start(bool couldCancelPreviousRequest);
-
+        // Stops the engine without waiting for it and disposes of this
+        // object like a disconnect does, but without the error message
+        // a dying engine would show. Not possible with the engine library.
+        void Abort();
+        bool listenPrivately();
+        // engine arguments telling it where to connect to
+        QStringList ipcArguments() const;
+
+        // Linear buffer of received data: new data is appended, and the
+        // messages taken so far are dropped from its front in one move
+        // before the next read (not a ring buffer).
         QByteArray readbuffer;
 
+        // Takes the next complete message (length byte included) from
+        // readbuffer, returns false if there is none yet. The message points
+        // into readbuffer without copying, so it is only valid until
+        // onClientRead() returns. Nested event loops don't read meanwhile.
+        bool takeMessage(QByteArray & msg);
+
         QByteArray toSendBuf;
         QByteArray demo;
 
@@ -73,6 +91,9 @@ class TCPBase : public QObject
 
     private:
         static QPointer<QTcpServer> IPCServer;
+        QPointer<QTcpServer> m_server;
+        QPointer<QLocalServer> m_localServer; // used instead of m_server if set
+        bool m_private; // nobody else listens on our server
 #ifdef HWLIBRARY
         QThread * thread;
 #else
@@ -81,13 +102,23 @@ class TCPBase : public QObject
         bool m_isDemoMode;
         bool m_connected;
         bool m_usesCustomLanguage;
+        int m_readPos;   // start of the first message not taken yet
+        int m_readDepth; // nesting level of onClientRead()
+        bool m_readPending; // data arrived during onClientRead(), read it afterwards
+        QByteArray m_writeBuf; // messages to be written in one go, see RawSendIPC()
+        bool m_writePending;
+        qint64 m_bytesWritten;
+        QElapsedTimer m_startTime;
         void RealStart();
-        QPointer<QTcpSocket> IPCSocket;
+        bool listenLocally();
+        bool listenOnPrivatePort();
+        QPointer<QIODevice> IPCSocket;
 
     private slots:
         void NewConnection();
         void ClientDisconnect();
         void ClientRead();
+        void FlushIPC();
         void StartProcessError(QProcess::ProcessError error);
         void onEngineDeath(int exitCode, QProcess::ExitStatus exitStatus);
 
@@ -45,6 +45,8 @@
 #include "AutoUpdater.h"
 #include "HWApplication.h"
 #include "keybinder.h"
+#include "MapPreviewCache.h"
+#include "hwmap.h"
 
 #ifdef __APPLE__
 #ifdef SPARKLE_ENABLED
@@ -461,6 +463,19 @@ QLayout * PageOptions::bodyLayoutDefinition()
             CBFrontendEffects->setText(QCheckBox::tr("Visual effects"));
             CBFrontendEffects->setWhatsThis(QCheckBox::tr("Enable visual effects such as animated menu transitions and falling stars"));
             groupFrontend->layout()->addWidget(CBFrontendEffects, 1, 0);
+
+            // Map preview cache
+
+            lblMapPreviewCache = new QLabel(groupFrontend);
+            groupFrontend->layout()->addWidget(lblMapPreviewCache, 2, 0);
+
+            btnClearMapPreviewCache = new QPushButton(groupFrontend);
+            btnClearMapPreviewCache->setText(QPushButton::tr("Clear"));
+            btnClearMapPreviewCache->setWhatsThis(QPushButton::tr("Delete all stored map previews"));
+            groupFrontend->layout()->addWidget(btnClearMapPreviewCache, 2, 1);
+
+            lblMapPreviews = new QLabel(groupFrontend);
+            groupFrontend->layout()->addWidget(lblMapPreviews, 3, 0);
         }
 
         { // group: colors
@@ -924,6 +939,32 @@ void PageOptions::connectSignals()
     connect(CBStereoMode, SIGNAL(currentIndexChanged(int)), this, SLOT(forceFullscreen(int)));
     connect(editNetNick, SIGNAL(editingFinished()), this, SLOT(trimNetNick()));
     connect(CBSavePassword, SIGNAL(stateChanged(int)), this, SLOT(savePwdChanged(int)));
+    connect(btnClearMapPreviewCache, SIGNAL(clicked()), this, SLOT(clearMapPreviewCache()));
+    connect(this, SIGNAL(pageEnter()), this, SLOT(updateMapPreviewCacheInfo()));
+}
+
+void PageOptions::updateMapPreviewCacheInfo()
+{
+    const MapPreviewCache & cache = MapPreviewCache::instance();
+    int hitRate = (cache.lookups() > 0) ? (100 * cache.hits() / cache.lookups()) : 0;
+
+    lblMapPreviewCache->setText(
+        tr("Map preview cache: %1 stored, %2 in memory, %3% hits")
+        .arg(cache.diskSize())
+        .arg(cache.size())
+        .arg(hitRate));
+
+    lblMapPreviews->setText(
+        tr("Map previews: %1 rendering, %2 waiting, %3 ms on average")
+        .arg(HWMap::runningPreviews())
+        .arg(HWMap::queuedPreviews())
+        .arg(HWMap::averageLatency()));
+}
+
+void PageOptions::clearMapPreviewCache()
+{
+    MapPreviewCache::instance().clear();
+    updateMapPreviewCacheInfo();
 }
 
 void PageOptions::setVolume(int volume)
@@ -179,6 +179,9 @@ class PageOptions : public AbstractPage
         QLabel * lblTags;
         QWidget * winResContainer;
         QWidget * tagsContainer;
+        QLabel * lblMapPreviewCache;
+        QLabel * lblMapPreviews;
+        QPushButton * btnClearMapPreviewCache;
 
     private slots:
         void forceFullscreen(int index);
@@ -200,6 +203,8 @@ class PageOptions : public AbstractPage
         void bindUpdated(int bindID);
         void resetAllBinds();
         void setVolume(int);
+        void updateMapPreviewCacheInfo();
+        void clearMapPreviewCache();
 
     public slots:
         void setDefaultOptions();
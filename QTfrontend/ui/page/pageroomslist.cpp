@@ -31,9 +31,10 @@
 #include <QSplitter>
 #include <QSettings>
 
-#include <QSortFilterProxyModel>
+#include <QTimer>
 
 #include "roomslistmodel.h"
+#include "RoomsFilterProxyModel.h"
 
 #include "gameSchemeModel.h"
 #include "hwconsts.h"
@@ -204,7 +205,8 @@ void PageRoomsList::connectSignals()
     connect(showPassword, SIGNAL(triggered()), this, SLOT(onFilterChanged()));
     connect(showJoinRestricted, SIGNAL(triggered()), this, SLOT(onFilterChanged()));
     connect(showIncompatible, SIGNAL(triggered()), this, SLOT(onFilterChanged()));
-    connect(searchText, SIGNAL(textChanged (const QString &)), this, SLOT(onFilterChanged()));
+    connect(searchText, SIGNAL(textChanged (const QString &)), m_searchTimer, SLOT(start()));
+    connect(m_searchTimer, SIGNAL(timeout()), this, SLOT(onFilterChanged()));
     connect(this, SIGNAL(askJoinConfirmation (const QString &)), this, SLOT(onJoinConfirmation(const QString &)), Qt::QueuedConnection);
 
     // Set focus on search box
@@ -236,8 +238,10 @@ PageRoomsList::PageRoomsList(QWidget* parent) :
     AbstractPage(parent)
 {
     roomsModel = NULL;
-    stateFilteredModel = NULL;
-    versionFilteredModel = NULL;
+
+    m_searchTimer = new QTimer(this);
+    m_searchTimer->setSingleShot(true);
+    m_searchTimer->setInterval(150);
 
     initPage();
 }
@@ -559,34 +563,13 @@ void PageRoomsList::setUser(const QString & nickname)
 
 void PageRoomsList::setModel(RoomsListModel * model)
 {
-    // filter chain:
-    // model -> versionFilteredModel -> stateFilteredModel -> schemeFilteredModel ->
-    // -> weaponsFilteredModel -> roomsModel (search filter+sorting)
-
     if (roomsModel == NULL)
     {
-        roomsModel = new QSortFilterProxyModel(this);
-        roomsModel->setDynamicSortFilter(true);
-        roomsModel->setSortCaseSensitivity(Qt::CaseInsensitive);
+        // filters and sorts in a single proxy
+        roomsModel = new RoomsFilterProxyModel(this);
         roomsModel->sort(RoomsListModel::StateColumn, Qt::AscendingOrder);
 
-        versionFilteredModel = new QSortFilterProxyModel(this);
-        versionFilteredModel->setDynamicSortFilter(true);
-        versionFilteredModel->setFilterKeyColumn(RoomsListModel::VersionColumn);
-        versionFilteredModel->setFilterRole(Qt::UserRole);
-
-        stateFilteredModel = new QSortFilterProxyModel(this);
-        stateFilteredModel->setDynamicSortFilter(true);
-        stateFilteredModel->setFilterKeyColumn(RoomsListModel::StateColumn);
-        stateFilteredModel->setSourceModel(versionFilteredModel);
-
-        roomsModel->setFilterKeyColumn(-1); // search in all columns
-
-        roomsModel->setFilterCaseSensitivity(Qt::CaseInsensitive);
-
-        roomsModel->setSourceModel(stateFilteredModel);
-
-        // let the table view display the last model in the filter chain
+        // let the table view display the filtered model
         roomsList->setModel(roomsModel);
 
         // When the data changes
@@ -596,7 +579,7 @@ void PageRoomsList::setModel(RoomsListModel * model)
         connect(roomsList->selectionModel(), SIGNAL(currentRowChanged(const QModelIndex &, const QModelIndex &)), this, SLOT(roomSelectionChanged(const QModelIndex &, const QModelIndex &)));
     }
 
-    versionFilteredModel->setSourceModel(model);
+    roomsModel->setSourceModel(model);
 
     QHeaderView * h = roomsList->horizontalHeader();
 
@@ -643,39 +626,15 @@ void PageRoomsList::onFilterChanged()
     if (roomsModel == NULL)
         return;
 
-    roomsModel->setFilterFixedString(searchText->text());
-
-    bool stateLobby = showGamesInLobby->isChecked();
-    bool stateProgress = showGamesInProgress->isChecked();
-    bool statePassword = showPassword->isChecked();
-    bool stateJoinRestricted = showJoinRestricted->isChecked();
-    bool stateIncompatible = showIncompatible->isChecked();
-
-    if (!stateIncompatible)
-        versionFilteredModel->setFilterFixedString(*cProtoVer);
-    else
-        versionFilteredModel->setFilterFixedString("");
-
-    QString filter;
-    if (!stateLobby && !stateProgress)
-        filter = "O_o";
-    else if (stateLobby && stateProgress && statePassword && stateJoinRestricted)
-        filter = "";
-    else
-    {
-        QString exclude = "[^";
-        if (!stateProgress) exclude += "g";
-        if (!statePassword) exclude += "p";
-        if (!stateJoinRestricted) exclude += "j";
-        exclude += "]*";
-        if (stateProgress && statePassword && stateJoinRestricted) exclude = ".*";
-        filter = "^" + exclude;
-        if (!stateLobby) filter += "g" + exclude;
-        filter += "$";
-    }
-    //qDebug() << filter;
+    // typed text is applied now, no matter what triggered the change
+    m_searchTimer->stop();
 
-    stateFilteredModel->setFilterRegExp(filter);
+    roomsModel->setShowInLobby(showGamesInLobby->isChecked());
+    roomsModel->setShowInProgress(showGamesInProgress->isChecked());
+    roomsModel->setShowPassword(showPassword->isChecked());
+    roomsModel->setShowJoinRestricted(showJoinRestricted->isChecked());
+    roomsModel->setShowIncompatible(showIncompatible->isChecked());
+    roomsModel->setSearchText(searchText->text());
 }
 
 void PageRoomsList::setSettings(QSettings *settings)
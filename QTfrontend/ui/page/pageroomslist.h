@@ -26,7 +26,8 @@ class HWChatWidget;
 class GameSchemeModel;
 class QTableView;
 class RoomsListModel;
-class QSortFilterProxyModel;
+class RoomsFilterProxyModel;
+class QTimer;
 class QSplitter;
 
 class RoomTableView : public QTableView
@@ -91,9 +92,8 @@ class PageRoomsList : public AbstractPage
 
     private:
         QSettings * m_gameSettings;
-        QSortFilterProxyModel * roomsModel;
-        QSortFilterProxyModel * stateFilteredModel;
-        QSortFilterProxyModel * versionFilteredModel;
+        RoomsFilterProxyModel * roomsModel;
+        QTimer * m_searchTimer; ///< delays filtering while the search is typed
         QAction * showGamesInLobby;
         QAction * showGamesInProgress;
         QAction * showPassword;
@@ -38,6 +38,7 @@
 #include <QHBoxLayout>
 #include <QFileSystemWatcher>
 #include <QDateTime>
+#include <QTime>
 #include <QRegExp>
 #include <QXmlStreamReader>
 
@@ -47,6 +48,7 @@
 #include "LibavInteraction.h"
 #include "gameuiconfig.h"
 #include "recorder.h"
+#include "recorderscheduler.h"
 #include "ask_quit.h"
 #include "util/MessageDialog.h"
 
@@ -140,8 +142,14 @@ QLayout * PageVideos::bodyLayoutDefinition()
         btnOpenDir = new QPushButton(QPushButton::tr("Open videos directory"), pTableGroup);
         btnOpenDir->setWhatsThis(QPushButton::tr("Open the video directory in your system"));
 
+        // total speed and remaining time of the encodes
+        labelEncodeStatus = new QLabel(pTableGroup);
+        labelEncodeStatus->setWordWrap(true);
+        labelEncodeStatus->hide();
+
         QVBoxLayout *box = new QVBoxLayout(pTableGroup);
         box->addWidget(filesTable);
+        box->addWidget(labelEncodeStatus);
         box->addWidget(btnOpenDir);
 
         pPageLayout->addWidget(pTableGroup, 0, 1);
@@ -190,6 +198,16 @@ QLayout * PageVideos::bodyLayoutDefinition()
         btnDelete->setWhatsThis(QPushButton::tr("Delete this video"));
         pBottomDescLayout->addWidget(btnDelete);
 
+        // buttons for videos waiting to be encoded
+        btnPrioritize = new QPushButton(QPushButton::tr("Encode next"), pDescGroup);
+        btnPrioritize->setWhatsThis(QPushButton::tr("Encode this video before the other waiting ones"));
+        btnPrioritize->hide();
+        pBottomDescLayout->addWidget(btnPrioritize);
+        btnPause = new QPushButton(QPushButton::tr("Pause"), pDescGroup);
+        btnPause->setWhatsThis(QPushButton::tr("Keep this video waiting until it is resumed"));
+        btnPause->hide();
+        pBottomDescLayout->addWidget(btnPause);
+
         pDescLayout->addWidget(labelThumbnail, 0);
         pDescLayout->addWidget(labelDesc, 0);
         pDescLayout->addLayout(pBottomDescLayout, 0);
@@ -214,6 +232,9 @@ void PageVideos::connectSignals()
     connect(btnPlay,   SIGNAL(clicked()), this, SLOT(playSelectedFile()));
     connect(btnDelete, SIGNAL(clicked()), this, SLOT(deleteSelectedFiles()));
     connect(btnOpenDir, SIGNAL(clicked()), this, SLOT(openVideosDirectory()));
+    connect(btnPrioritize, SIGNAL(clicked()), this, SLOT(prioritizeSelected()));
+    connect(btnPause, SIGNAL(clicked()), this, SLOT(pauseSelected()));
+    connect(&RecorderScheduler::instance(), SIGNAL(statusChanged()), this, SLOT(updateEncodeStatus()));
 }
 
 PageVideos::PageVideos(QWidget* parent) : AbstractPage(parent),
@@ -328,6 +349,7 @@ void PageVideos::addRecorder(HWRecorder* pRecorder)
     filesTable->setCellWidget(row, vcProgress, progressBar);
 
     numRecorders++;
+    updateEncodeStatus();
 }
 
 void PageVideos::setProgress(int row, VideoItem* item, float value)
@@ -532,18 +554,28 @@ void PageVideos::updateDescription()
         clearThumbnail();
         btnPlay->setEnabled(false);
         btnDelete->setEnabled(false);
+        updateQueueButtons(NULL);
         return;
     }
 
     btnPlay->setEnabled(item->ready());
     btnDelete->setEnabled(true);
     btnDelete->setText(item->ready()? QPushButton::tr("Delete") :  QPushButton::tr("Cancel"));
+    updateQueueButtons(item);
 
     // construct string with desctiption of this file to display it
     QString desc = item->name + "\n\n";
 
     if (!item->ready())
-        desc += tr("(in progress...)");
+    {
+        RecorderScheduler & scheduler = RecorderScheduler::instance();
+        if (scheduler.isPaused(item->pRecorder))
+            desc += tr("(paused)");
+        else if (scheduler.isQueued(item->pRecorder))
+            desc += tr("(waiting...)");
+        else
+            desc += tr("(in progress...)");
+    }
     else
     {
         QString path = item->path();
@@ -686,6 +718,82 @@ void PageVideos::deleteSelectedFiles()
 #endif
 }
 
+// only videos which wait for their turn can be moved or paused
+void PageVideos::updateQueueButtons(VideoItem * item)
+{
+    RecorderScheduler & scheduler = RecorderScheduler::instance();
+    bool queued = item && !item->ready() && scheduler.isQueued(item->pRecorder);
+    btnPrioritize->setVisible(queued);
+    btnPause->setVisible(queued);
+    if (queued)
+        btnPause->setText(scheduler.isPaused(item->pRecorder) ? QPushButton::tr("Resume") : QPushButton::tr("Pause"));
+}
+
+void PageVideos::prioritizeSelected()
+{
+    VideoItem * item = nameItem(filesTable->currentRow());
+    if (item && !item->ready())
+        RecorderScheduler::instance().prioritize(item->pRecorder);
+}
+
+void PageVideos::pauseSelected()
+{
+    VideoItem * item = nameItem(filesTable->currentRow());
+    if (!item || item->ready())
+        return;
+    RecorderScheduler & scheduler = RecorderScheduler::instance();
+    scheduler.setPaused(item->pRecorder, !scheduler.isPaused(item->pRecorder));
+    updateDescription();
+}
+
+void PageVideos::updateEncodeStatus()
+{
+    RecorderScheduler & scheduler = RecorderScheduler::instance();
+
+    // mark videos which are not encoded yet in their progress bars
+    int count = filesTable->rowCount();
+    for (int i = 0; i < count; i++)
+    {
+        VideoItem * item = nameItem(i);
+        if (item->ready())
+            continue;
+        QProgressBar * progressBar = (QProgressBar*)filesTable->cellWidget(i, vcProgress);
+        if (!progressBar)
+            continue;
+        if (scheduler.isPaused(item->pRecorder))
+            //: Video encoding progress of a video which was paused by the user
+            progressBar->setFormat(tr("paused"));
+        else if (scheduler.isQueued(item->pRecorder))
+            //: Video encoding progress of a video which waits for other encodes to finish
+            progressBar->setFormat(tr("waiting"));
+        else if (item->progress == 0)
+            setProgress(i, item, 0);
+    }
+    updateQueueButtons(nameItem(filesTable->currentRow()));
+
+    if (scheduler.numRunning() + scheduler.numQueued() == 0)
+    {
+        labelEncodeStatus->hide();
+        return;
+    }
+
+    //: %1 = number of videos being encoded, %2 = how many may be encoded at once, %3 = number of waiting videos
+    QString status = tr("Encoding %1 of %2 at once, %3 waiting").arg(scheduler.numRunning()).arg(scheduler.maxRunning()).arg(scheduler.numQueued());
+    double speed = scheduler.speed();
+    if (speed > 0)
+        //: Total encoding speed, e.g. “2.5× real time”
+        status += "\n" + tr("Speed: %1× real time").arg(QLocale().toString(speed, 'f', 1));
+    qint64 remaining = scheduler.remainingTime();
+    if (remaining >= 0)
+    {
+        QTime time = QTime(0, 0).addMSecs(remaining);
+        //: Estimated time until all videos are encoded
+        status += "\n" + tr("Time left: %1").arg(time.toString(remaining >= 3600*1000 ? "h:mm:ss" : "m:ss"));
+    }
+    labelEncodeStatus->setText(status);
+    labelEncodeStatus->show();
+}
+
 void PageVideos::keyPressEvent(QKeyEvent * pEvent)
 {
     if (filesTable->hasFocus())
@@ -765,7 +873,7 @@ QString PageVideos::getVideosInProgress()
         list += QString(tr("%1 (%2%) - %3"))
             .arg(item->name)
             .arg(QLocale().toString(progress, 'f', 2))
-            .arg(tr("encoding"))
+            .arg(RecorderScheduler::instance().isQueued(item->pRecorder) ? tr("waiting") : tr("encoding"))
             + "\n";
     }
     return list;
@@ -58,15 +58,18 @@ class PageVideos : public AbstractPage
         void clearTemp();
         void clearThumbnail();
         void setProgress(int row, VideoItem* item, float value);
+        void updateQueueButtons(VideoItem* item);
 
         GameUIConfig * config;
 
         // file list group
         QTableWidget *filesTable;
         QPushButton *btnOpenDir;
+        QLabel *labelEncodeStatus;
 
         // description group
         QPushButton *btnPlay, *btnDelete;
+        QPushButton *btnPrioritize, *btnPause;
         QLabel *labelDesc;
         QLabel *labelThumbnail;
 
@@ -84,6 +87,9 @@ class PageVideos : public AbstractPage
         void currentCellChanged();
         void playSelectedFile();
         void deleteSelectedFiles();
+        void prioritizeSelected();
+        void pauseSelected();
+        void updateEncodeStatus();
         void openVideosDirectory();
         void updateFileList(const QString & path);
         void ShowFatalErrorMessage(const QString & msg);
@@ -19,6 +19,8 @@
 
 #include <QDesktopServices>
 #include <QTextBrowser>
+#include <QTextCursor>
+#include <QTextDocument>
 #include <QAction>
 #include <QFile>
 #include <QTextStream>
@@ -34,6 +36,7 @@
 #include <QScrollBar>
 #include <QMimeData>
 #include <QMessageBox> // Required for QMessageBox
+#include <QDebug>
 
 #include "DataManager.h"
 #include "hwconsts.h"
@@ -48,6 +51,9 @@ QStringList * HWChatWidget::s_displayNone = NULL;
 bool HWChatWidget::s_isTimeStamped = true;
 QString HWChatWidget::s_tsFormat = ":mm:ss";
 
+// number of chat entries kept in the chat log
+static const int MAX_CHAT_LINES = 250;
+
 const QString & HWChatWidget::styleSheet()
 {
     if (s_styleSheet != NULL)
@@ -452,25 +458,34 @@ QString HWChatWidget::linkedNick(const QString & nickname)
 // Regex to make some URLs clickable for selected domains:
 // - hedgewars.org (official website)
 // - hh.unit22.org (community addon server)
-const QRegExp HWChatWidget::URLREGEXP = QRegExp("(http(s)?://)?(www\\.)?((([^/:?&#]+\\.)?hedgewars\\.org|hh\\.unit22\\.org)(/[^ ]*)?)");
+static QRegularExpression urlRegExp()
+{
+    QRegularExpression regexp("(http(s)?://)?(www\\.)?((([^/:?&#]+\\.)?hedgewars\\.org|hh\\.unit22\\.org)(/[^ ]*)?)");
+    regexp.optimize();
+    return regexp;
+}
 
 bool HWChatWidget::containsHighlight(const QString & sender, const QString & message)
 {
     if ((sender != m_userNick) && (!m_userNick.isEmpty()))
     {
-        QString lcStr = message.toLower();
+        QString lowerMessage = message.toLower();
 
-        foreach (const QRegExp & hl, m_highlights)
-        {
-            if (lcStr.contains(hl))
+        if (!m_highlight.pattern().isEmpty() && lowerMessage.contains(m_highlight))
+            return true;
+
+        foreach (const QRegularExpression & regexp, m_separateHighlights)
+            if (lowerMessage.contains(regexp))
                 return true;
-        }
     }
     return false;
 }
 
 QString HWChatWidget::messageToHTML(const QString & message)
 {
+    // built and optimized only once, by the first message
+    static const QRegularExpression URLREGEXP = urlRegExp();
+
     QString formattedStr = message.toHtmlEscaped();
     // link some URLs
     formattedStr = formattedStr.replace(URLREGEXP, "<a href=\"http\\2://\\4\">\\4</a>");
@@ -524,11 +539,6 @@ void HWChatWidget::addLine(const QString & cssClass, QString line, bool isHighli
     if (s_displayNone->contains(cssClass))
         return; // the css forbids us to display this line
 
-    beforeContentAdd();
-
-    if (chatStrings.size() > 250)
-        chatStrings.removeFirst();
-
     if (s_isTimeStamped)
     {
         QString tsMarkUp = "<span class=\"timestamp\">[%1]</span> ";
@@ -546,27 +556,78 @@ void HWChatWidget::addLine(const QString & cssClass, QString line, bool isHighli
             HWApplication::alert(this, 800);
     }
 
-    chatStrings.append(QStringLiteral("<div>%1</div>").arg(line));
-
-    chatText->setHtml("<html><body>"+chatStrings.join("")+"</body></html>");
-
-    afterContentAdd();
+    appendHtml(QStringLiteral("<div>%1</div>").arg(line));
 }
 
 void HWChatWidget::onServerMessage(const QString& str)
+{
+    appendHtml("<hr>" + str + "<hr>");
+}
+
+// Adds an entry at the end of the chat log, dropping the oldest one if
+// the log is full. Only the new entry is parsed and laid out.
+void HWChatWidget::appendHtml(const QString & html)
 {
     beforeContentAdd();
 
-    if (chatStrings.size() > 250)
+    if (chatStrings.size() >= MAX_CHAT_LINES)
+    {
         chatStrings.removeFirst();
 
-    chatStrings.append("<hr>" + str + "<hr>");
+        // select the blocks of the oldest entry, including the separator
+        // to the next one, and remove them
+        QTextCursor cursor(chatText->document());
+        cursor.movePosition(QTextCursor::NextBlock, QTextCursor::KeepAnchor, chatBlocks.takeFirst());
+        cursor.removeSelectedText();
+    }
 
-    chatText->setHtml("<html><body>"+chatStrings.join("")+"</body></html>");
+    chatStrings.append(html);
+    insertHtml(html);
 
     afterContentAdd();
 }
 
+void HWChatWidget::insertHtml(const QString & html)
+{
+    QTextDocument * doc = chatText->document();
+    QTextCursor cursor(doc);
+    cursor.movePosition(QTextCursor::End);
+
+    // an empty document already has the block to insert into
+    int blocks = doc->blockCount();
+    if (doc->isEmpty())
+        blocks--;
+    else
+        cursor.insertBlock(QTextBlockFormat(), QTextCharFormat());
+
+    cursor.insertHtml(html);
+
+    chatBlocks.append(doc->blockCount() - blocks);
+}
+
+// Sets the current style sheet on the chat log. The document only applies
+// its style sheet while parsing, so the kept entries are parsed again.
+void HWChatWidget::applyStyleSheet()
+{
+    chatText->document()->setDefaultStyleSheet(*s_styleSheet);
+
+    beforeContentAdd();
+
+    chatText->clear();
+    chatBlocks.clear();
+    foreach (const QString & html, chatStrings)
+        insertHtml(html);
+
+    afterContentAdd();
+}
+
+void HWChatWidget::clearText()
+{
+    chatText->clear();
+    chatStrings.clear();
+    chatBlocks.clear();
+}
+
 
 void HWChatWidget::nickAdded(const QString & nick, bool notifyNick)
 {
@@ -643,32 +704,30 @@ void HWChatWidget::clear()
     cmds << "/clear" << "/help" << "/info" << "/me" << "/quit" << "/rnd";
     chatEditLine->addCommands(cmds);
 
-    chatText->clear();
-    chatStrings.clear();
+    clearText();
     //chatNicks->clear();
 
-    // clear and re compile regexp for highlighting
-    m_highlights.clear();
-
-    QString hlRegExp("^(.* )?%1[^-a-z0-9_]*( .*)?$");
-    QRegExp whitespace("\\s");
+    // collect highlighting terms and compile them into a single regexp
+    QStringList words;
+    QStringList patterns;
+    m_separateHighlights.clear();
 
     if (!m_userNick.isEmpty())
-        m_highlights.append(QRegExp(hlRegExp.arg(QRegExp::escape(m_userNick.toLower()))));
+        words << QRegularExpression::escape(m_userNick.toLower());
 
     QFile file(cfgdir->absolutePath() + "/" + m_userNick.toLower() + "_highlight.txt");
 
     if (file.exists() && (file.open(QIODevice::ReadOnly | QIODevice::Text)))
     {
+        QRegularExpression whitespace("\\s");
         QTextStream in(&file);
         while (!in.atEnd())
         {
             QString line = in.readLine();
-            QStringList list = line.split(whitespace);
+            QStringList list = line.split(whitespace, QString::SkipEmptyParts);
             foreach (QString word, list)
             {
-                m_highlights.append(QRegExp(
-                                        hlRegExp.arg(QRegExp::escape(word.toLower()))));
+                words << QRegularExpression::escape(word.toLower());
             }
         }
 
@@ -680,15 +739,43 @@ void HWChatWidget::clear()
 
     if (file2.exists() && (file2.open(QIODevice::ReadOnly | QIODevice::Text)))
     {
+        // group numbers change inside the alternation, so patterns referring
+        // to their own groups are matched on their own
+        QRegularExpression groupReference("\\\\([1-9]|g|k)|\\(\\?(P=|P>|&|R|[-+]?[0-9])");
         QTextStream in(&file2);
         while (!in.atEnd())
         {
-            m_highlights.append(QRegExp(in.readLine().toLower()));
+            QString pattern = in.readLine().toLower();
+            if (pattern.isEmpty())
+                continue;
+            QRegularExpression regexp(pattern);
+            // one broken line must not break the whole expression
+            if (!regexp.isValid())
+                qWarning() << "Ignoring invalid highlight regexp" << pattern;
+            else if (pattern.contains(groupReference))
+            {
+                regexp.optimize();
+                m_separateHighlights.append(regexp);
+            }
+            else
+                patterns << QString("(?:%1)").arg(pattern);
         }
 
         if (file2.isOpen())
             file2.close();
     }
+
+    // a word is highlighted when it starts the message or follows a space,
+    // and is followed only by punctuation up to the end or the next space
+    if (!words.isEmpty())
+        patterns.prepend(QString("(?:^| )(?:%1)[^-a-z0-9_]*(?: |$)").arg(words.join("|")));
+
+    QString pattern = patterns.join("|");
+    if (pattern != m_highlight.pattern())
+    {
+        m_highlight.setPattern(pattern);
+        m_highlight.optimize();
+    }
 }
 
 void HWChatWidget::onPlayerInfo(
@@ -953,7 +1040,7 @@ void HWChatWidget::dropEvent(QDropEvent * event)
         }
 
         setStyleSheet(style);
-        chatText->document()->setDefaultStyleSheet(*s_styleSheet);
+        applyStyleSheet();
         displayNotice(tr("Stylesheet imported from %1").arg(path));
         displayNotice(tr("Enter %1 if you want to use the current StyleSheet in future, enter %2 to reset!").arg("/saveStyleSheet").arg("/discardStyleSheet"));
 
@@ -970,7 +1057,7 @@ void HWChatWidget::dropEvent(QDropEvent * event)
 void HWChatWidget::discardStyleSheet()
 {
     setStyleSheet();
-    chatText->document()->setDefaultStyleSheet(*s_styleSheet);
+    applyStyleSheet();
     displayNotice(tr("StyleSheet discarded"));
 }
 
@@ -1016,8 +1103,7 @@ bool HWChatWidget::parseCommand(const QString & line)
         if (tline.startsWith("/me"))
             return false; // not a real command
         else if (tline == "/clear") {
-            chatStrings.clear();
-            chatText->clear();
+            clearText();
         }
         else if (tline == "/discardStyleSheet")
             discardStyleSheet();
@@ -26,6 +26,7 @@
 #include <QList>
 #include <QPair>
 #include <QRegExp>
+#include <QRegularExpression>
 #include <QHash>
 #include <QListWidgetItem>
 
@@ -77,11 +78,14 @@ class HWChatWidget : public QWidget
         static QStringList * s_displayNone;
         static bool s_isTimeStamped;
         static QString s_tsFormat;
-        static const QRegExp URLREGEXP;
 
         static void setStyleSheet(const QString & styleSheet = "");
 
         void addLine(const QString & cssClass, QString line, bool isHighlight = false);
+        void appendHtml(const QString & html);
+        void insertHtml(const QString & html);
+        void applyStyleSheet();
+        void clearText();
         bool parseCommand(const QString & line);
         void discardStyleSheet();
         void saveStyleSheet();
@@ -139,7 +143,8 @@ class HWChatWidget : public QWidget
         bool m_isAdmin;
         QHBoxLayout mainLayout;
         QTextBrowser* chatText;
-        QStringList chatStrings;
+        QStringList chatStrings; ///< HTML of the shown entries, oldest first
+        QList<int> chatBlocks; ///< number of text blocks of each entry in chatStrings
         QListView* chatNicks;
         SmartLineEdit* chatEditLine;
         QAction * acInfo;
@@ -157,7 +162,8 @@ class HWChatWidget : public QWidget
         QString m_hilightSound;
         QString m_userNick;
         QString m_clickedNick;
-        QList<QRegExp> m_highlights; ///< regular expressions used for highlighting
+        QRegularExpression m_highlight; ///< all highlight terms in one expression, empty if there are none
+        QList<QRegularExpression> m_separateHighlights; ///< custom patterns with backreferences, see m_highlight
         bool notify;
         bool m_autoKickEnabled;
         bool m_scrollToBottom;
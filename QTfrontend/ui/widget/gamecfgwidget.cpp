@@ -370,19 +370,6 @@ QByteArray GameCFGWidget::getFullConfig() const
             bcfg << QString("e$maze_size %1").arg(pMapContainer->getMazeSize()).toUtf8();
             break;
 
-        case MAPGEN_DRAWN:
-        {
-            QByteArray data = pMapContainer->getDrawnMapData();
-            while(data.size() > 0)
-            {
-                QByteArray tmp = data;
-                tmp.truncate(200);
-                tmp.prepend("edraw ");
-                bcfg << tmp;
-                data.remove(0, 200);
-            }
-            break;
-        }
         default:
             ;
     }
@@ -392,6 +379,9 @@ QByteArray GameCFGWidget::getFullConfig() const
     foreach(QByteArray ba, bcfg)
     HWProto::addByteArrayToBuffer(result, ba);
 
+    if (mapgen == MAPGEN_DRAWN)
+        HWProto::addDrawnMapToBuffer(result, pMapContainer->getDrawnMapData());
+
     return result;
 }
 
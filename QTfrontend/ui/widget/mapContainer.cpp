@@ -438,20 +438,6 @@ void HWMapContainer::addInfoToPreview(const QPixmap &image, const QLinearGradien
 
 void HWMapContainer::askForGeneratedPreview()
 {
-    pMap = new HWMap(this);
-    connect(pMap, SIGNAL(ImageReceived(QPixmap)), this, SLOT(onImageReceived(const QPixmap)));
-    connect(pMap, SIGNAL(HHLimitReceived(int)), this, SLOT(setHHLimit(int)));
-    connect(pMap, SIGNAL(destroyed(QObject *)), this, SLOT(onPreviewMapDestroyed(QObject *)));
-    pMap->getImage(m_seed,
-                   getTemplateFilter(),
-                   get_mapgen(),
-                   getMazeSize(),
-                   getDrawnMapData(),
-                   m_script,
-                   m_scriptparam,
-                   m_mapFeatureSize
-                  );
-
     setHHLimit(0);
 
     QPixmap waitImage(m_previewSize);
@@ -466,6 +452,22 @@ void HWMapContainer::askForGeneratedPreview()
     setImage(waitImage, linearGradLoading, false);
 
     cType->setEnabled(false);
+
+    // cached previews are delivered right away, so set up the
+    // waiting image first
+    pMap = new HWMap(this);
+    connect(pMap, SIGNAL(ImageReceived(QPixmap)), this, SLOT(onImageReceived(const QPixmap)));
+    connect(pMap, SIGNAL(HHLimitReceived(int)), this, SLOT(setHHLimit(int)));
+    connect(pMap, SIGNAL(destroyed(QObject *)), this, SLOT(onPreviewMapDestroyed(QObject *)));
+    pMap->getImage(m_seed,
+                   getTemplateFilter(),
+                   get_mapgen(),
+                   getMazeSize(),
+                   getDrawnMapData(),
+                   m_script,
+                   m_scriptparam,
+                   m_mapFeatureSize
+                  );
 }
 
 void HWMapContainer::previewClicked()
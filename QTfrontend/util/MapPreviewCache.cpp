@@ -0,0 +1,182 @@
+/*
+ * Hedgewars, a free turn based strategy game
+ * Copyright (c) 2004-2015 Andrey Korotaev <unC0Rr@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/**
+ * @file
+ * @brief MapPreviewCache class implementation
+ */
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+
+#include "hwconsts.h"
+
+#include "MapPreviewCache.h"
+
+// a preview is 4097 or 32769 bytes, keep a few hundred of them in memory
+static const int memoryCacheBytes = 16 * 1024 * 1024;
+static const int maxDiskEntries = 4096;
+
+MapPreviewCache::MapPreviewCache() :
+    m_memory(memoryCacheBytes),
+    m_hits(0),
+    m_lookups(0)
+{
+    m_path = cfgdir->absoluteFilePath("MapPreviewCache");
+    QDir().mkpath(m_path);
+    m_diskEntries = QDir(m_path).entryList(QDir::Files).size();
+}
+
+
+MapPreviewCache & MapPreviewCache::instance()
+{
+    static MapPreviewCache instance;
+    return instance;
+}
+
+
+QByteArray MapPreviewCache::key(const QByteArray & config)
+{
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+
+    // previews of a different engine version might differ
+    hash.addData(cVersionString->toUtf8());
+    hash.addData(config);
+
+    return hash.result().toHex();
+}
+
+
+QString MapPreviewCache::fileName(const QByteArray & key) const
+{
+    return m_path + "/" + QString::fromLatin1(key);
+}
+
+
+// Marks an entry on disk as just used, trimDisk() removes the least
+// recently used ones first. The file has to be open for writing on Windows.
+static void touch(QFile & file)
+{
+    // opening a missing file for writing would create it
+    if(file.isOpen() || (file.exists() && file.open(QIODevice::ReadWrite)))
+        file.setFileTime(QDateTime::currentDateTimeUtc(), QFileDevice::FileModificationTime);
+}
+
+
+bool MapPreviewCache::find(const QByteArray & key, QByteArray & preview)
+{
+    ++m_lookups;
+
+    QByteArray * cached = m_memory.object(key);
+    if(cached)
+    {
+        preview = *cached;
+        ++m_hits;
+        QFile file(fileName(key));
+        touch(file);
+        return true;
+    }
+
+    QFile file(fileName(key));
+    if(!file.exists())
+        return false;
+    // read-only if the cache directory is, the entry just won't be touched then
+    if(!file.open(QIODevice::ReadWrite) && !file.open(QIODevice::ReadOnly))
+        return false;
+
+    preview = file.readAll();
+    if((preview.size() != 128 * 32 + 1) && (preview.size() != 128 * 256 + 1))
+    {
+        // truncated or otherwise damaged
+        file.remove();
+        --m_diskEntries;
+        return false;
+    }
+
+    touch(file);
+    m_memory.insert(key, new QByteArray(preview), preview.size());
+    ++m_hits;
+    return true;
+}
+
+
+void MapPreviewCache::insert(const QByteArray & key, const QByteArray & preview)
+{
+    m_memory.insert(key, new QByteArray(preview), preview.size());
+
+    QFile file(fileName(key));
+    bool existed = file.exists();
+    if(file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+        file.write(preview);
+        if(!existed && (++m_diskEntries > maxDiskEntries))
+            trimDisk();
+    }
+}
+
+
+// Removes the least recently used quarter of the on-disk entries.
+void MapPreviewCache::trimDisk()
+{
+    QFileInfoList files = QDir(m_path).entryInfoList(QDir::Files, QDir::Time);
+    int keep = maxDiskEntries * 3 / 4;
+
+    for(int i = keep; i < files.size(); ++i)
+        QFile::remove(files[i].absoluteFilePath());
+
+    m_diskEntries = qMin(keep, files.size());
+}
+
+
+void MapPreviewCache::clear()
+{
+    m_memory.clear();
+
+    QDir dir(m_path);
+    foreach(const QString & name, dir.entryList(QDir::Files))
+        dir.remove(name);
+
+    m_diskEntries = 0;
+}
+
+
+int MapPreviewCache::size() const
+{
+    return m_memory.size();
+}
+
+
+int MapPreviewCache::diskSize() const
+{
+    return m_diskEntries;
+}
+
+
+int MapPreviewCache::hits() const
+{
+    return m_hits;
+}
+
+
+int MapPreviewCache::lookups() const
+{
+    return m_lookups;
+}
@@ -0,0 +1,99 @@
+/*
+ * Hedgewars, a free turn based strategy game
+ * Copyright (c) 2004-2015 Andrey Korotaev <unC0Rr@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/**
+ * @file
+ * @brief MapPreviewCache class definition
+ */
+
+#ifndef HEDGEWARS_MAPPREVIEWCACHE_H
+#define HEDGEWARS_MAPPREVIEWCACHE_H
+
+#include <QByteArray>
+#include <QCache>
+#include <QString>
+
+/**
+ * @brief Caches map previews rendered by the engine.
+ *
+ * Entries are keyed by a hash of all the messages sent to the engine to
+ * render the preview, so identical parameters never launch the engine twice.
+ * Recently used previews are kept in memory, all of them are also written to
+ * disk, so they survive restarts.
+ *
+ * @see <a href="https://en.wikipedia.org/wiki/Singleton_pattern">singleton pattern</a>
+ */
+class MapPreviewCache
+{
+    public:
+        /**
+         * @brief Returns reference to the <i>singleton</i> instance of this class.
+         *
+         * @return reference to the instance.
+         */
+        static MapPreviewCache & instance();
+
+        /**
+         * @brief Computes the cache key of a preview request.
+         *
+         * @param config length-prefixed IPC messages the engine is given to render the preview.
+         * @return key to be used with {@link find()} and {@link insert()}.
+         */
+        static QByteArray key(const QByteArray & config);
+
+        /**
+         * @brief Looks up a preview.
+         *
+         * @param key cache key.
+         * @param preview receives the engine's reply (bitmap followed by hedgehog limit).
+         * @return true on cache hit.
+         */
+        bool find(const QByteArray & key, QByteArray & preview);
+
+        /// Stores engine's reply for the given key.
+        void insert(const QByteArray & key, const QByteArray & preview);
+
+        /// Drops all cached previews, in memory and on disk.
+        void clear();
+
+        /// Number of previews held in memory.
+        int size() const;
+
+        /// Number of previews stored on disk.
+        int diskSize() const;
+
+        /// Number of lookups served from cache since start.
+        int hits() const;
+
+        /// Number of lookups since start.
+        int lookups() const;
+
+    private:
+        MapPreviewCache();
+
+        QString fileName(const QByteArray & key) const;
+        void trimDisk();
+
+        QCache<QByteArray, QByteArray> m_memory; ///< in-memory LRU, cost in bytes
+        QString m_path; ///< directory of on-disk entries
+        int m_diskEntries;
+        int m_hits;
+        int m_lookups;
+};
+
+#endif // HEDGEWARS_MAPPREVIEWCACHE_H
@@ -151,6 +151,19 @@ begin
         end
 end;
 
+procedure setIpcSocket(path: shortstring; var wrongParameter:Boolean);
+begin
+{$IFDEF USE_UNIX_IPC}
+    if isInternal then
+        ipcSocketPath := path
+    else
+{$ENDIF}
+        begin
+        WriteLn(stderr, 'ERROR: use of --ipc-socket is not allowed!');
+        wrongParameter := true;
+        end
+end;
+
 function parseNick(nick: shortstring): shortstring;
 begin
     if isInternal then
@@ -244,13 +257,14 @@ begin
 end;
 
 function parseParameter(cmd:string; arg:string; var paramIndex:LongInt): Boolean;
-const reallyAll: array[0..37] of shortstring = (
+const reallyAll: array[0..38] of shortstring = (
                 '--prefix', '--user-prefix', '--locale', '--fullscreen-width', '--fullscreen-height', '--width',
                 '--height', '--maximized', '--frame-interval', '--volume','--nomusic', '--nosound', '--nodampen',
                 '--fullscreen', '--showfps', '--altdmg', '--low-quality', '--raw-quality', '--stereo', '--nick',
                 '--zoom',
   {internal}    '--internal', '--port', '--recorder', '--landpreview',
-  {misc}        '--stats-only', '--gci', '--help','--protocol', '--no-teamtag','--no-hogtag','--no-healthtag','--translucent-tags','--lua-test','--no-holiday-silliness','--chat-size', '--prefix64', '--user-prefix64');
+  {misc}        '--stats-only', '--gci', '--help','--protocol', '--no-teamtag','--no-hogtag','--no-healthtag','--translucent-tags','--lua-test','--no-holiday-silliness','--chat-size', '--prefix64', '--user-prefix64',
+  {internal}    '--ipc-socket');
 var cmdIndex: byte;
 begin
     parseParameter:= false;
@@ -301,6 +315,7 @@ begin
         {--chat-size}           35 : cDefaultChatScale := 1.0 * getLongIntParameter(arg, paramIndex, parseParameter) / 100;
         {--prefix64}            36: PathPrefix := DecodeBase64(getstringParameter(arg, paramIndex, parseParameter));
         {--user-prefix64}       37: UserPathPrefix := DecodeBase64(getstringParameter(arg, paramIndex, parseParameter));
+        {--ipc-socket}          38: setIpcSocket( getstringParameter(arg, paramIndex, parseParameter), parseParameter );
     else
         begin
         //Assume the first "non parameter" is the demo file, anything else is invalid
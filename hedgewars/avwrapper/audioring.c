@@ -0,0 +1,128 @@
+/*
+ * Hedgewars, a free turn based strategy game
+ * Copyright (c) 2004-2015 Andrey Korotaev <unC0Rr@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "SDL.h"
+
+#include "audioring.h"
+
+/*
+ * Each side holds the mutex just long enough to move its position, the data
+ * is copied outside.
+ */
+static FILE* g_pFile;
+static uint8_t* g_pRing;
+static unsigned g_RingSize, g_ReadSize;
+static unsigned g_Read, g_Written;  // byte positions, wrapping around
+static int g_Eof, g_Stop;
+static SDL_mutex* g_pMutex;
+static SDL_cond* g_pCond;  // only one side can ever be waiting
+static SDL_Thread* g_pThread;
+
+static int SDLCALL ReadThread(void* p)
+{
+    (void)p;
+    SDL_LockMutex(g_pMutex);
+    while (!g_Eof && !g_Stop)
+    {
+        if (g_RingSize - (g_Written - g_Read) < g_ReadSize)
+        {
+            SDL_CondWait(g_pCond, g_pMutex);
+            continue;
+        }
+        unsigned Written = g_Written;
+        SDL_UnlockMutex(g_pMutex);
+
+        // the ring size is a multiple of the read size, so a read never wraps
+        size_t Size = fread(g_pRing + Written % g_RingSize, 1, g_ReadSize, g_pFile);
+
+        SDL_LockMutex(g_pMutex);
+        g_Written = Written + Size;
+        g_Eof = Size < g_ReadSize;
+        SDL_CondSignal(g_pCond);
+    }
+    SDL_UnlockMutex(g_pMutex);
+    return 0;
+}
+
+int AudioRing_Start(FILE* pFile, unsigned RingSize, unsigned ReadSize)
+{
+    g_pFile = pFile;
+    g_RingSize = RingSize;
+    g_ReadSize = ReadSize;
+    g_Read = g_Written = 0;
+    g_Eof = g_Stop = 0;
+    g_pRing = (uint8_t*)malloc(RingSize);
+    if (!g_pRing)
+        return -1;
+    g_pMutex = SDL_CreateMutex();
+    g_pCond = SDL_CreateCond();
+    if (!g_pMutex || !g_pCond)
+        return -1;
+    g_pThread = SDL_CreateThread(ReadThread, "avwrapper audio", NULL);
+    if (!g_pThread)
+        return -1;
+    return 0;
+}
+
+void AudioRing_Stop(void)
+{
+    if (g_pThread)
+    {
+        SDL_LockMutex(g_pMutex);
+        g_Stop = 1;
+        SDL_CondSignal(g_pCond);
+        SDL_UnlockMutex(g_pMutex);
+        SDL_WaitThread(g_pThread, NULL);
+        g_pThread = NULL;
+    }
+    SDL_DestroyCond(g_pCond);
+    SDL_DestroyMutex(g_pMutex);
+    g_pCond = NULL;
+    g_pMutex = NULL;
+    free(g_pRing);
+    g_pRing = NULL;
+}
+
+int AudioRing_Read(void* pData, int MaxSamples, unsigned SampleSize)
+{
+    unsigned Size = MaxSamples*SampleSize;
+
+    SDL_LockMutex(g_pMutex);
+    while (g_Written - g_Read < Size && !g_Eof)
+        SDL_CondWait(g_pCond, g_pMutex);
+    unsigned Read = g_Read;
+    unsigned Available = g_Written - Read;
+    SDL_UnlockMutex(g_pMutex);
+
+    if (Size > Available)
+        Size = Available - Available % SampleSize;
+    unsigned Offset = Read % g_RingSize;
+    unsigned First = Size < g_RingSize - Offset ? Size : g_RingSize - Offset;
+    memcpy(pData, g_pRing + Offset, First);
+    memcpy((uint8_t*)pData + First, g_pRing, Size - First);
+
+    SDL_LockMutex(g_pMutex);
+    g_Read = Read + Size;
+    SDL_CondSignal(g_pCond);
+    SDL_UnlockMutex(g_pMutex);
+    return Size / SampleSize;
+}
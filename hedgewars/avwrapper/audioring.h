@@ -0,0 +1,44 @@
+/*
+ * Hedgewars, a free turn based strategy game
+ * Copyright (c) 2004-2015 Andrey Korotaev <unC0Rr@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/*
+ * Ring buffer for the recorded sound: a reader thread streams the sound file
+ * into it, so that the encoder only copies samples from memory. It doesn't
+ * depend on libav, so it can be tested on its own.
+ */
+
+#ifndef AVWRAPPER_AUDIORING_H
+#define AVWRAPPER_AUDIORING_H
+
+#include <stdio.h>
+
+// Starts a thread reading pFile from its current position in pieces of
+// ReadSize bytes into a ring of RingSize bytes, which must be a multiple of
+// ReadSize. Returns -1 on error, AudioRing_Stop cleans up after that too.
+int AudioRing_Start(FILE* pFile, unsigned RingSize, unsigned ReadSize);
+
+// Works like fread on the file: waits until MaxSamples samples of SampleSize
+// bytes are buffered and returns fewer only at the end of the file. Must not
+// ask for more than the ring size at once.
+int AudioRing_Read(void* pData, int MaxSamples, unsigned SampleSize);
+
+// Stops the reader thread, even while it waits for room in the ring, and
+// frees the ring. The file is left to the caller.
+void AudioRing_Stop(void);
+
+#endif // AVWRAPPER_AUDIORING_H
@@ -31,6 +31,12 @@
 #include <libavcodec/bsf.h>
 #endif
 
+#include "SDL.h"
+
+#include "audioring.h"
+#include "pipeline.h"
+#include "yuv.h"
+
 #if (defined _MSC_VER)
 #define AVWRAP_DECL __declspec(dllexport)
 #elif ((__GNUC__ >= 3) && (!__EMX__) && (!sun))
@@ -46,7 +52,6 @@ static const AVOutputFormat* g_pFormat;
 static AVStream* g_pAStream;
 static AVStream* g_pVStream;
 static AVFrame* g_pAFrame;
-static AVFrame* g_pVFrame;
 static const AVCodec* g_pACodec;
 static const AVCodec* g_pVCodec;
 static AVCodecContext* g_pAudio;
@@ -60,6 +65,7 @@ static int g_Width, g_Height;
 static uint32_t g_Frequency, g_Channels;
 static int g_VQuality;
 static AVRational g_Framerate;
+static int64_t g_VideoPts;
 
 static FILE* g_pSoundFile;
 #if LIBAVUTIL_VERSION_MAJOR < 53
@@ -341,6 +347,23 @@ static void AddAudioStream()
 #endif
 }
 
+// The sound file is streamed by a reader thread into a ring buffer, so that
+// the encoder thread only copies samples from memory.
+#define AUDIO_READ_SIZE (64 << 10)
+#define AUDIO_RING_SIZE (16 * AUDIO_READ_SIZE)
+
+static int StartAudioReader()
+{
+    if (AudioRing_Start(g_pSoundFile, AUDIO_RING_SIZE, AUDIO_READ_SIZE) < 0)
+        return FatalError("Could not start the audio reader: %s", SDL_GetError());
+    return 0;
+}
+
+static void StopAudioReader()
+{
+    AudioRing_Stop();
+}
+
 // returns non-zero if there is more sound, -1 in case of error
 static int WriteAudioFrame()
 {
@@ -358,7 +381,7 @@ static int WriteAudioFrame()
     pData = g_pSamples;
 #endif
 
-    int NumSamples = fread(pData, 2*g_Channels, g_NumSamples, g_pSoundFile);
+    int NumSamples = AudioRing_Read(pData, g_NumSamples, 2*g_Channels);
 
 #if LIBAVCODEC_VERSION_MAJOR >= 53
     AVFrame* pFrame = NULL;
@@ -492,6 +515,12 @@ static int AddVideoStream()
     }
 #endif
 
+#if LIBAVCODEC_VERSION_MAJOR >= 53
+    // let the codec use as many threads as it sees fit, frames are queued anyway
+    g_pVideo->thread_count = 0;
+    g_pVideo->thread_type = FF_THREAD_FRAME | FF_THREAD_SLICE;
+#endif
+
     // open the codec
     if (avcodec_open2(g_pVideo, g_pVCodec, NULL) < 0)
         return FatalError("Could not open video codec %s", g_pVCodec->long_name);
@@ -502,22 +531,49 @@ static int AddVideoStream()
         return FatalError("Could not copy parameters from codec context: %d", ret);
 #endif
 
-    g_pVFrame = av_frame_alloc();
-    if (!g_pVFrame)
-        return FatalError("Could not allocate frame");
-    av_frame_unref(g_pVFrame);
-
-    g_pVFrame->width = g_Width;
-    g_pVFrame->height = g_Height;
-    g_pVFrame->format = AV_PIX_FMT_YUV420P;
-
 #if LIBAVCODEC_VERSION_MAJOR >= 58
     g_pVPacket = av_packet_alloc();
     if (!g_pVPacket)
         return FatalError("Could not allocate packet");
 #endif
 
-    return avcodec_default_get_buffer2(g_pVideo, g_pVFrame, 0);
+    return 0;
+}
+
+static int AllocVideoFrame(AVFrame** ppFrame)
+{
+    AVFrame* pFrame = av_frame_alloc();
+    if (!pFrame)
+        return FatalError("Could not allocate frame");
+    av_frame_unref(pFrame);
+
+    pFrame->width = g_Width;
+    pFrame->height = g_Height;
+    pFrame->format = AV_PIX_FMT_YUV420P;
+    *ppFrame = pFrame;
+
+    return avcodec_default_get_buffer2(g_pVideo, pFrame, 0);
+}
+
+// Makes sure the next picture can be written to pFrame.
+// With frame threading the codec may still hold a reference to the last one,
+// in that case the frame gets a fresh buffer instead of a copy of the old one.
+static int ReclaimVideoFrame(AVFrame* pFrame)
+{
+#if LIBAVUTIL_VERSION_MAJOR >= 53
+    if (av_frame_is_writable(pFrame))
+        return 0;
+    av_frame_unref(pFrame);
+
+    pFrame->width = g_Width;
+    pFrame->height = g_Height;
+    pFrame->format = AV_PIX_FMT_YUV420P;
+
+    return avcodec_default_get_buffer2(g_pVideo, pFrame, 0);
+#else
+    UNUSED(pFrame);
+    return 0;
+#endif
 }
 
 static int WriteFrame(AVFrame* pFrame)
@@ -531,7 +587,7 @@ static int WriteFrame(AVFrame* pFrame)
         if (!g_pAPacket)
             return FatalError("Error while writing video frame: g_pAPacket does not exist");
 #endif
-        VideoTime = (double)g_pVFrame->pts * g_pVStream->time_base.num/g_pVStream->time_base.den;
+        VideoTime = (double)g_VideoPts * g_pVStream->time_base.num/g_pVStream->time_base.den;
         do
         {
             if (!g_pAFrame)
@@ -547,7 +603,9 @@ static int WriteFrame(AVFrame* pFrame)
     if (!g_pVStream)
         return 0;
 
-    g_pVFrame->pts++;
+    g_VideoPts++;
+    if (pFrame)
+        pFrame->pts = g_VideoPts;
 #if LIBAVCODEC_VERSION_MAJOR >= 58
     ret = EncodeAndWriteFrame(g_pVStream, g_pVideo, pFrame, g_pVPacket);
     if (ret < 0)
@@ -605,48 +663,67 @@ static int WriteFrame(AVFrame* pFrame)
 #endif
 }
 
-AVWRAP_DECL int AVWrapper_WriteFrame(uint8_t *buf)
+/*
+ * The frames are converted and handed to WriteFrame by the pipeline in
+ * pipeline.c. All libav calls after AVWrapper_Init happen on its encoder
+ * thread until AVWrapper_Close stops it.
+ */
+static AVFrame* g_pVFrames[PIPELINE_QUEUE_SIZE];
+
+static void SetPlanes(PipelineFrame* pFrame, AVFrame* pAVFrame)
 {
-    int x, y, stride = g_Width * 4;
-    uint8_t *data[3];
-
-    // copy pointers, prepare source
-    memcpy(data, g_pVFrame->data, sizeof(data));
-    buf += (g_Height - 1) * stride;
-
-    // convert to YUV 4:2:0
-    for (y = 0; y < g_Height; y++) {
-        for (x = 0; x < g_Width; x++) {
-            int r = buf[x * 4 + 0];
-            int g = buf[x * 4 + 1];
-            int b = buf[x * 4 + 2];
-
-            int luma = (int)(0.299f * r +  0.587f * g + 0.114f * b);
-            data[0][x] = av_clip_uint8(luma);
-
-            if (!(x & 1) && !(y & 1)) {
-                int r = (buf[x * 4 + 0]          + buf[(x + 1) * 4 + 0] +
-                         buf[x * 4 + 0 - stride] + buf[(x + 1) * 4 + 0 - stride]) / 4;
-                int g = (buf[x * 4 + 1]          + buf[(x + 1) * 4 + 1] +
-                         buf[x * 4 + 1 - stride] + buf[(x + 1) * 4 + 1 - stride]) / 4;
-                int b = (buf[x * 4 + 2]          + buf[(x + 1) * 4 + 2] +
-                         buf[x * 4 + 2 - stride] + buf[(x + 1) * 4 + 2 - stride]) / 4;
-
-                int cr = (int)(-0.14713f * r - 0.28886f * g + 0.436f   * b);
-                int cb = (int)( 0.615f   * r - 0.51499f * g - 0.10001f * b);
-                data[1][x / 2] = av_clip_uint8(128 + cr);
-                data[2][x / 2] = av_clip_uint8(128 + cb);
-            }
-        }
-        buf += -stride;
-        data[0] += g_pVFrame->linesize[0];
-        if (y & 1) {
-            data[1] += g_pVFrame->linesize[1];
-            data[2] += g_pVFrame->linesize[2];
-        }
+    for (int i = 0; i < 3; i++)
+    {
+        pFrame->pPlanes[i] = pAVFrame->data[i];
+        pFrame->Linesizes[i] = pAVFrame->linesize[i];
+    }
+    pFrame->pUser = pAVFrame;
+}
+
+// called on the encoder thread
+static int WritePipelineFrame(PipelineFrame* pFrame)
+{
+    AVFrame* pAVFrame = (AVFrame*)pFrame->pUser;
+    if (WriteFrame(pAVFrame) < 0 || ReclaimVideoFrame(pAVFrame) < 0)
+        return -1;
+    // the codec may have kept the old buffers
+    SetPlanes(pFrame, pAVFrame);
+    return 0;
+}
+
+static int StartPipeline()
+{
+    PipelineFrame Frames[PIPELINE_QUEUE_SIZE];
+    for (int i = 0; i < PIPELINE_QUEUE_SIZE; i++)
+    {
+        int ret = AllocVideoFrame(&g_pVFrames[i]);
+        if (ret < 0)
+            return ret;
+        SetPlanes(&Frames[i], g_pVFrames[i]);
     }
 
-    return WriteFrame(g_pVFrame);
+    // leave a core for the engine, the codec runs its own threads anyway
+    if (Pipeline_Start(g_Width, g_Height, YUV_HaveSSE2(), SDL_GetCPUCount() - 1,
+                       Frames, WritePipelineFrame) < 0)
+        return FatalError("Could not start the frame pipeline: %s", SDL_GetError());
+    return 0;
+}
+
+static void FreePipeline()
+{
+    Pipeline_Free();
+    for (int i = 0; i < PIPELINE_QUEUE_SIZE; i++)
+    {
+        if (g_pVFrames[i])
+            av_frame_free(&g_pVFrames[i]);
+    }
+}
+
+AVWRAP_DECL int AVWrapper_WriteFrame(uint8_t *buf)
+{
+    if (!g_pVStream)
+        return 0;
+    return Pipeline_Queue(buf);
 }
 
 AVWRAP_DECL int AVWrapper_Init(
@@ -730,6 +807,8 @@ AVWRAP_DECL int AVWrapper_Init(
             fread(&g_Frequency, 4, 1, g_pSoundFile);
             fread(&g_Channels, 4, 1, g_pSoundFile);
             AddAudioStream();
+            if (g_pAStream && StartAudioReader() < 0)
+                return -1;
         }
         else
             Log("Could not open %s\n", pSoundFile);
@@ -759,17 +838,30 @@ AVWRAP_DECL int AVWrapper_Init(
 #endif
     }
 
-    g_pVFrame->pts = -1;
+    g_VideoPts = -1;
 
     // write the stream header, if any
-    return avformat_write_header(g_pContainer, NULL);
+    ret = avformat_write_header(g_pContainer, NULL);
+    if (ret < 0)
+        return ret;
+
+    // from here on the encoder thread owns the container
+    if (g_pVStream && StartPipeline() < 0)
+        return -1;
+    return ret;
 }
 
-AVWRAP_DECL int AVWrapper_Close()
+// Writes what the codecs still buffer and the trailer.
+static int FinishFile()
 {
     int ret;
     // output buffered frames
-    if (g_pVCodec->capabilities & AV_CODEC_CAP_DELAY)
+#if LIBAVCODEC_VERSION_MAJOR >= 53
+    if (g_pVStream && ((g_pVCodec->capabilities & AV_CODEC_CAP_DELAY) ||
+                       (g_pVideo->active_thread_type & FF_THREAD_FRAME)))
+#else
+    if (g_pVStream && (g_pVCodec->capabilities & AV_CODEC_CAP_DELAY))
+#endif
     {
         do
             ret = WriteFrame(NULL);
@@ -788,6 +880,17 @@ AVWRAP_DECL int AVWrapper_Close()
 
     // write the trailer, if any.
     av_write_trailer(g_pContainer);
+    return 0;
+}
+
+AVWRAP_DECL int AVWrapper_Close()
+{
+    // wait for the queued frames
+    int ret = Pipeline_Stop();
+    // after an error the file is lost, but the audio reader still has to be
+    // stopped and everything freed
+    if (ret >= 0)
+        ret = FinishFile();
 
     // close the output file
     if (!(g_pFormat->flags & AVFMT_NOFILE))
@@ -797,7 +900,7 @@ AVWRAP_DECL int AVWrapper_Close()
     if (g_pVStream)
     {
         avcodec_free_context(&g_pVideo);
-        av_frame_free(&g_pVFrame);
+        FreePipeline();
 #if LIBAVCODEC_VERSION_MAJOR >= 58
         av_packet_free(&g_pVPacket);
 #endif
@@ -812,6 +915,7 @@ AVWRAP_DECL int AVWrapper_Close()
 #if LIBAVUTIL_VERSION_MAJOR < 53
         av_free(g_pSamples);
 #endif
+        StopAudioReader();
         fclose(g_pSoundFile);
     }
 
@@ -824,5 +928,5 @@ AVWRAP_DECL int AVWrapper_Close()
         av_free(g_pAStream);
     av_free(g_pContainer);
 #endif
-    return 0;
+    return ret;
 }
@@ -0,0 +1,234 @@
+/*
+ * Hedgewars, a free turn based strategy game
+ * Copyright (c) 2004-2015 Andrey Korotaev <unC0Rr@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "SDL.h"
+
+#include "pipeline.h"
+#include "yuv.h"
+
+typedef struct
+{
+    uint8_t* pRGB;
+    PipelineFrame Frame;
+    int NextSlice;  // next slice to be handed to a conversion thread
+    int SlicesDone;
+} FrameSlot;
+
+static int g_Width, g_Height;
+static int g_UseSSE2;
+static PipelineWriteFn g_pWrite;
+
+static FrameSlot g_Slots[PIPELINE_QUEUE_SIZE];
+static int g_QueueHead, g_QueueCount;  // oldest slot and number of queued frames
+static int g_NumSlices;
+
+static SDL_mutex* g_pQueueMutex;
+static SDL_cond* g_pSliceCond;   // a queued frame has slices left to convert
+static SDL_cond* g_pEncodeCond;  // a frame was converted
+static SDL_cond* g_pFreeCond;    // a slot became free
+static SDL_Thread* g_pConvertThreads[PIPELINE_MAX_THREADS];
+static int g_NumConvertThreads;
+static SDL_Thread* g_pEncodeThread;
+static int g_StopPipeline;
+static int g_PipelineError;
+
+static void ConvertSlice(FrameSlot* pSlot, int Slice)
+{
+    // slices cover an even number of rows so that they don't share chroma rows
+    int Rows = ((g_Height + 2*g_NumSlices - 1) / (2*g_NumSlices)) * 2;
+    int yStart = Slice * Rows;
+    int yEnd = yStart + Rows < g_Height ? yStart + Rows : g_Height;
+    YUV_ConvertRows(pSlot->pRGB, g_Width, g_Height, pSlot->Frame.pPlanes, pSlot->Frame.Linesizes,
+                    yStart, yEnd, g_UseSSE2);
+}
+
+static int SDLCALL ConvertThread(void* p)
+{
+    (void)p;
+    SDL_LockMutex(g_pQueueMutex);
+    while (1)
+    {
+        FrameSlot* pSlot = NULL;
+        for (int i = 0; i < g_QueueCount && !pSlot; i++)
+        {
+            FrameSlot* pQueued = &g_Slots[(g_QueueHead + i) % PIPELINE_QUEUE_SIZE];
+            if (pQueued->NextSlice < g_NumSlices)
+                pSlot = pQueued;
+        }
+        if (!pSlot)
+        {
+            if (g_StopPipeline)
+                break;
+            SDL_CondWait(g_pSliceCond, g_pQueueMutex);
+            continue;
+        }
+
+        int Slice = pSlot->NextSlice++;
+        SDL_UnlockMutex(g_pQueueMutex);
+        ConvertSlice(pSlot, Slice);
+        SDL_LockMutex(g_pQueueMutex);
+
+        if (++pSlot->SlicesDone == g_NumSlices)
+            SDL_CondSignal(g_pEncodeCond);
+    }
+    SDL_UnlockMutex(g_pQueueMutex);
+    return 0;
+}
+
+static int SDLCALL EncodeThread(void* p)
+{
+    (void)p;
+    SDL_LockMutex(g_pQueueMutex);
+    while (1)
+    {
+        FrameSlot* pSlot = &g_Slots[g_QueueHead];
+        if (g_QueueCount == 0 && g_StopPipeline)
+            break;
+        if (g_QueueCount == 0 || pSlot->SlicesDone < g_NumSlices)
+        {
+            SDL_CondWait(g_pEncodeCond, g_pQueueMutex);
+            continue;
+        }
+
+        // after an error frames are only dropped, so that the engine never waits forever
+        int Failed = g_PipelineError;
+        SDL_UnlockMutex(g_pQueueMutex);
+        if (!Failed && g_pWrite(&pSlot->Frame) < 0)
+            Failed = 1;
+        SDL_LockMutex(g_pQueueMutex);
+
+        g_PipelineError = Failed;
+        pSlot->NextSlice = 0;
+        pSlot->SlicesDone = 0;
+        g_QueueHead = (g_QueueHead + 1) % PIPELINE_QUEUE_SIZE;
+        g_QueueCount--;
+        SDL_CondSignal(g_pFreeCond);
+    }
+    SDL_UnlockMutex(g_pQueueMutex);
+    return 0;
+}
+
+int Pipeline_Start(int Width, int Height, int UseSSE2, int NumThreads,
+                   const PipelineFrame pFrames[PIPELINE_QUEUE_SIZE], PipelineWriteFn Write)
+{
+    g_Width = Width;
+    g_Height = Height;
+    g_UseSSE2 = UseSSE2;
+    g_pWrite = Write;
+    for (int i = 0; i < PIPELINE_QUEUE_SIZE; i++)
+    {
+        g_Slots[i].pRGB = (uint8_t*)malloc(Width*Height*4);
+        if (!g_Slots[i].pRGB)
+            return -1;
+        g_Slots[i].Frame = pFrames[i];
+        g_Slots[i].NextSlice = 0;
+        g_Slots[i].SlicesDone = 0;
+    }
+    g_QueueHead = g_QueueCount = 0;
+    g_StopPipeline = g_PipelineError = 0;
+
+    g_pQueueMutex = SDL_CreateMutex();
+    g_pSliceCond = SDL_CreateCond();
+    g_pEncodeCond = SDL_CreateCond();
+    g_pFreeCond = SDL_CreateCond();
+    if (!g_pQueueMutex || !g_pSliceCond || !g_pEncodeCond || !g_pFreeCond)
+        return -1;
+
+    g_NumConvertThreads = NumThreads;
+    if (g_NumConvertThreads < 1)
+        g_NumConvertThreads = 1;
+    if (g_NumConvertThreads > PIPELINE_MAX_THREADS)
+        g_NumConvertThreads = PIPELINE_MAX_THREADS;
+    g_NumSlices = g_NumConvertThreads;
+
+    g_pEncodeThread = SDL_CreateThread(EncodeThread, "avwrapper encode", NULL);
+    if (!g_pEncodeThread)
+        return -1;
+    for (int i = 0; i < g_NumConvertThreads; i++)
+    {
+        g_pConvertThreads[i] = SDL_CreateThread(ConvertThread, "avwrapper convert", NULL);
+        if (!g_pConvertThreads[i])
+            return -1;
+    }
+    return 0;
+}
+
+int Pipeline_Queue(const uint8_t* pRGB)
+{
+    // wait for a free slot; the queue is bounded so a slow encoder throttles the engine
+    SDL_LockMutex(g_pQueueMutex);
+    while (g_QueueCount == PIPELINE_QUEUE_SIZE && !g_PipelineError)
+        SDL_CondWait(g_pFreeCond, g_pQueueMutex);
+    int Failed = g_PipelineError;
+    FrameSlot* pSlot = &g_Slots[(g_QueueHead + g_QueueCount) % PIPELINE_QUEUE_SIZE];
+    SDL_UnlockMutex(g_pQueueMutex);
+    if (Failed)
+        return -1;
+
+    // the engine reuses its buffer, so this copy is all the work left on its thread
+    memcpy(pSlot->pRGB, pRGB, g_Width*g_Height*4);
+
+    SDL_LockMutex(g_pQueueMutex);
+    g_QueueCount++;
+    SDL_CondBroadcast(g_pSliceCond);
+    SDL_UnlockMutex(g_pQueueMutex);
+    return 0;
+}
+
+int Pipeline_Stop(void)
+{
+    if (!g_pQueueMutex)
+        return 0;
+
+    SDL_LockMutex(g_pQueueMutex);
+    g_StopPipeline = 1;
+    SDL_CondBroadcast(g_pSliceCond);
+    SDL_CondBroadcast(g_pEncodeCond);
+    SDL_UnlockMutex(g_pQueueMutex);
+
+    for (int i = 0; i < g_NumConvertThreads; i++)
+    {
+        if (g_pConvertThreads[i])
+            SDL_WaitThread(g_pConvertThreads[i], NULL);
+        g_pConvertThreads[i] = NULL;
+    }
+    g_NumConvertThreads = 0;
+    if (g_pEncodeThread)
+        SDL_WaitThread(g_pEncodeThread, NULL);
+    g_pEncodeThread = NULL;
+
+    return g_PipelineError ? -1 : 0;
+}
+
+void Pipeline_Free(void)
+{
+    for (int i = 0; i < PIPELINE_QUEUE_SIZE; i++)
+    {
+        free(g_Slots[i].pRGB);
+        g_Slots[i].pRGB = NULL;
+    }
+    SDL_DestroyCond(g_pSliceCond);
+    SDL_DestroyCond(g_pEncodeCond);
+    SDL_DestroyCond(g_pFreeCond);
+    SDL_DestroyMutex(g_pQueueMutex);
+    g_pSliceCond = g_pEncodeCond = g_pFreeCond = NULL;
+    g_pQueueMutex = NULL;
+}
@@ -0,0 +1,63 @@
+/*
+ * Hedgewars, a free turn based strategy game
+ * Copyright (c) 2004-2015 Andrey Korotaev <unC0Rr@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/*
+ * Frame pipeline of the video recorder: the engine thread only copies its
+ * picture into a free slot, conversion threads turn the slots into YUV frames
+ * slice by slice, and the encoder thread hands them to a write function in
+ * order. It doesn't depend on libav, the frames belong to the caller.
+ */
+
+#ifndef AVWRAPPER_PIPELINE_H
+#define AVWRAPPER_PIPELINE_H
+
+#include <stdint.h>
+
+#define PIPELINE_QUEUE_SIZE 4
+#define PIPELINE_MAX_THREADS 4
+
+typedef struct
+{
+    uint8_t* pPlanes[3];
+    int Linesizes[3];
+    void* pUser;  // the caller's frame, e.g. an AVFrame
+} PipelineFrame;
+
+// Called on the encoder thread for each converted frame, in the order they
+// were queued. It may point pFrame at new planes for the next picture.
+// After it returned a negative value the remaining frames are dropped.
+typedef int (*PipelineWriteFn)(PipelineFrame* pFrame);
+
+// Starts NumThreads conversion threads and the encoder thread for Width x
+// Height pictures, converted into the PIPELINE_QUEUE_SIZE frames in pFrames.
+// Returns -1 on error, Pipeline_Free cleans up after that too.
+int Pipeline_Start(int Width, int Height, int UseSSE2, int NumThreads,
+                   const PipelineFrame pFrames[PIPELINE_QUEUE_SIZE], PipelineWriteFn Write);
+
+// Queues a copy of the bottom-up RGBA picture pRGB, waiting for a free slot
+// if necessary. Returns -1 once writing a frame failed.
+int Pipeline_Queue(const uint8_t* pRGB);
+
+// Waits until all queued frames are written or dropped and stops the
+// threads. Returns -1 if any frame failed.
+int Pipeline_Stop(void);
+
+// Frees the slots, the frames in them are left to the caller.
+void Pipeline_Free(void);
+
+#endif // AVWRAPPER_PIPELINE_H
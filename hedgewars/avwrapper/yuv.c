@@ -0,0 +1,209 @@
+/*
+ * Hedgewars, a free turn based strategy game
+ * Copyright (c) 2004-2015 Andrey Korotaev <unC0Rr@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <string.h>
+
+#include "yuv.h"
+
+// x86-64 always has SSE2. 32-bit x86 builds usually don't assume it, so there
+// the SSE2 code is compiled for it anyway and only used if the CPU has it.
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define YUV_SSE2
+#define YUV_SSE2_TARGET
+#elif defined(__i386__) && defined(__GNUC__)
+#define YUV_SSE2
+#define YUV_SSE2_RUNTIME
+#define YUV_SSE2_TARGET __attribute__((target("sse2")))
+#elif defined(_M_IX86)
+#define YUV_SSE2
+#define YUV_SSE2_RUNTIME
+#define YUV_SSE2_TARGET
+#include <intrin.h>
+#endif
+
+#ifdef YUV_SSE2
+#include <emmintrin.h>
+#endif
+
+static inline uint8_t ClipUint8(int a)
+{
+    return a < 0 ? 0 : a > 255 ? 255 : a;
+}
+
+// BT.601 coefficients for the RGB to YUV conversion in 1.15 fixed point
+#define YUV_SHIFT 15
+#define Y_R   9798  //  0.299
+#define Y_G  19235  //  0.587
+#define Y_B   3736  //  0.114
+#define U_R  -4821  // -0.14713
+#define U_G  -9465  // -0.28886
+#define U_B  14287  //  0.436
+#define V_R  20152  //  0.615
+#define V_G -16875  // -0.51499
+#define V_B  -3277  // -0.10001
+#define UV_BIAS (128 << YUV_SHIFT)
+
+// Converts pixels [x, Width) of two RGBA rows to luma, and their 2x2 blocks to chroma.
+// pBottom may be the same row as pTop, pYBottom may be NULL.
+static void ConvertRowPairScalar(
+        const uint8_t* pTop, const uint8_t* pBottom,
+        uint8_t* pYTop, uint8_t* pYBottom, uint8_t* pU, uint8_t* pV,
+        int x, int Width)
+{
+    for (; x < Width; x += 2)
+    {
+        const uint8_t* t0 = pTop + x * 4;
+        const uint8_t* b0 = pBottom + x * 4;
+        // repeat the last column for odd widths
+        int next = x + 1 < Width ? 4 : 0;
+        const uint8_t* t1 = t0 + next;
+        const uint8_t* b1 = b0 + next;
+
+        pYTop[x] = (Y_R * t0[0] + Y_G * t0[1] + Y_B * t0[2]) >> YUV_SHIFT;
+        if (next)
+            pYTop[x + 1] = (Y_R * t1[0] + Y_G * t1[1] + Y_B * t1[2]) >> YUV_SHIFT;
+        if (pYBottom)
+        {
+            pYBottom[x] = (Y_R * b0[0] + Y_G * b0[1] + Y_B * b0[2]) >> YUV_SHIFT;
+            if (next)
+                pYBottom[x + 1] = (Y_R * b1[0] + Y_G * b1[1] + Y_B * b1[2]) >> YUV_SHIFT;
+        }
+
+        int r = (t0[0] + t1[0] + b0[0] + b1[0]) >> 2;
+        int g = (t0[1] + t1[1] + b0[1] + b1[1]) >> 2;
+        int b = (t0[2] + t1[2] + b0[2] + b1[2]) >> 2;
+        pU[x / 2] = ClipUint8((U_R * r + U_G * g + U_B * b + UV_BIAS) >> YUV_SHIFT);
+        pV[x / 2] = ClipUint8((V_R * r + V_G * g + V_B * b + UV_BIAS) >> YUV_SHIFT);
+    }
+}
+
+#ifdef YUV_SSE2
+// Dot products of the 16-bit RGBA pixels in Lo (pixels 0, 1) and Hi (pixels 2, 3)
+// with Coef, as four 32-bit values.
+YUV_SSE2_TARGET static inline __m128i DotRGB4(__m128i Lo, __m128i Hi, __m128i Coef)
+{
+    __m128 a = _mm_castsi128_ps(_mm_madd_epi16(Lo, Coef));
+    __m128 b = _mm_castsi128_ps(_mm_madd_epi16(Hi, Coef));
+    __m128i even = _mm_castps_si128(_mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)));
+    __m128i odd  = _mm_castps_si128(_mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)));
+    return _mm_add_epi32(even, odd);
+}
+
+YUV_SSE2_TARGET static inline void StoreLuma8(uint8_t* pDst, __m128i Lo0, __m128i Hi0, __m128i Lo1, __m128i Hi1, __m128i Coef)
+{
+    __m128i y0 = _mm_srai_epi32(DotRGB4(Lo0, Hi0, Coef), YUV_SHIFT);
+    __m128i y1 = _mm_srai_epi32(DotRGB4(Lo1, Hi1, Coef), YUV_SHIFT);
+    __m128i y = _mm_packs_epi32(y0, y1);
+    _mm_storel_epi64((__m128i*)pDst, _mm_packus_epi16(y, y));
+}
+
+YUV_SSE2_TARGET static inline void StoreChroma4(uint8_t* pDst, __m128i Blocks01, __m128i Blocks23, __m128i Coef)
+{
+    __m128i c = DotRGB4(Blocks01, Blocks23, Coef);
+    c = _mm_srai_epi32(_mm_add_epi32(c, _mm_set1_epi32(UV_BIAS)), YUV_SHIFT);
+    c = _mm_packs_epi32(c, c);
+    int packed = _mm_cvtsi128_si32(_mm_packus_epi16(c, c));
+    memcpy(pDst, &packed, 4);
+}
+
+// Same as ConvertRowPairScalar, for as many groups of 8 pixels as fit in the row.
+// Returns the number of pixels converted.
+YUV_SSE2_TARGET static int ConvertRowPairSSE2(
+        const uint8_t* pTop, const uint8_t* pBottom,
+        uint8_t* pYTop, uint8_t* pYBottom, uint8_t* pU, uint8_t* pV,
+        int Width)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i yCoef = _mm_setr_epi16(Y_R, Y_G, Y_B, 0, Y_R, Y_G, Y_B, 0);
+    const __m128i uCoef = _mm_setr_epi16(U_R, U_G, U_B, 0, U_R, U_G, U_B, 0);
+    const __m128i vCoef = _mm_setr_epi16(V_R, V_G, V_B, 0, V_R, V_G, V_B, 0);
+    int x;
+    for (x = 0; x + 8 <= Width; x += 8)
+    {
+        __m128i t0 = _mm_loadu_si128((const __m128i*)(pTop + x * 4));
+        __m128i t1 = _mm_loadu_si128((const __m128i*)(pTop + x * 4 + 16));
+        __m128i b0 = _mm_loadu_si128((const __m128i*)(pBottom + x * 4));
+        __m128i b1 = _mm_loadu_si128((const __m128i*)(pBottom + x * 4 + 16));
+
+        // widen to 16 bits, two pixels per register
+        __m128i tLo0 = _mm_unpacklo_epi8(t0, zero), tHi0 = _mm_unpackhi_epi8(t0, zero);
+        __m128i tLo1 = _mm_unpacklo_epi8(t1, zero), tHi1 = _mm_unpackhi_epi8(t1, zero);
+        __m128i bLo0 = _mm_unpacklo_epi8(b0, zero), bHi0 = _mm_unpackhi_epi8(b0, zero);
+        __m128i bLo1 = _mm_unpacklo_epi8(b1, zero), bHi1 = _mm_unpackhi_epi8(b1, zero);
+
+        StoreLuma8(pYTop + x, tLo0, tHi0, tLo1, tHi1, yCoef);
+        if (pYBottom)
+            StoreLuma8(pYBottom + x, bLo0, bHi0, bLo1, bHi1, yCoef);
+
+        // sum the 2x2 blocks: vertically, then the two pixels of each register
+        __m128i s0 = _mm_add_epi16(tLo0, bLo0), s1 = _mm_add_epi16(tHi0, bHi0);
+        __m128i s2 = _mm_add_epi16(tLo1, bLo1), s3 = _mm_add_epi16(tHi1, bHi1);
+        s0 = _mm_add_epi16(s0, _mm_srli_si128(s0, 8));
+        s1 = _mm_add_epi16(s1, _mm_srli_si128(s1, 8));
+        s2 = _mm_add_epi16(s2, _mm_srli_si128(s2, 8));
+        s3 = _mm_add_epi16(s3, _mm_srli_si128(s3, 8));
+        __m128i blocks01 = _mm_srli_epi16(_mm_unpacklo_epi64(s0, s1), 2);
+        __m128i blocks23 = _mm_srli_epi16(_mm_unpacklo_epi64(s2, s3), 2);
+
+        StoreChroma4(pU + x / 2, blocks01, blocks23, uCoef);
+        StoreChroma4(pV + x / 2, blocks01, blocks23, vCoef);
+    }
+    return x;
+}
+#endif
+
+int YUV_HaveSSE2(void)
+{
+#if !defined(YUV_SSE2)
+    return 0;
+#elif !defined(YUV_SSE2_RUNTIME)
+    return 1;
+#elif defined(__GNUC__)
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("sse2");
+#else
+    int info[4];
+    __cpuid(info, 1);
+    return (info[3] >> 26) & 1;  // EDX bit 26
+#endif
+}
+
+void YUV_ConvertRows(const uint8_t* pBuf, int Width, int Height,
+                     uint8_t* const pPlanes[3], const int Linesizes[3],
+                     int yStart, int yEnd, int UseSSE2)
+{
+    int stride = Width * 4;
+    for (int y = yStart; y < yEnd; y += 2)
+    {
+        const uint8_t* pTop = pBuf + (Height - 1 - y) * stride;
+        // for odd heights the last chroma row only covers one row of pixels
+        int hasBottom = y + 1 < Height;
+        const uint8_t* pBottom = hasBottom ? pTop - stride : pTop;
+        uint8_t* pYTop = pPlanes[0] + y * Linesizes[0];
+        uint8_t* pYBottom = hasBottom ? pYTop + Linesizes[0] : NULL;
+        uint8_t* pU = pPlanes[1] + (y / 2) * Linesizes[1];
+        uint8_t* pV = pPlanes[2] + (y / 2) * Linesizes[2];
+
+        int x = 0;
+#ifdef YUV_SSE2
+        if (UseSSE2)
+            x = ConvertRowPairSSE2(pTop, pBottom, pYTop, pYBottom, pU, pV, Width);
+#endif
+        ConvertRowPairScalar(pTop, pBottom, pYTop, pYBottom, pU, pV, x, Width);
+    }
+}
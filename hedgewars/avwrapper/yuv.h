@@ -0,0 +1,40 @@
+/*
+ * Hedgewars, a free turn based strategy game
+ * Copyright (c) 2004-2015 Andrey Korotaev <unC0Rr@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/*
+ * RGBA to YUV 4:2:0 conversion of recorded frames. It doesn't depend on libav,
+ * so the SSE2 and scalar code can be tested against each other on their own.
+ */
+
+#ifndef AVWRAPPER_YUV_H
+#define AVWRAPPER_YUV_H
+
+#include <stdint.h>
+
+// Whether YUV_ConvertRows can use SSE2 on this CPU. On x86-64 SSE2 is always
+// there, on 32-bit x86 this asks the CPU, on other architectures it is 0.
+int YUV_HaveSSE2(void);
+
+// Converts the bottom-up Width x Height RGBA image in pBuf to the Y, U and V
+// planes in pPlanes, for output rows [yStart, yEnd). yStart must be even.
+// UseSSE2 is ignored unless YUV_HaveSSE2() returned nonzero.
+void YUV_ConvertRows(const uint8_t* pBuf, int Width, int Height,
+                     uint8_t* const pPlanes[3], const int Linesizes[3],
+                     int yStart, int yEnd, int UseSSE2);
+
+#endif // AVWRAPPER_YUV_H
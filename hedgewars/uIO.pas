@@ -39,7 +39,8 @@ procedure NetGetNextCmd;
 procedure doPut(putX, putY: LongInt; fromAI: boolean);
 
 implementation
-uses uConsole, uConsts, uVariables, uCommands, uUtils, uDebug, uLocale, uSound;
+uses uConsole, uConsts, uVariables, uCommands, uUtils, uDebug, uLocale, uSound
+    {$IFDEF USE_UNIX_IPC}, BaseUnix, Sockets{$ENDIF};
 
 const
     cSendEmptyPacketTime = 1000;
@@ -57,6 +58,9 @@ type PCmd = ^TCmd;
 
 var IPCSock: PTCPSocket;
     fds: PSDLNet_SocketSet;
+{$IFDEF USE_UNIX_IPC}
+    ipcFd: cint; // unix domain socket, used instead of IPCSock if >= 0
+{$ENDIF}
     isPonged: boolean;
     SocketString: shortstring;
 
@@ -116,6 +120,79 @@ if headcmd = nil then
 dispose(tmp)
 end;
 
+function isIPCConnected: boolean;
+begin
+{$IFDEF USE_UNIX_IPC}
+    if ipcFd >= 0 then
+        exit(true);
+{$ENDIF}
+    isIPCConnected:= IPCSock <> nil
+end;
+
+{$IFDEF USE_UNIX_IPC}
+procedure InitUnixIPC;
+var addr: sockaddr_un;
+    len: LongInt;
+begin
+    WriteToConsole('Establishing IPC connection to unix socket ' + ipcSocketPath + ' ');
+    ipcFd:= fpSocket(AF_UNIX, SOCK_STREAM, 0);
+    if checkFails(ipcFd >= 0, 'fpSocket', true) then
+        exit;
+
+    len:= Length(ipcSocketPath);
+    if len > High(addr.sun_path) then
+        len:= High(addr.sun_path);
+    FillChar(addr, SizeOf(addr), 0);
+    addr.sun_family:= AF_UNIX;
+    Move(ipcSocketPath[1], addr.sun_path[0], len);
+
+    if checkFails(fpConnect(ipcFd, psockaddr(@addr), SizeOf(addr)) = 0, 'fpConnect', true) then
+        begin
+        fpClose(ipcFd);
+        ipcFd:= -1;
+        exit
+        end;
+    WriteLnToConsole(msgOK)
+end;
+
+// whether there is something to read, without blocking
+function ipcUnixCanRead: boolean;
+var readSet: TFDSet;
+    timeout: TTimeVal;
+begin
+    fpFD_ZERO(readSet);
+    fpFD_SET(ipcFd, readSet);
+    timeout.tv_sec:= 0;
+    timeout.tv_usec:= 0;
+    ipcUnixCanRead:= fpSelect(ipcFd + 1, @readSet, nil, nil, @timeout) > 0
+end;
+{$ENDIF}
+
+procedure ipcSend(p: pointer; len: LongInt);
+{$IFDEF USE_UNIX_IPC}
+var sent: LongInt;
+{$ENDIF}
+begin
+{$IFDEF USE_UNIX_IPC}
+    if ipcFd >= 0 then
+        begin
+        while len > 0 do
+            begin
+            sent:= fpSend(ipcFd, p, len, 0);
+            if sent <= 0 then
+                if fpgeterrno = ESysEINTR then
+                    continue
+                else
+                    break;
+            inc(p, sent);
+            dec(len, sent)
+            end;
+        exit
+        end;
+{$ENDIF}
+    SDLNet_TCP_Send(IPCSock, p, len)
+end;
+
 procedure InitIPC;
 var ipaddr: TIPAddress;
 begin
@@ -124,6 +201,13 @@ begin
     fds:= SDLNet_AllocSocketSet(1);
     SDLCheck(fds <> nil, 'SDLNet_AllocSocketSet', true);
     WriteLnToConsole(msgOK);
+{$IFDEF USE_UNIX_IPC}
+    if ipcSocketPath <> '' then
+        begin
+        InitUnixIPC;
+        exit
+        end;
+{$ENDIF}
     WriteToConsole('Establishing IPC connection to tcp 127.0.0.1:' + IntToStr(ipcPort) + ' ');
     {$HINTS OFF}
     SDLCheck(SDLNet_ResolveHost(ipaddr, PChar('127.0.0.1'), ipcPort) = 0, 'SDLNet_ResolveHost', true);
@@ -219,19 +303,41 @@ case s[1] of
     end
 end;
 
+function ipcRecv(p: pointer; len: LongInt): LongInt;
+begin
+{$IFDEF USE_UNIX_IPC}
+    if ipcFd >= 0 then
+        begin
+        repeat
+            ipcRecv:= fpRecv(ipcFd, p, len, 0)
+        until (ipcRecv >= 0) or (fpgeterrno <> ESysEINTR);
+        exit
+        end;
+{$ENDIF}
+    ipcRecv:= SDLNet_TCP_Recv(IPCSock, p, len)
+end;
+
+function ipcCanRead: boolean;
+begin
+{$IFDEF USE_UNIX_IPC}
+    if ipcFd >= 0 then
+        exit(ipcUnixCanRead);
+{$ENDIF}
+    fds^.numsockets:= 0;
+    SDLNet_AddSocket(fds, IPCSock);
+    ipcCanRead:= SDLNet_CheckSockets(fds, 0) > 0
+end;
+
 procedure IPCCheckSock;
 var i: LongInt;
     s: shortstring;
 begin
-    if IPCSock = nil then
+    if not isIPCConnected then
         exit;
 
-    fds^.numsockets:= 0;
-    SDLNet_AddSocket(fds, IPCSock);
-
-    while SDLNet_CheckSockets(fds, 0) > 0 do
+    while ipcCanRead do
     begin
-        i:= SDLNet_TCP_Recv(IPCSock, @s[1], 255 - Length(SocketString));
+        i:= ipcRecv(@s[1], 255 - Length(SocketString));
         if i > 0 then
         begin
             s[0]:= char(i);
@@ -305,9 +411,9 @@ end;
 
 procedure flushBuffer();
 begin
-    if IPCSock <> nil then
+    if isIPCConnected then
         begin
-        SDLNet_TCP_Send(IPCSock, @sendBuffer.buf, sendBuffer.count);
+        ipcSend(@sendBuffer.buf, sendBuffer.count);
         flushDelayTicks:= 0;
         sendBuffer.count:= 0
         end
@@ -315,7 +421,7 @@ end;
 
 procedure SendIPC(s: shortstring);
 begin
-if IPCSock <> nil then
+if isIPCConnected then
     begin
     if s[0] > #251 then
         s[0]:= #251;
@@ -336,15 +442,15 @@ if IPCSock <> nil then
         if (s[1] = 'N') or (s[1] = '#') then
             flushBuffer();
         end else
-        SDLNet_TCP_Send(IPCSock, @s, Succ(byte(s[0])))
+        ipcSend(@s, Succ(byte(s[0])))
     end
 end;
 
 procedure SendIPCRaw(p: pointer; len: Longword);
 begin
-if IPCSock <> nil then
+if isIPCConnected then
     begin
-    SDLNet_TCP_Send(IPCSock, p, len)
+    ipcSend(p, len)
     end
 end;
 
@@ -492,7 +598,7 @@ begin
     // TODO: should we try to clean more stuff here?
     SDL_Quit;
 
-    if IPCSock <> nil then
+    if isIPCConnected then
         halt(HaltFatalError)
     else
         halt(HaltFatalErrorNoIPC);
@@ -558,6 +664,9 @@ begin
 
     IPCSock:= nil;
     fds:= nil;
+{$IFDEF USE_UNIX_IPC}
+    ipcFd:= -1;
+{$ENDIF}
 
     headcmd:= nil;
     lastcmd:= nil;
@@ -572,6 +681,10 @@ end;
 procedure freeModule;
 begin
     while headcmd <> nil do RemoveCmd;
+{$IFDEF USE_UNIX_IPC}
+    if ipcFd >= 0 then
+        fpClose(ipcFd);
+{$ENDIF}
     SDLNet_FreeSocketSet(fds);
     SDLNet_TCP_Close(IPCSock);
     SDLNet_Quit();
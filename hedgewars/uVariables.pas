@@ -40,6 +40,7 @@ var
     cNewScreenHeight   : LongInt;
     cScreenResizeDelay : LongWord;
     ipcPort            : Word;
+    ipcSocketPath      : shortstring;
     AprilOne           : boolean;
     cFullScreen        : boolean;
     cLanguageFName     : shortstring;
@@ -2735,6 +2736,7 @@ begin
 
     UserPathPrefix  := '';
     ipcPort         := 0;
+    ipcSocketPath   := '';
     recordFileName  := '';
     UserNick        := '';
     cStereoMode     := smNone;
@@ -534,11 +534,12 @@ public interface Frontlib extends Library {
 
         @Override
         protected List<String> getFieldOrder() {
-            return Arrays.asList("weaponsetCount", "weaponsets");
+            return Arrays.asList("weaponsetCount", "weaponsets", "weaponsetCapacity");
         }
 
         public void fillFrom(List<Weaponset> list) {
             weaponsetCount = list.size();
+            weaponsetCapacity = weaponsetCount;
             if(weaponsetCount<=0) {
                 weaponsets = null;
             } else {
@@ -575,6 +576,7 @@ public interface Frontlib extends Library {
 
         public int weaponsetCount;
         public WeaponsetPointerByReference weaponsets;
+        public int weaponsetCapacity;
     }
 
     static class RoomStruct extends Structure {
@@ -815,11 +817,12 @@ public interface Frontlib extends Library {
 
         @Override
         protected List<String> getFieldOrder() {
-            return Arrays.asList("schemeCount", "schemes");
+            return Arrays.asList("schemeCount", "schemes", "schemeCapacity", "nameIndex");
         }
 
         public void fillFrom(List<Scheme> schemeList) {
             schemeCount = schemeList.size();
+            schemeCapacity = schemeCount;
             if(schemeCount<=0) {
                 schemes = null;
             } else {
@@ -857,6 +860,8 @@ public interface Frontlib extends Library {
 
         public int schemeCount;
         public SchemePointerByReference schemes;
+        public int schemeCapacity;
+        public Pointer nameIndex;   // null, these lists are searched linearly
     }
 
     /**
@@ -883,11 +888,12 @@ public interface Frontlib extends Library {
 
         @Override
         protected List<String> getFieldOrder() {
-            return Arrays.asList("teamCount", "teams");
+            return Arrays.asList("teamCount", "teams", "teamCapacity", "nameIndex");
         }
 
         public void fillFrom(List<TeamInGame> teamList, WeaponsetStruct.ByRef weaponset, int initialHealth) {
             teamCount = teamList.size();
+            teamCapacity = teamCount;
             if(teamCount <= 0) {
                 teams = null;
             } else {
@@ -919,6 +925,8 @@ public interface Frontlib extends Library {
 
         public int teamCount;
         public TeamPointerByReference teams;
+        public int teamCapacity;
+        public Pointer nameIndex;   // null, these lists are searched linearly
     }
 
     static class GameSetupStruct extends Structure {
@@ -0,0 +1,98 @@
+/*
+ * Hedgewars, a free turn based strategy game
+ * Copyright (C) 2012 Simeon Maxein <smaxein@googlemail.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "eventloop.h"
+#include "frontlib.h"
+#include "socket.h"
+#include "util/list.h"
+#include "util/logging.h"
+
+typedef struct {
+    void *object;               //!< NULL if the object was unregistered while flib_run_until was ticking
+    flib_eventloop_tickfn tick;
+} eventloopEntry;
+
+static eventloopEntry *entries;
+static int entryCount;
+static int entryCapacity;
+static bool ticking;
+static bool hasRemovedEntries;
+
+GENERATE_STATIC_LIST_INSERT(insertEntry, eventloopEntry)
+GENERATE_STATIC_LIST_DELETE(deleteEntry, eventloopEntry)
+
+int flib_eventloop_register(void *object, flib_eventloop_tickfn tick) {
+    if(log_badargs_if2(object==NULL, tick==NULL)) {
+        return -1;
+    }
+    eventloopEntry entry = {.object = object, .tick = tick};
+    return insertEntry(&entries, &entryCount, &entryCapacity, entry, entryCount);
+}
+
+void flib_eventloop_unregister(void *object) {
+    for(int i=0; object && i<entryCount; i++) {
+        if(entries[i].object == object) {
+            if(ticking) {
+                // Don't move entries around under the loop in flib_run_until
+                entries[i].object = NULL;
+                hasRemovedEntries = true;
+            } else {
+                deleteEntry(&entries, &entryCount, &entryCapacity, i);
+            }
+            return;
+        }
+    }
+}
+
+static void removeUnregisteredEntries() {
+    for(int i=entryCount-1; i>=0; i--) {
+        if(!entries[i].object) {
+            deleteEntry(&entries, &entryCount, &entryCapacity, i);
+        }
+    }
+    hasRemovedEntries = false;
+}
+
+int flib_run_until(uint32_t timeout) {
+    if(log_w_if(ticking, "Call to flib_run_until from a callback")) {
+        return -1;
+    }
+    if(entryCount==0) {
+        return 0;
+    }
+    if(flib_socket_wait(timeout) < 0) {
+        return -1;
+    }
+
+    int active = 0;
+    ticking = true;
+    // Objects registered by a callback during this loop are only ticked on the next call.
+    int count = entryCount;
+    for(int i=0; i<count; i++) {
+        if(entries[i].object && entries[i].tick(entries[i].object)) {
+            active++;
+        }
+    }
+    ticking = false;
+
+    if(hasRemovedEntries) {
+        removeUnregisteredEntries();
+    }
+    return active;
+}
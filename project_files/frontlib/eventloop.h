@@ -0,0 +1,52 @@
+/*
+ * Hedgewars, a free turn based strategy game
+ * Copyright (C) 2012 Simeon Maxein <smaxein@googlemail.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+/**
+ * Drives all open connections from a single blocking wait.
+ *
+ * Connection objects (netconn, gameconn, mapconn) register themselves here when they are
+ * created and unregister when they are destroyed. flib_run_until (see frontlib.h) then
+ * waits for activity on any of their sockets and ticks every registered connection, so an
+ * embedder with many connections does not need to poll each of them.
+ */
+
+#ifndef EVENTLOOP_H_
+#define EVENTLOOP_H_
+
+#include <stdbool.h>
+
+/**
+ * Called by flib_run_until for each registered object. Ticks the object unless it is
+ * finished, and returns false if it was already finished. The object may be destroyed
+ * by the tick.
+ */
+typedef bool (*flib_eventloop_tickfn)(void *object);
+
+/**
+ * Add an object to the set of objects ticked by flib_run_until. Returns 0 on success.
+ */
+int flib_eventloop_register(void *object, flib_eventloop_tickfn tick);
+
+/**
+ * Remove an object from the set of objects ticked by flib_run_until. This is safe to call
+ * while flib_run_until is running, e.g. when a connection is destroyed from a callback.
+ */
+void flib_eventloop_unregister(void *object);
+
+#endif /* EVENTLOOP_H_ */
@@ -0,0 +1,205 @@
+/*
+ * Hedgewars, a free turn based strategy game
+ * Copyright (C) 2012 Simeon Maxein <smaxein@googlemail.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+/*
+ * This file is not part of the frontlib. It builds a command line tool that renders the
+ * previews of a number of generated maps with a flib_mapbatch and reports how many previews per
+ * second the engines managed, e.g.
+ *
+ *   mapbatchbench --engine bin/hwengine --prefix share/hedgewars/Data --maps 200 --workers 4
+ *
+ * Build it with -DFRONTLIB_MAPBATCH_BENCH=ON.
+ */
+
+#ifndef _WIN32
+#define _POSIX_C_SOURCE 200112L
+#endif
+
+#include "../frontlib.h"
+#include "../util/logging.h"
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <process.h>
+#else
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
+typedef struct {
+    const char *engine;
+    const char *prefix;
+    const char *userPrefix;
+    int mapCount;
+    int workerCount;
+    int timeout;            //!< Seconds an engine has to connect before its map fails
+} benchsettings;
+
+typedef struct {
+    const benchsettings *settings;
+    int previews;
+    int failures;
+    int engineStarts;
+} benchstate;
+
+static double seconds() {
+#ifdef _WIN32
+    return GetTickCount64()/1000.0;
+#else
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec/1e9;
+#endif
+}
+
+static void handleStartEngine(void *context, int port) {
+    benchstate *state = context;
+    const benchsettings *settings = state->settings;
+    char portString[16];
+    snprintf(portString, sizeof(portString), "%i", port);
+    const char *argv[] = {settings->engine, "--internal", "--port", portString,
+            "--user-prefix", settings->userPrefix, "--prefix", settings->prefix, "--landpreview", NULL};
+
+#ifdef _WIN32
+    if(_spawnv(_P_NOWAIT, settings->engine, argv) == -1) {
+        flib_log_e("Unable to start %s", settings->engine);
+        return;
+    }
+#else
+    pid_t pid = fork();
+    if(pid == 0) {
+        execv(settings->engine, (char * const *)argv);
+        _exit(127);
+    } else if(pid < 0) {
+        flib_log_e("Unable to start %s", settings->engine);
+        return;
+    }
+#endif
+    state->engineStarts++;
+}
+
+static void handlePreview(void *context, int index, const uint8_t *bitmap, int numHedgehogs) {
+    benchstate *state = context;
+    state->previews++;
+}
+
+static void handleFailure(void *context, int index, const char *errormessage) {
+    benchstate *state = context;
+    flib_log_w("Map %i failed: %s", index, errormessage);
+    state->failures++;
+}
+
+static void usage(const char *name) {
+    fprintf(stderr, "Usage: %s --engine <hwengine> --prefix <Data directory> [--user-prefix <directory>]\n"
+            "       [--maps <count>] [--workers <count>] [--timeout <seconds>]\n", name);
+}
+
+static bool parseArgs(int argc, char *argv[], benchsettings *settings) {
+    for(int i=1; i<argc; i++) {
+        const char *value = i+1<argc ? argv[i+1] : NULL;
+        if(!value) {
+            return false;
+        } else if(!strcmp(argv[i], "--engine")) {
+            settings->engine = value;
+        } else if(!strcmp(argv[i], "--prefix")) {
+            settings->prefix = value;
+        } else if(!strcmp(argv[i], "--user-prefix")) {
+            settings->userPrefix = value;
+        } else if(!strcmp(argv[i], "--maps")) {
+            settings->mapCount = atoi(value);
+        } else if(!strcmp(argv[i], "--workers")) {
+            settings->workerCount = atoi(value);
+        } else if(!strcmp(argv[i], "--timeout")) {
+            settings->timeout = atoi(value);
+        } else {
+            return false;
+        }
+        i++;
+    }
+    return settings->engine && settings->prefix
+            && settings->mapCount>0 && settings->workerCount>0 && settings->timeout>0;
+}
+
+int main(int argc, char *argv[]) {
+    benchsettings settings = {NULL, NULL, ".", 100, 4, 30};
+    if(!parseArgs(argc, argv, &settings)) {
+        usage(argv[0]);
+        return 2;
+    }
+
+#ifndef _WIN32
+    // Nobody waits for the engines, so let them be reaped automatically
+    signal(SIGCHLD, SIG_IGN);
+#endif
+
+    flib_log_setLevel(FLIB_LOGLEVEL_WARNING);
+    if(flib_init()) {
+        return 1;
+    }
+
+    // Alternate between the generators so that the result doesn't depend on a single one
+    flib_map **maps = calloc(settings.mapCount, sizeof(flib_map*));
+    bool error = !maps;
+    for(int i=0; !error && i<settings.mapCount; i++) {
+        char seed[32];
+        snprintf(seed, sizeof(seed), "mapbatchbench%i", i);
+        if(i%2) {
+            maps[i] = flib_map_create_maze(seed, "Nature", i/2 % 6);
+        } else {
+            maps[i] = flib_map_create_regular(seed, "Nature", TEMPLATEFILTER_ALL);
+        }
+        error |= !maps[i];
+    }
+
+    benchstate state = {&settings, 0, 0, 0};
+    flib_mapbatch *batch = error ? NULL : flib_mapbatch_create((const flib_map**)maps, settings.mapCount, settings.workerCount);
+    if(batch) {
+        flib_mapbatch_onStartEngine(batch, handleStartEngine, &state);
+        flib_mapbatch_onPreview(batch, handlePreview, &state);
+        flib_mapbatch_onFailure(batch, handleFailure, &state);
+        flib_mapbatch_setConnectTimeout(batch, settings.timeout);
+
+        double start = seconds();
+        while(!flib_mapbatch_finished(batch) && flib_run_until(1000) >= 0) {}
+        double elapsed = seconds()-start;
+
+        int workers = settings.workerCount<settings.mapCount ? settings.workerCount : settings.mapCount;
+        printf("%i of %i previews rendered, %i failed, %i engines started\n",
+                state.previews, settings.mapCount, state.failures, state.engineStarts);
+        printf("%.2f s with %i engines at a time: %.1f previews/s\n",
+                elapsed, workers, elapsed>0 ? state.previews/elapsed : 0.0);
+        error = state.previews < settings.mapCount;
+    } else {
+        error = true;
+    }
+
+    flib_mapbatch_destroy(batch);
+    for(int i=0; maps && i<settings.mapCount; i++) {
+        flib_map_destroy(maps[i]);
+    }
+    free(maps);
+    flib_quit();
+    return error ? 1 : 0;
+}
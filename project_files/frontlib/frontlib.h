@@ -28,6 +28,7 @@
 
 #include "ipc/gameconn.h"
 #include "ipc/mapconn.h"
+#include "ipc/mapbatch.h"
 #include "net/netconn.h"
 #include "util/logging.h"
 #include "model/schemelist.h"
@@ -45,4 +46,16 @@ int flib_init();
  */
 void flib_quit();
 
+/**
+ * Run all open netconns, gameconns, mapconns and mapbatches from a single blocking wait:
+ * this waits until any of their connections has activity or timeout milliseconds have
+ * passed, and then ticks each of them. Use this instead of calling the individual tick functions,
+ * e.g. in a loop like while(flib_run_until(1000)>0) {}
+ *
+ * Connections that are finished are not ticked anymore, but should still be destroyed
+ * as usual. Returns the number of connections that were not finished yet, or a negative
+ * value on error. Must not be called from a callback.
+ */
+int flib_run_until(uint32_t timeout);
+
 #endif /* FRONTLIB_H_ */
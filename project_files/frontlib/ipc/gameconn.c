@@ -23,6 +23,7 @@
 #include "../util/logging.h"
 #include "../util/util.h"
 #include "../hwconsts.h"
+#include "../eventloop.h"
 #include <stdbool.h>
 #include <stdlib.h>
 #include <string.h>
@@ -78,6 +79,15 @@ static void clearCallbacks(flib_gameconn *conn) {
     flib_gameconn_onEngineMessage(conn, NULL, NULL);
 }
 
+static bool eventloopTick(void *object) {
+    flib_gameconn *conn = object;
+    if(conn->state == FINISHED) {
+        return false;
+    }
+    flib_gameconn_tick(conn);
+    return true;
+}
+
 static flib_gameconn *flib_gameconn_create_partial(bool record, const char *playerName, bool netGame) {
     flib_gameconn *result = NULL;
     flib_gameconn *tempConn = flib_calloc(1, sizeof(flib_gameconn));
@@ -85,7 +95,8 @@ static flib_gameconn *flib_gameconn_create_partial(bool record, const char *play
         tempConn->ipcBase = flib_ipcbase_create();
         tempConn->configBuffer = flib_vector_create();
         tempConn->playerName = flib_strdupnull(playerName);
-        if(tempConn->ipcBase && tempConn->configBuffer && tempConn->playerName) {
+        if(tempConn->ipcBase && tempConn->configBuffer && tempConn->playerName
+                && !flib_eventloop_register(tempConn, eventloopTick)) {
             if(record) {
                 tempConn->demoBuffer = flib_vector_create();
             }
@@ -181,6 +192,7 @@ void flib_gameconn_destroy(flib_gameconn *conn) {
             clearCallbacks(conn);
             conn->destroyRequested = true;
         } else {
+            flib_eventloop_unregister(conn);
             flib_ipcbase_destroy(conn->ipcBase);
             flib_vector_destroy(conn->configBuffer);
             flib_vector_destroy(conn->demoBuffer);
@@ -368,9 +380,10 @@ static void flib_gameconn_wrappedtick(flib_gameconn *conn) {
     }
 
     if(conn->state == CONNECTED) {
-        uint8_t msgbuffer[257];
+        uint8_t *msgbuffer;
         int len;
-        while(!conn->destroyRequested && (len = flib_ipcbase_recv_message(conn->ipcBase, msgbuffer))>=0) {
+        flib_ipcbase_receive(conn->ipcBase);
+        while(!conn->destroyRequested && (len = flib_ipcbase_next_message(conn->ipcBase, &msgbuffer))>=0) {
             if(len<2) {
                 flib_log_w("Received short message from IPC (<2 bytes)");
                 continue;
@@ -28,7 +28,8 @@
  * for starting a game.
  *
  * In order to allow the gameconn to run, you should regularly call flib_gameconn_tick(), which
- * performs network I/O and calls your callbacks on interesting events.
+ * performs network I/O and calls your callbacks on interesting events. Alternatively, call
+ * flib_run_until() to run all open connections at once.
  *
  * Once the engine connects, the gameconn will send it the required commands for starting the
  * game you requested in your flib_gameconn_create call.
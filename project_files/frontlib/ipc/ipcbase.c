@@ -33,13 +33,18 @@
  * bitmap, 1 for the number of hogs which fit on the map).
  *
  * We don't need to worry about wasting a few kb though, and I like powers of two...
+ *
+ * Received messages are consumed by advancing readPos. The remaining data is only moved to the
+ * front of the buffer before the next receive, so handing out messages never copies them.
  */
 struct _flib_ipcbase {
     uint8_t readBuffer[8192];
-    int readBufferSize;
+    int readPos;        //!< Start of the first message that has not been consumed yet
+    int readEnd;        //!< End of the received data
 
     flib_acceptor *acceptor;
     uint16_t port;
+    bool reusable;      //!< Keep the acceptor open after a connection was accepted, but not waited on
 
     flib_tcpsocket *sock;
 };
@@ -56,13 +61,22 @@ flib_ipcbase *flib_ipcbase_create() {
 
     result->acceptor = acceptor;
     result->sock = NULL;
-    result->readBufferSize = 0;
+    result->readPos = 0;
+    result->readEnd = 0;
     result->port = flib_acceptor_listenport(acceptor);
 
     flib_log_i("Started listening for IPC connections on port %u", (unsigned)result->port);
     return result;
 }
 
+flib_ipcbase *flib_ipcbase_create_reusable() {
+    flib_ipcbase *result = flib_ipcbase_create();
+    if(result) {
+        result->reusable = true;
+    }
+    return result;
+}
+
 uint16_t flib_ipcbase_port(flib_ipcbase *ipc) {
     if(log_badargs_if(ipc==NULL)) {
         return 0;
@@ -93,21 +107,35 @@ IpcState flib_ipcbase_state(flib_ipcbase *ipc) {
     }
 }
 
+static void closeConnection(flib_ipcbase *ipc) {
+    flib_socket_close(ipc->sock);
+    ipc->sock = NULL;
+    if(ipc->acceptor) {
+        // Listen for the next engine again
+        flib_acceptor_setWaiting(ipc->acceptor, true);
+    }
+}
+
 static void receiveToBuffer(flib_ipcbase *ipc) {
     if(ipc->sock) {
-        int size = flib_socket_nbrecv(ipc->sock, ipc->readBuffer+ipc->readBufferSize, sizeof(ipc->readBuffer)-ipc->readBufferSize);
+        if(ipc->readPos>0) {
+            memmove(ipc->readBuffer, ipc->readBuffer+ipc->readPos, ipc->readEnd-ipc->readPos);
+            ipc->readEnd -= ipc->readPos;
+            ipc->readPos = 0;
+        }
+        int size = flib_socket_nbrecv(ipc->sock, ipc->readBuffer+ipc->readEnd, sizeof(ipc->readBuffer)-ipc->readEnd);
         if(size>=0) {
-            ipc->readBufferSize += size;
+            ipc->readEnd += size;
         } else {
             flib_log_d("IPC connection lost.");
-            flib_socket_close(ipc->sock);
-            ipc->sock = NULL;
+            closeConnection(ipc);
         }
     }
 }
 
 static bool isMessageReady(flib_ipcbase *ipc) {
-    return ipc->readBufferSize >= ipc->readBuffer[0]+1;
+    int available = ipc->readEnd-ipc->readPos;
+    return available>0 && available >= ipc->readBuffer[ipc->readPos]+1;
 }
 
 static void logSentMsg(const uint8_t *data, size_t len) {
@@ -133,10 +161,29 @@ static void logRecvMsg(const uint8_t *data) {
     }
 }
 
-static void popFromReadBuffer(flib_ipcbase *ipc, uint8_t *outbuf, size_t size) {
-    memcpy(outbuf, ipc->readBuffer, size);
-    memmove(ipc->readBuffer, ipc->readBuffer+size, ipc->readBufferSize-size);
-    ipc->readBufferSize -= size;
+void flib_ipcbase_receive(flib_ipcbase *ipc) {
+    if(!log_badargs_if(ipc==NULL)) {
+        receiveToBuffer(ipc);
+    }
+}
+
+int flib_ipcbase_next_message(flib_ipcbase *ipc, uint8_t **data) {
+    if(log_badargs_if2(ipc==NULL, data==NULL)) {
+        return -1;
+    }
+
+    if(isMessageReady(ipc)) {
+        int msgsize = ipc->readBuffer[ipc->readPos]+1;
+        *data = ipc->readBuffer+ipc->readPos;
+        ipc->readPos += msgsize;
+        logRecvMsg(*data);
+        return msgsize;
+    } else if(!ipc->sock && ipc->readEnd>ipc->readPos) {
+        flib_log_w("Last message from engine data stream is incomplete (received %u of %u bytes)", (unsigned)(ipc->readEnd-ipc->readPos), (unsigned)(ipc->readBuffer[ipc->readPos])+1);
+        ipc->readPos = 0;
+        ipc->readEnd = 0;
+    }
+    return -1;
 }
 
 int flib_ipcbase_recv_message(flib_ipcbase *ipc, void *data) {
@@ -148,18 +195,12 @@ int flib_ipcbase_recv_message(flib_ipcbase *ipc, void *data) {
         receiveToBuffer(ipc);
     }
 
-    if(isMessageReady(ipc)) {
-        int msgsize = ipc->readBuffer[0]+1;
-        popFromReadBuffer(ipc, data, msgsize);
-        logRecvMsg(data);
-        return msgsize;
-    } else if(!ipc->sock && ipc->readBufferSize>0) {
-        flib_log_w("Last message from engine data stream is incomplete (received %u of %u bytes)", (unsigned)ipc->readBufferSize, (unsigned)(ipc->readBuffer[0])+1);
-        ipc->readBufferSize = 0;
-        return -1;
-    } else {
-        return -1;
+    uint8_t *msg;
+    int msgsize = flib_ipcbase_next_message(ipc, &msg);
+    if(msgsize>=0) {
+        memcpy(data, msg, msgsize);
     }
+    return msgsize;
 }
 
 int flib_ipcbase_recv_map(flib_ipcbase *ipc, void *data) {
@@ -169,8 +210,9 @@ int flib_ipcbase_recv_map(flib_ipcbase *ipc, void *data) {
 
     receiveToBuffer(ipc);
 
-    if(ipc->readBufferSize >= IPCBASE_MAPMSG_BYTES) {
-        popFromReadBuffer(ipc, data, IPCBASE_MAPMSG_BYTES);
+    if(ipc->readEnd-ipc->readPos >= IPCBASE_MAPMSG_BYTES) {
+        memcpy(data, ipc->readBuffer+ipc->readPos, IPCBASE_MAPMSG_BYTES);
+        ipc->readPos += IPCBASE_MAPMSG_BYTES;
         return IPCBASE_MAPMSG_BYTES;
     } else {
         return -1;
@@ -187,8 +229,7 @@ int flib_ipcbase_send_raw(flib_ipcbase *ipc, const void *data, size_t len) {
         return 0;
     } else {
         flib_log_w("Failed or incomplete IPC write: engine connection lost.");
-        flib_socket_close(ipc->sock);
-        ipc->sock = NULL;
+        closeConnection(ipc);
         return -1;
     }
 }
@@ -209,8 +250,15 @@ void flib_ipcbase_accept(flib_ipcbase *ipc) {
         ipc->sock = flib_socket_accept(ipc->acceptor, true);
         if(ipc->sock) {
             flib_log_d("IPC connection accepted.");
-            flib_acceptor_close(ipc->acceptor);
-            ipc->acceptor = NULL;
+            ipc->readPos = 0;
+            ipc->readEnd = 0;
+            if(!ipc->reusable) {
+                flib_acceptor_close(ipc->acceptor);
+                ipc->acceptor = NULL;
+            } else {
+                // Nothing is accepted until this connection closes, so don't wake up for it
+                flib_acceptor_setWaiting(ipc->acceptor, false);
+            }
         }
     }
 }
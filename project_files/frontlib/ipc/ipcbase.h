@@ -44,6 +44,14 @@ typedef struct _flib_ipcbase flib_ipcbase;
  */
 flib_ipcbase *flib_ipcbase_create();
 
+/**
+ * Like flib_ipcbase_create, but keep listening on the same port while a connection is
+ * established. Once that connection is closed, the state returns to IPC_LISTENING and
+ * the next engine can connect to the same port, so one ipcbase can serve several engine
+ * runs one after another. flib_socket_wait ignores the port while a connection is established.
+ */
+flib_ipcbase *flib_ipcbase_create_reusable();
+
 /**
  * Return the listening port
  */
@@ -59,6 +67,23 @@ void flib_ipcbase_destroy(flib_ipcbase *ipc);
  */
 IpcState flib_ipcbase_state(flib_ipcbase *ipc);
 
+/**
+ * Read whatever the engine has sent since the last call into the receive buffer, without
+ * blocking. Call this once, and then flib_ipcbase_next_message until it fails, to handle all
+ * messages that are available.
+ */
+void flib_ipcbase_receive(flib_ipcbase *ipc);
+
+/**
+ * Take the next complete message from the receive buffer without copying it. This does not
+ * read from the socket, see flib_ipcbase_receive.
+ * On success, *data points to the message and its length is returned (see
+ * flib_ipcbase_recv_message). The message may be modified and stays valid until the next
+ * call to flib_ipcbase_receive, flib_ipcbase_recv_message or flib_ipcbase_recv_map.
+ * Returns a negative value if no complete message is available.
+ */
+int flib_ipcbase_next_message(flib_ipcbase *ipc, uint8_t **data);
+
 /**
  * Receive a single message (up to 256 bytes) and copy it into the data buffer.
  * Returns the length of the received message, a negative value if no message could
@@ -0,0 +1,286 @@
+/*
+ * Hedgewars, a free turn based strategy game
+ * Copyright (C) 2012 Simeon Maxein <smaxein@googlemail.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "mapbatch.h"
+#include "ipcbase.h"
+#include "ipcprotocol.h"
+
+#include "../util/logging.h"
+#include "../util/buffer.h"
+#include "../util/util.h"
+#include "../eventloop.h"
+
+#include <stdlib.h>
+#include <time.h>
+
+#define DEFAULT_CONNECT_TIMEOUT 30
+
+typedef enum {
+    WORKER_IDLE,
+    WORKER_AWAIT_CONNECTION,
+    WORKER_AWAIT_REPLY,
+    WORKER_AWAIT_CLOSE
+} mapbatch_worker_state;
+
+typedef struct {
+    flib_ipcbase *ipcBase;      //!< Reusable, so every map of this worker goes through the same port
+    mapbatch_worker_state state;
+    int job;                    //!< Index of the map this worker is rendering
+    time_t startTime;           //!< When the engine for the job was started
+} mapbatch_worker;
+
+struct _flib_mapbatch {
+    uint8_t mapBuffer[IPCBASE_MAPMSG_BYTES];
+
+    flib_vector **configBuffers;
+    int jobCount;
+    int nextJob;
+    int reportedJobs;
+
+    mapbatch_worker *workers;
+    int workerCount;
+    int connectTimeout;         //!< Seconds until a job fails if its engine doesn't connect
+
+    void (*onStartEngineCb)(void*, int);
+    void *onStartEngineCtx;
+
+    void (*onPreviewCb)(void*, int, const uint8_t*, int);
+    void *onPreviewCtx;
+
+    void (*onFailureCb)(void*, int, const char*);
+    void *onFailureCtx;
+
+    bool running;
+    bool destroyRequested;
+};
+
+static void noop_handleStartEngine(void *context, int port) {}
+static void noop_handlePreview(void *context, int index, const uint8_t *bitmap, int numHedgehogs) {}
+static void noop_handleFailure(void *context, int index, const char *errormessage) {}
+
+static void clearCallbacks(flib_mapbatch *batch) {
+    batch->onStartEngineCb = &noop_handleStartEngine;
+    batch->onPreviewCb = &noop_handlePreview;
+    batch->onFailureCb = &noop_handleFailure;
+}
+
+static bool eventloopTick(void *object) {
+    flib_mapbatch *batch = object;
+    if(flib_mapbatch_finished(batch)) {
+        return false;
+    }
+    flib_mapbatch_tick(batch);
+    return true;
+}
+
+static flib_vector *createConfigBuffer(const flib_map *mapdesc) {
+    flib_vector *result = NULL;
+    flib_vector *tempbuffer = flib_vector_create();
+    if(tempbuffer) {
+        bool error = false;
+        error |= flib_ipc_append_mapconf(tempbuffer, mapdesc, true);
+        error |= flib_ipc_append_message(tempbuffer, "!");
+        if(!error) {
+            result = tempbuffer;
+            tempbuffer = NULL;
+        }
+    }
+    flib_vector_destroy(tempbuffer);
+    return result;
+}
+
+flib_mapbatch *flib_mapbatch_create(const flib_map **maps, int mapCount, int workerCount) {
+    if(log_badargs_if3(maps==NULL && mapCount>0, mapCount<0, workerCount<1)) {
+        return NULL;
+    }
+    if(workerCount > mapCount) {
+        workerCount = mapCount;
+    }
+    flib_mapbatch *result = NULL;
+    flib_mapbatch *tempBatch = flib_calloc(1, sizeof(flib_mapbatch));
+    if(tempBatch) {
+        clearCallbacks(tempBatch);
+        tempBatch->connectTimeout = DEFAULT_CONNECT_TIMEOUT;
+        bool error = false;
+        tempBatch->configBuffers = flib_calloc(mapCount, sizeof(flib_vector*));
+        tempBatch->workers = flib_calloc(workerCount, sizeof(mapbatch_worker));
+        if(mapCount>0) {
+            error |= !tempBatch->configBuffers || !tempBatch->workers;
+        }
+        for(int i=0; !error && i<mapCount; i++) {
+            tempBatch->configBuffers[i] = createConfigBuffer(maps[i]);
+            error |= !tempBatch->configBuffers[i];
+            tempBatch->jobCount = i+1;
+        }
+        for(int i=0; !error && i<workerCount; i++) {
+            tempBatch->workers[i].ipcBase = flib_ipcbase_create_reusable();
+            tempBatch->workers[i].state = WORKER_IDLE;
+            error |= !tempBatch->workers[i].ipcBase;
+            tempBatch->workerCount = i+1;
+        }
+        if(!error && !flib_eventloop_register(tempBatch, eventloopTick)) {
+            result = tempBatch;
+            tempBatch = NULL;
+        }
+    }
+    flib_mapbatch_destroy(tempBatch);
+    return result;
+}
+
+void flib_mapbatch_destroy(flib_mapbatch *batch) {
+    if(batch) {
+        if(batch->running) {
+            /*
+             * The function was called from a callback, so the tick function is still running
+             * and we delay the actual destruction. We ensure no further callbacks will be
+             * sent to prevent surprises.
+             */
+            clearCallbacks(batch);
+            batch->destroyRequested = true;
+        } else {
+            flib_eventloop_unregister(batch);
+            for(int i=0; i<batch->workerCount; i++) {
+                flib_ipcbase_destroy(batch->workers[i].ipcBase);
+            }
+            for(int i=0; i<batch->jobCount; i++) {
+                flib_vector_destroy(batch->configBuffers[i]);
+            }
+            free(batch->workers);
+            free(batch->configBuffers);
+            free(batch);
+        }
+    }
+}
+
+void flib_mapbatch_onStartEngine(flib_mapbatch *batch, void (*callback)(void *context, int port), void *context) {
+    if(!log_badargs_if(batch==NULL)) {
+        batch->onStartEngineCb = callback ? callback : &noop_handleStartEngine;
+        batch->onStartEngineCtx = context;
+    }
+}
+
+void flib_mapbatch_setConnectTimeout(flib_mapbatch *batch, int seconds) {
+    if(!log_badargs_if2(batch==NULL, seconds<0)) {
+        batch->connectTimeout = seconds;
+    }
+}
+
+void flib_mapbatch_onPreview(flib_mapbatch *batch, void (*callback)(void *context, int index, const uint8_t *bitmap, int numHedgehogs), void *context) {
+    if(!log_badargs_if(batch==NULL)) {
+        batch->onPreviewCb = callback ? callback : &noop_handlePreview;
+        batch->onPreviewCtx = context;
+    }
+}
+
+void flib_mapbatch_onFailure(flib_mapbatch *batch, void (*callback)(void *context, int index, const char *errormessage), void *context) {
+    if(!log_badargs_if(batch==NULL)) {
+        batch->onFailureCb = callback ? callback : &noop_handleFailure;
+        batch->onFailureCtx = context;
+    }
+}
+
+bool flib_mapbatch_finished(flib_mapbatch *batch) {
+    if(log_badargs_if(batch==NULL)) {
+        return true;
+    }
+    return batch->reportedJobs >= batch->jobCount;
+}
+
+static void reportFailure(flib_mapbatch *batch, mapbatch_worker *worker, const char *errormessage) {
+    worker->state = WORKER_IDLE;
+    batch->reportedJobs++;
+    batch->onFailureCb(batch->onFailureCtx, worker->job, errormessage);
+}
+
+static void tickWorker(flib_mapbatch *batch, mapbatch_worker *worker) {
+    if(worker->state == WORKER_IDLE) {
+        if(batch->nextJob >= batch->jobCount) {
+            return;
+        }
+        worker->job = batch->nextJob++;
+        worker->state = WORKER_AWAIT_CONNECTION;
+        worker->startTime = time(NULL);
+        batch->onStartEngineCb(batch->onStartEngineCtx, flib_ipcbase_port(worker->ipcBase));
+        if(batch->destroyRequested) {
+            return;
+        }
+    }
+
+    if(worker->state == WORKER_AWAIT_CONNECTION) {
+        flib_ipcbase_accept(worker->ipcBase);
+        if(flib_ipcbase_state(worker->ipcBase) == IPC_CONNECTED) {
+            flib_constbuffer configBuffer = flib_vector_as_constbuffer(batch->configBuffers[worker->job]);
+            if(flib_ipcbase_send_raw(worker->ipcBase, configBuffer.data, configBuffer.size)) {
+                reportFailure(batch, worker, "Error sending map information to the engine.");
+                return;
+            }
+            worker->state = WORKER_AWAIT_REPLY;
+        } else if(difftime(time(NULL), worker->startTime) > batch->connectTimeout) {
+            // The engine didn't start or died early, don't wait for it forever
+            reportFailure(batch, worker, "The engine did not connect in time.");
+            return;
+        }
+    }
+
+    if(worker->state == WORKER_AWAIT_REPLY) {
+        if(flib_ipcbase_recv_map(worker->ipcBase, batch->mapBuffer) >= 0) {
+            // Report right away, the engine only needs to quit before the worker takes the next map
+            worker->state = WORKER_AWAIT_CLOSE;
+            batch->reportedJobs++;
+            batch->onPreviewCb(batch->onPreviewCtx, worker->job, batch->mapBuffer, batch->mapBuffer[IPCBASE_MAPMSG_BYTES-1]);
+            if(batch->destroyRequested) {
+                return;
+            }
+        } else if(flib_ipcbase_state(worker->ipcBase) != IPC_CONNECTED) {
+            reportFailure(batch, worker, "Engine connection closed unexpectedly.");
+            return;
+        }
+    }
+
+    if(worker->state == WORKER_AWAIT_CLOSE) {
+        // Just do throwaway reads so we find out when the engine disconnects
+        uint8_t *msg;
+        flib_ipcbase_receive(worker->ipcBase);
+        while(flib_ipcbase_next_message(worker->ipcBase, &msg) >= 0) {}
+        if(flib_ipcbase_state(worker->ipcBase) != IPC_CONNECTED) {
+            worker->state = WORKER_IDLE;
+            // Hand out the next map right away instead of waiting for the next tick
+            tickWorker(batch, worker);
+        }
+    }
+}
+
+static void flib_mapbatch_wrappedtick(flib_mapbatch *batch) {
+    for(int i=0; i<batch->workerCount && !batch->destroyRequested; i++) {
+        tickWorker(batch, &batch->workers[i]);
+    }
+}
+
+void flib_mapbatch_tick(flib_mapbatch *batch) {
+    if(!log_badargs_if(batch==NULL)
+            && !log_w_if(batch->running, "Call to flib_mapbatch_tick from a callback")) {
+        batch->running = true;
+        flib_mapbatch_wrappedtick(batch);
+        batch->running = false;
+
+        if(batch->destroyRequested) {
+            flib_mapbatch_destroy(batch);
+        }
+    }
+}
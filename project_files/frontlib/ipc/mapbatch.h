@@ -0,0 +1,116 @@
+/*
+ * Hedgewars, a free turn based strategy game
+ * Copyright (C) 2012 Simeon Maxein <smaxein@googlemail.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+/**
+ * Functions for rendering the previews of many maps with a pool of engines.
+ *
+ * This works like the mapconn (see mapconn.h), but for a whole list of maps at once. Create a
+ * mapbatch with flib_mapbatch_create, passing the maps and the number of engines that should
+ * run at the same time. Each of these workers listens on its own port, which is reused for
+ * all maps that the worker renders.
+ *
+ * Starting the engines is up to you: register an onStartEngine callback, which is called
+ * whenever a worker is ready for the next map. Start the engine with the appropriate command
+ * line arguments for a map preview request on the port passed to the callback. If the engine
+ * does not connect within the connect timeout, e.g. because it could not be started, the map
+ * is reported as failed and the worker goes on with the next one.
+ *
+ * In order to allow the mapbatch to run, you should regularly call flib_mapbatch_tick() or
+ * flib_run_until(). The results are reported through the onPreview and onFailure callbacks
+ * as they come in, so they are not necessarily in the order of the list. Once
+ * flib_mapbatch_finished returns true, every map has been reported and you should destroy
+ * the mapbatch.
+ */
+
+#ifndef IPC_MAPBATCH_H_
+#define IPC_MAPBATCH_H_
+
+#include "../model/map.h"
+#include "mapconn.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef struct _flib_mapbatch flib_mapbatch;
+
+/**
+ * Create a mapbatch for rendering the previews of mapCount maps, using up to workerCount
+ * engines at the same time. The same restrictions as for flib_mapconn_create apply to the
+ * maps. The maps are not referenced after this call returns.
+ *
+ * Returns NULL on failure. Use flib_mapbatch_destroy to free the returned object.
+ */
+flib_mapbatch *flib_mapbatch_create(const flib_map **maps, int mapCount, int workerCount);
+
+/**
+ * Destroy the mapbatch object. Passing NULL is allowed and does nothing.
+ * flib_mapbatch_destroy may be called from inside a callback function.
+ */
+void flib_mapbatch_destroy(flib_mapbatch *batch);
+
+/**
+ * Set a callback which is called when an engine has to be started for the next map.
+ * Without this callback, no maps will be rendered.
+ *
+ * Expected callback signature:
+ * void handleStartEngine(void *context, int port)
+ *
+ * The engine has to connect to the given port on localhost.
+ */
+void flib_mapbatch_onStartEngine(flib_mapbatch *batch, void (*callback)(void *context, int port), void *context);
+
+/**
+ * Set the number of seconds an engine has to connect after the onStartEngine callback
+ * before its map is reported as failed. The default is 30 seconds.
+ */
+void flib_mapbatch_setConnectTimeout(flib_mapbatch *batch, int seconds);
+
+/**
+ * Set a callback which will receive the rendered map for each map that succeeds.
+ *
+ * Expected callback signature:
+ * void handlePreview(void *context, int index, const uint8_t *bitmap, int numHedgehogs)
+ *
+ * index is the position of the map in the list passed to flib_mapbatch_create. The other
+ * parameters are the same as for the onSuccess callback of the mapconn.
+ */
+void flib_mapbatch_onPreview(flib_mapbatch *batch, void (*callback)(void *context, int index, const uint8_t *bitmap, int numHedgehogs), void *context);
+
+/**
+ * Set a callback which will receive an error message for each map that fails.
+ *
+ * Expected callback signature:
+ * void handleFailure(void *context, int index, const char *errormessage)
+ *
+ * index is the position of the map in the list passed to flib_mapbatch_create.
+ */
+void flib_mapbatch_onFailure(flib_mapbatch *batch, void (*callback)(void *context, int index, const char *errormessage), void *context);
+
+/**
+ * Returns true once a result has been reported for every map.
+ */
+bool flib_mapbatch_finished(flib_mapbatch *batch);
+
+/**
+ * Perform I/O operations, start engines and call callbacks if something interesting happens.
+ * Should be called regularly.
+ */
+void flib_mapbatch_tick(flib_mapbatch *batch);
+
+#endif
@@ -24,6 +24,7 @@
 #include "../util/logging.h"
 #include "../util/buffer.h"
 #include "../util/util.h"
+#include "../eventloop.h"
 
 #include <stdlib.h>
 
@@ -59,6 +60,15 @@ static void clearCallbacks(flib_mapconn *conn) {
     conn->onFailureCb = &noop_handleFailure;
 }
 
+static bool eventloopTick(void *object) {
+    flib_mapconn *conn = object;
+    if(conn->progress == FINISHED) {
+        return false;
+    }
+    flib_mapconn_tick(conn);
+    return true;
+}
+
 static flib_vector *createConfigBuffer(const flib_map *mapdesc) {
     flib_vector *result = NULL;
     flib_vector *tempbuffer = flib_vector_create();
@@ -84,7 +94,8 @@ flib_mapconn *flib_mapconn_create(const flib_map *mapdesc) {
     if(tempConn) {
         tempConn->ipcBase = flib_ipcbase_create();
         tempConn->configBuffer = createConfigBuffer(mapdesc);
-        if(tempConn->ipcBase && tempConn->configBuffer) {
+        if(tempConn->ipcBase && tempConn->configBuffer
+                && !flib_eventloop_register(tempConn, eventloopTick)) {
             tempConn->progress = AWAIT_CONNECTION;
             clearCallbacks(tempConn);
             result = tempConn;
@@ -106,6 +117,7 @@ void flib_mapconn_destroy(flib_mapconn *conn) {
             clearCallbacks(conn);
             conn->destroyRequested = true;
         } else {
+            flib_eventloop_unregister(conn);
             flib_ipcbase_destroy(conn->ipcBase);
             flib_vector_destroy(conn->configBuffer);
             free(conn);
@@ -171,8 +183,9 @@ static void flib_mapconn_wrappedtick(flib_mapconn *conn) {
 
     if(conn->progress == AWAIT_CLOSE) {
         // Just do throwaway reads so we find out when the engine disconnects
-        uint8_t buf[256];
-        flib_ipcbase_recv_message(conn->ipcBase, buf);
+        uint8_t *msg;
+        flib_ipcbase_receive(conn->ipcBase);
+        while(flib_ipcbase_next_message(conn->ipcBase, &msg) >= 0) {}
         if(flib_ipcbase_state(conn->ipcBase) != IPC_CONNECTED) {
             conn->progress = FINISHED;
             conn->onSuccessCb(conn->onSuccessCtx, conn->mapBuffer, conn->mapBuffer[IPCBASE_MAPMSG_BYTES-1]);
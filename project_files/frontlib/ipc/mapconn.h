@@ -32,7 +32,8 @@
  * In order to allow the mapconn to run, you should regularly call flib_mapconn_tick(), which
  * performs network I/O and calls your callbacks if the map has been generated or an error
  * has occurred. Once either the onSuccess or onFailure callback is called, you should destroy
- * the mapconn and stop calling tick().
+ * the mapconn and stop calling tick(). Alternatively, call flib_run_until() to run all open
+ * connections at once.
  */
 
 #ifndef IPC_MAPCONN_H_
@@ -21,9 +21,11 @@
 
 #include "../util/inihelper.h"
 #include "../util/logging.h"
+#include "../util/nameindex.h"
 #include "../util/util.h"
 
 #include <stdio.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <limits.h>
 #include <string.h>
@@ -70,12 +72,76 @@ void flib_scheme_destroy(flib_scheme* scheme) {
     }
 }
 
+/**
+ * Size of the hash tables used to look up settings and mods by name. Must be a power of two and
+ * should stay well above the number of settings and mods in the metascheme.
+ */
+#define META_INDEX_SIZE 64
+
+/**
+ * Open-addressing hash table over the names of the metascheme settings or mods. Each slot holds
+ * the index of an entry plus one, or 0 if it is empty. The metascheme is constant, so the tables
+ * are filled once on the first lookup.
+ */
+typedef struct {
+    bool built;
+    uint8_t slots[META_INDEX_SIZE];
+} metaIndex;
+
+static metaIndex settingIndex, modIndex;
+
+static const char *settingName(int i) {
+    return flib_meta.settings[i].name;
+}
+
+static const char *modName(int i) {
+    return flib_meta.mods[i].name;
+}
+
+static void buildIndex(metaIndex *index, int count, const char *(*nameOf)(int)) {
+    if(count >= META_INDEX_SIZE || count > UINT8_MAX-1) {
+        flib_log_e("Metascheme has too many entries (%i) for the lookup table.", count);
+        return;
+    }
+    for(int i=0; i<count; i++) {
+        uint32_t slot = flib_namehash(nameOf(i)) & (META_INDEX_SIZE-1);
+        while(index->slots[slot]) {
+            slot = (slot+1) & (META_INDEX_SIZE-1);
+        }
+        index->slots[slot] = i+1;
+    }
+    index->built = true;
+}
+
+/**
+ * Returns the position of the entry with this name in the metascheme, or -1 if there is none.
+ */
+static int findInIndex(metaIndex *index, int count, const char *(*nameOf)(int), const char *name) {
+    if(!index->built) {
+        buildIndex(index, count, nameOf);
+    }
+    if(index->built) {
+        for(uint32_t slot = flib_namehash(name) & (META_INDEX_SIZE-1); index->slots[slot]; slot = (slot+1) & (META_INDEX_SIZE-1)) {
+            int i = index->slots[slot]-1;
+            if(!strcmp(nameOf(i), name)) {
+                return i;
+            }
+        }
+    } else {
+        for(int i=0; i<count; i++) {
+            if(!strcmp(nameOf(i), name)) {
+                return i;
+            }
+        }
+    }
+    return -1;
+}
+
 bool flib_scheme_get_mod(const flib_scheme *scheme, const char *name) {
     if(!log_badargs_if2(scheme==NULL, name==NULL)) {
-        for(int i=0; i<flib_meta.modCount; i++) {
-            if(!strcmp(flib_meta.mods[i].name, name)) {
-                return scheme->mods[i];
-            }
+        int i = findInIndex(&modIndex, flib_meta.modCount, modName, name);
+        if(i>=0) {
+            return scheme->mods[i];
         }
         flib_log_e("Unable to find game mod %s", name);
     }
@@ -84,10 +150,9 @@ bool flib_scheme_get_mod(const flib_scheme *scheme, const char *name) {
 
 int flib_scheme_get_setting(const flib_scheme *scheme, const char *name, int def) {
     if(!log_badargs_if2(scheme==NULL, name==NULL)) {
-        for(int i=0; i<flib_meta.settingCount; i++) {
-            if(!strcmp(flib_meta.settings[i].name, name)) {
-                return scheme->settings[i];
-            }
+        int i = findInIndex(&settingIndex, flib_meta.settingCount, settingName, name);
+        if(i>=0) {
+            return scheme->settings[i];
         }
         flib_log_e("Unable to find game setting %s", name);
     }
@@ -113,6 +113,10 @@ flib_schemelist *flib_schemelist_from_ini(const char *filename) {
         return fromIniHandleError(list, ini);
     }
 
+    if(schemeCount>0 && flib_schemelist_reserve(list, schemeCount)) {
+        return fromIniHandleError(list, ini);
+    }
+
     for(int i=0; i<schemeCount; i++) {
         flib_scheme *scheme = readSchemeFromIni(ini, i);
         if(!scheme || flib_schemelist_insert(list, scheme, i)) {
@@ -169,7 +173,15 @@ int flib_schemelist_to_ini(const char *filename, const flib_schemelist *schemes)
 }
 
 flib_schemelist *flib_schemelist_create() {
-    return flib_calloc(1, sizeof(flib_schemelist));
+    flib_schemelist *result = flib_calloc(1, sizeof(flib_schemelist));
+    if(result) {
+        result->nameIndex = flib_nameindex_create();
+        if(!result->nameIndex) {
+            free(result);
+            result = NULL;
+        }
+    }
+    return result;
 }
 
 void flib_schemelist_destroy(flib_schemelist *list) {
@@ -178,12 +190,17 @@ void flib_schemelist_destroy(flib_schemelist *list) {
             flib_scheme_destroy(list->schemes[i]);
         }
         free(list->schemes);
+        flib_nameindex_destroy(list->nameIndex);
         free(list);
     }
 }
 
 flib_scheme *flib_schemelist_find(flib_schemelist *list, const char *name) {
     if(!log_badargs_if2(list==NULL, name==NULL)) {
+        if(list->nameIndex) {
+            int pos = flib_nameindex_find(list->nameIndex, name);
+            return pos>=0 ? list->schemes[pos] : NULL;
+        }
         for(int i=0; i<list->schemeCount; i++) {
             if(!strcmp(name, list->schemes[i]->name)) {
                 return list->schemes[i];
@@ -193,21 +210,37 @@ flib_scheme *flib_schemelist_find(flib_schemelist *list, const char *name) {
     return NULL;
 }
 
+GENERATE_STATIC_LIST_RESERVE(reserveSchemes, flib_scheme*)
 GENERATE_STATIC_LIST_INSERT(insertScheme, flib_scheme*)
 GENERATE_STATIC_LIST_DELETE(deleteScheme, flib_scheme*)
 
+int flib_schemelist_reserve(flib_schemelist *list, int capacity) {
+    if(!log_badargs_if(list==NULL)
+            && !reserveSchemes(&list->schemes, &list->schemeCapacity, capacity)) {
+        return 0;
+    }
+    return -1;
+}
+
 int flib_schemelist_insert(flib_schemelist *list, flib_scheme *cfg, int pos) {
     if(!log_badargs_if2(list==NULL, cfg==NULL)
-            && !insertScheme(&list->schemes, &list->schemeCount, cfg, pos)) {
-        return 0;
+            && !insertScheme(&list->schemes, &list->schemeCount, &list->schemeCapacity, cfg, pos)) {
+        if(!list->nameIndex || !flib_nameindex_insert(list->nameIndex, cfg->name, pos)) {
+            return 0;
+        }
+        // keep the list and its index in step
+        deleteScheme(&list->schemes, &list->schemeCount, &list->schemeCapacity, pos);
     }
     return -1;
 }
 
 int flib_schemelist_delete(flib_schemelist *list, int pos) {
-    if(!log_badargs_if(list==NULL)) {
+    if(!log_badargs_if3(list==NULL, pos<0, pos>=(list ? list->schemeCount : 0))) {
         flib_scheme *elem = list->schemes[pos];
-        if(!deleteScheme(&list->schemes, &list->schemeCount, pos)) {
+        if(!deleteScheme(&list->schemes, &list->schemeCount, &list->schemeCapacity, pos)) {
+            if(list->nameIndex) {
+                flib_nameindex_delete(list->nameIndex, pos);
+            }
             flib_scheme_destroy(elem);
             return 0;
         }
@@ -27,10 +27,18 @@
 #define SCHEMELIST_H_
 
 #include "scheme.h"
+#include "../util/nameindex.h"
 
+/**
+ * Schemes are found by name through nameIndex, so don't rename a scheme while it is in a list
+ * created with flib_schemelist_create. Lists set up by hand without an index (NULL) are
+ * searched linearly.
+ */
 typedef struct {
     int schemeCount;
     flib_scheme **schemes;
+    int schemeCapacity;     //!< Number of entries allocated for schemes
+    flib_nameindex *nameIndex;  //!< Positions of the schemes by name, or NULL
 } flib_schemelist;
 
 /**
@@ -50,6 +58,12 @@ int flib_schemelist_to_ini(const char *filename, const flib_schemelist *config);
  */
 flib_schemelist *flib_schemelist_create();
 
+/**
+ * Make room for at least [capacity] schemes, so that they can be inserted without
+ * reallocating the list. Returns 0 on success.
+ */
+int flib_schemelist_reserve(flib_schemelist *list, int capacity);
+
 /**
  * Insert a new scheme into the list at position pos, moving all higher schemes to make place.
  * pos must be at least 0 (insert at the start) and at most list->schemeCount (insert at the end).
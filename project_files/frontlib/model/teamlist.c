@@ -27,7 +27,15 @@
 #include <string.h>
 
 flib_teamlist *flib_teamlist_create() {
-    return flib_calloc(1, sizeof(flib_teamlist));
+    flib_teamlist *result = flib_calloc(1, sizeof(flib_teamlist));
+    if(result) {
+        result->nameIndex = flib_nameindex_create();
+        if(!result->nameIndex) {
+            free(result);
+            result = NULL;
+        }
+    }
+    return result;
 }
 
 void flib_teamlist_destroy(flib_teamlist *list) {
@@ -36,14 +44,19 @@ void flib_teamlist_destroy(flib_teamlist *list) {
             flib_team_destroy(list->teams[i]);
         }
         free(list->teams);
+        flib_nameindex_destroy(list->nameIndex);
         free(list);
     }
 }
 
+GENERATE_STATIC_LIST_RESERVE(reserveTeams, flib_team*)
 GENERATE_STATIC_LIST_INSERT(insertTeam, flib_team*)
 GENERATE_STATIC_LIST_DELETE(deleteTeam, flib_team*)
 
 static int findTeam(const flib_teamlist *list, const char *name) {
+    if(list->nameIndex) {
+        return flib_nameindex_find(list->nameIndex, name);
+    }
     for(int i=0; i<list->teamCount; i++) {
         if(!strcmp(name, list->teams[i]->name)) {
             return i;
@@ -52,10 +65,22 @@ static int findTeam(const flib_teamlist *list, const char *name) {
     return -1;
 }
 
+int flib_teamlist_reserve(flib_teamlist *list, int capacity) {
+    if(!log_badargs_if(list==NULL)
+            && !reserveTeams(&list->teams, &list->teamCapacity, capacity)) {
+        return 0;
+    }
+    return -1;
+}
+
 int flib_teamlist_insert(flib_teamlist *list, flib_team *team, int pos) {
     if(!log_badargs_if2(list==NULL, team==NULL)
-            && !insertTeam(&list->teams, &list->teamCount, team, pos)) {
-        return 0;
+            && !insertTeam(&list->teams, &list->teamCount, &list->teamCapacity, team, pos)) {
+        if(!list->nameIndex || !flib_nameindex_insert(list->nameIndex, team->name, pos)) {
+            return 0;
+        }
+        // keep the list and its index in step
+        deleteTeam(&list->teams, &list->teamCount, &list->teamCapacity, pos);
     }
     return -1;
 }
@@ -66,7 +91,10 @@ int flib_teamlist_delete(flib_teamlist *list, const char *name) {
         int itemid = findTeam(list, name);
         if(itemid>=0) {
             flib_team *team = list->teams[itemid];
-            if(!deleteTeam(&list->teams, &list->teamCount, itemid)) {
+            if(!deleteTeam(&list->teams, &list->teamCount, &list->teamCapacity, itemid)) {
+                if(list->nameIndex) {
+                    flib_nameindex_delete(list->nameIndex, itemid);
+                }
                 flib_team_destroy(team);
                 result = 0;
             }
@@ -94,6 +122,10 @@ void flib_teamlist_clear(flib_teamlist *list) {
         free(list->teams);
         list->teams = NULL;
         list->teamCount = 0;
+        list->teamCapacity = 0;
+        if(list->nameIndex) {
+            flib_nameindex_clear(list->nameIndex);
+        }
     }
 }
 
@@ -103,7 +135,7 @@ flib_teamlist *flib_teamlist_copy(flib_teamlist *list) {
     }
     flib_teamlist *result = flib_teamlist_create();
     if(result) {
-        bool error = false;
+        bool error = flib_teamlist_reserve(result, list->teamCount);
         for(int i=0; !error && i<list->teamCount; i++) {
             flib_team *teamcopy = flib_team_copy(list->teams[i]);
             if(!teamcopy || flib_teamlist_insert(result, teamcopy, i)) {
@@ -21,16 +21,30 @@
 #define TEAMLIST_H_
 
 #include "team.h"
+#include "../util/nameindex.h"
 
+/**
+ * Teams are found by name through nameIndex, so don't rename a team while it is in a list
+ * created with flib_teamlist_create. Lists set up by hand without an index (NULL) are searched
+ * linearly.
+ */
 typedef struct {
     int teamCount;
     flib_team **teams;
+    int teamCapacity;       //!< Number of entries allocated for teams
+    flib_nameindex *nameIndex;  //!< Positions of the teams by name, or NULL
 } flib_teamlist;
 
 flib_teamlist *flib_teamlist_create();
 
 void flib_teamlist_destroy(flib_teamlist *list);
 
+/**
+ * Make room for at least [capacity] teams, so that they can be inserted without
+ * reallocating the list. Returns 0 on success.
+ */
+int flib_teamlist_reserve(flib_teamlist *list, int capacity);
+
 /**
  * Insert a team into the list. The list takes ownership of the team. Returns 0 on success.
  */
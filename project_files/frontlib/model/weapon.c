@@ -138,8 +138,8 @@ static int fillWeaponsetFromIni(flib_weaponsetlist *list, flib_ini *ini, int ind
 }
 
 static int fillWeaponsetsFromIni(flib_weaponsetlist *list, flib_ini *ini) {
-    bool error = false;
     int weaponsets = flib_ini_get_keycount(ini);
+    bool error = weaponsets>0 && flib_weaponsetlist_reserve(list, weaponsets);
 
     for(int i=0; i<weaponsets && !error; i++) {
         error |= fillWeaponsetFromIni(list, ini, i);
@@ -211,12 +211,21 @@ flib_weaponsetlist *flib_weaponsetlist_create() {
     return flib_calloc(1, sizeof(flib_weaponsetlist));
 }
 
+GENERATE_STATIC_LIST_RESERVE(reserveWeaponsets, flib_weaponset*)
 GENERATE_STATIC_LIST_INSERT(insertWeaponset, flib_weaponset*)
 GENERATE_STATIC_LIST_DELETE(deleteWeaponset, flib_weaponset*)
 
+int flib_weaponsetlist_reserve(flib_weaponsetlist *list, int capacity) {
+    if(!log_badargs_if(list==NULL)
+            && !reserveWeaponsets(&list->weaponsets, &list->weaponsetCapacity, capacity)) {
+        return 0;
+    }
+    return -1;
+}
+
 int flib_weaponsetlist_insert(flib_weaponsetlist *list, flib_weaponset *set, int pos) {
     if(!log_badargs_if2(list==NULL, set==NULL)
-            && !insertWeaponset(&list->weaponsets, &list->weaponsetCount, set, pos)) {
+            && !insertWeaponset(&list->weaponsets, &list->weaponsetCount, &list->weaponsetCapacity, set, pos)) {
         return 0;
     }
     return -1;
@@ -225,7 +234,7 @@ int flib_weaponsetlist_insert(flib_weaponsetlist *list, flib_weaponset *set, int
 int flib_weaponsetlist_delete(flib_weaponsetlist *list, int pos) {
     if(!log_badargs_if(list==NULL)) {
         flib_weaponset *elem = list->weaponsets[pos];
-        if(!deleteWeaponset(&list->weaponsets, &list->weaponsetCount, pos)) {
+        if(!deleteWeaponset(&list->weaponsets, &list->weaponsetCount, &list->weaponsetCapacity, pos)) {
             flib_weaponset_destroy(elem);
             return 0;
         }
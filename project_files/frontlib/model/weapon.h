@@ -40,6 +40,7 @@ typedef struct {
 typedef struct {
     int weaponsetCount;
     flib_weaponset **weaponsets;
+    int weaponsetCapacity;  //!< Number of entries allocated for weaponsets
 } flib_weaponsetlist;
 
 /**
@@ -86,6 +87,12 @@ flib_weaponsetlist *flib_weaponsetlist_create();
  */
 void flib_weaponsetlist_destroy(flib_weaponsetlist *list);
 
+/**
+ * Make room for at least [capacity] weaponsets, so that they can be inserted without
+ * reallocating the list. Returns 0 on success.
+ */
+int flib_weaponsetlist_reserve(flib_weaponsetlist *list, int capacity);
+
 /**
  * Insert a new weaponset into the list at position pos, moving all higher weaponsets to make place.
  * pos must be at least 0 (insert at the start) and at most list->weaponsetCount (insert at the end).
@@ -18,7 +18,6 @@
  */
 
 #include "netbase.h"
-#include "../util/buffer.h"
 #include "../util/logging.h"
 #include "../util/util.h"
 #include "../socket.h"
@@ -29,9 +28,14 @@
 #include <stdio.h>
 
 #define NET_READBUFFER_LIMIT (1024*1024)
+#define NET_RECV_CHUNK (64*1024)
 
 struct _flib_netbase {
-    flib_vector *readBuffer;
+    uint8_t *readBuffer;
+    size_t readSize;        // Bytes received into readBuffer
+    size_t readCapacity;
+    size_t readPos;         // Start of the first message not returned yet
+    size_t scanPos;         // Everything between readPos and this has been searched for the message end
     flib_tcpsocket *sock;
 };
 
@@ -44,7 +48,8 @@ flib_netbase *flib_netbase_create(const char *server, uint16_t port) {
     flib_netbase *newNet =  flib_calloc(1, sizeof(flib_netbase));
 
     if(newNet) {
-        newNet->readBuffer = flib_vector_create();
+        newNet->readBuffer = flib_malloc(NET_RECV_CHUNK);
+        newNet->readCapacity = NET_RECV_CHUNK;
         newNet->sock = flib_socket_connect(server, port);
         if(newNet->readBuffer && newNet->sock) {
             flib_log_i("Connected to server %s:%u", server, (unsigned)port);
@@ -60,7 +65,7 @@ flib_netbase *flib_netbase_create(const char *server, uint16_t port) {
 void flib_netbase_destroy(flib_netbase *net) {
     if(net) {
         flib_socket_close(net->sock);
-        flib_vector_destroy(net->readBuffer);
+        free(net->readBuffer);
         free(net);
     }
 }
@@ -73,38 +78,79 @@ bool flib_netbase_connected(flib_netbase *net) {
 }
 
 /**
- * Parses and returns a message, and removes it from the vector.
+ * Copies the message between start and end (the '\n' of its empty end marker part)
+ * into a single allocation that holds both the part pointers and the part text.
+ *
+ * The parts can't point into the read buffer or into an arena shared by the
+ * messages of one receive: every message is owned by the caller until its own
+ * flib_netmsg_destroy, which may come after later calls to
+ * flib_netbase_recv_message, when the read buffer has been moved or reused.
  */
-static flib_netmsg *parseMessage(flib_vector *vec) {
-    const uint8_t *partStart = flib_vector_data(vec);
-    const uint8_t *end = partStart+flib_vector_size(vec);
+static flib_netmsg *createMessage(const uint8_t *start, const uint8_t *end) {
+    int partCount = 0;
+    for(const uint8_t *p = start; p < end; p++) {
+        if(*p == '\n') {
+            partCount++;
+        }
+    }
+
     flib_netmsg *result = flib_netmsg_create();
     if(!result) {
         return NULL;
     }
 
-    while(1) {
-        const uint8_t *partEnd = memchr(partStart, '\n', end-partStart);
-        if(!partEnd) {
-            // message incomplete
-            flib_netmsg_destroy(result);
-            return NULL;
-        } else if(partEnd-partStart == 0) {
-            // Zero-length part, message end marker. Remove the message from the vector.
-            uint8_t *vectorStart = flib_vector_data(vec);
-            size_t msgLen = partEnd+1-vectorStart;
-            memmove(vectorStart, partEnd+1, flib_vector_size(vec)-msgLen);
-            flib_vector_resize(vec, flib_vector_size(vec)-msgLen);
-            return result;
-        } else {
-            if(flib_netmsg_append_part(result, partStart, partEnd-partStart)) {
-                flib_netmsg_destroy(result);
-                return NULL;
+    size_t textSize = end-start;
+    // +1 so even an empty message gets a block
+    result->block = flib_malloc(partCount*sizeof(char*) + textSize + 1);
+    if(!result->block) {
+        flib_netmsg_destroy(result);
+        return NULL;
+    }
+
+    result->parts = result->block;
+    char *text = (char*)(result->parts+partCount);
+    memcpy(text, start, textSize);
+
+    // Every part ends in '\n', which becomes its terminating 0
+    char *partStart = text;
+    for(size_t i=0; i<textSize; i++) {
+        if(text[i] == '\n') {
+            text[i] = 0;
+            result->parts[result->partCount++] = partStart;
+            partStart = text+i+1;
+        }
+    }
+    return result;
+}
+
+/**
+ * Parses and returns the next message in the read buffer, or NULL if it is
+ * not complete yet. Bytes already searched are not searched again on the next call.
+ */
+static flib_netmsg *parseMessage(flib_netbase *net) {
+    const uint8_t *start = net->readBuffer+net->readPos;
+    const uint8_t *end = net->readBuffer+net->readSize;
+    const uint8_t *pos = net->readBuffer+net->scanPos;
+
+    // The message ends with an empty part, so either at a '\n' right after another
+    // or at a '\n' the message starts with.
+    while(pos < end) {
+        const uint8_t *lineEnd = memchr(pos, '\n', end-pos);
+        if(!lineEnd) {
+            break;
+        } else if(lineEnd == start || lineEnd[-1] == '\n') {
+            flib_netmsg *result = createMessage(start, lineEnd);
+            if(result) {
+                net->readPos = lineEnd+1-net->readBuffer;
+                net->scanPos = net->readPos;
             }
-            partStart = partEnd+1; // Skip the '\n'
+            return result;
         }
+        pos = lineEnd+1;
     }
-    return NULL; // Never reached
+
+    net->scanPos = net->readSize;
+    return NULL;
 }
 
 /**
@@ -114,23 +160,44 @@ static flib_netmsg *parseMessage(flib_vector *vec) {
  * and sets sock=NULL.
  */
 static int receiveToBuffer(flib_netbase *net) {
-    uint8_t buffer[256];
     if(!net->sock) {
         return 0;
-    } else if(flib_vector_size(net->readBuffer) > NET_READBUFFER_LIMIT) {
+    } else if(net->readSize-net->readPos > NET_READBUFFER_LIMIT) {
         flib_log_e("Net connection closed: Net message too big");
         flib_socket_close(net->sock);
         net->sock = NULL;
         return 0;
-    } else {
-        int size = flib_socket_nbrecv(net->sock, buffer, sizeof(buffer));
-        if(size>=0 && !flib_vector_append(net->readBuffer, buffer, size)) {
-            return size;
-        } else {
+    }
+
+    // Drop the messages returned so far, once per receive instead of once per message
+    if(net->readPos > 0) {
+        memmove(net->readBuffer, net->readBuffer+net->readPos, net->readSize-net->readPos);
+        net->readSize -= net->readPos;
+        net->scanPos -= net->readPos;
+        net->readPos = 0;
+    }
+
+    if(net->readCapacity-net->readSize < NET_RECV_CHUNK/4) {
+        size_t newCapacity = net->readCapacity*2;
+        uint8_t *newBuffer = realloc(net->readBuffer, newCapacity);
+        if(!newBuffer) {
+            flib_log_e("Net connection closed: Out of memory");
             flib_socket_close(net->sock);
             net->sock = NULL;
             return 0;
         }
+        net->readBuffer = newBuffer;
+        net->readCapacity = newCapacity;
+    }
+
+    int size = flib_socket_nbrecv(net->sock, net->readBuffer+net->readSize, net->readCapacity-net->readSize);
+    if(size>=0) {
+        net->readSize += size;
+        return size;
+    } else {
+        flib_socket_close(net->sock);
+        net->sock = NULL;
+        return 0;
     }
 }
 
@@ -140,14 +207,16 @@ flib_netmsg *flib_netbase_recv_message(flib_netbase *net) {
     }
 
     flib_netmsg *msg;
-    while(!(msg=parseMessage(net->readBuffer))
+    while(!(msg=parseMessage(net))
             && receiveToBuffer(net)) {}
 
     if(msg) {
         return msg;
-    } else if(!net->sock && flib_vector_size(net->readBuffer)>0) {
+    } else if(!net->sock && net->readSize>net->readPos) {
         // Connection is down and we didn't get a complete message, just flush the rest.
-        flib_vector_resize(net->readBuffer, 0);
+        net->readSize = 0;
+        net->readPos = 0;
+        net->scanPos = 0;
     }
     return NULL;
 }
@@ -224,6 +293,7 @@ flib_netmsg *flib_netmsg_create() {
     if(result) {
         result->partCount = 0;
         result->parts = NULL;
+        result->block = NULL;
         return result;
     } else {
         return NULL;
@@ -232,17 +302,21 @@ flib_netmsg *flib_netmsg_create() {
 
 void flib_netmsg_destroy(flib_netmsg *msg) {
     if(msg) {
-        for(int i=0; i<msg->partCount; i++) {
-            free(msg->parts[i]);
+        if(msg->block) {
+            free(msg->block);
+        } else {
+            for(int i=0; i<msg->partCount; i++) {
+                free(msg->parts[i]);
+            }
+            free(msg->parts);
         }
-        free(msg->parts);
         free(msg);
     }
 }
 
 int flib_netmsg_append_part(flib_netmsg *msg, const void *part, size_t partlen) {
     int result = -1;
-    if(!log_badargs_if2(msg==NULL, part==NULL && partlen>0)) {
+    if(!log_badargs_if2(msg==NULL || msg->block!=NULL, part==NULL && partlen>0)) {
         char **newParts = realloc(msg->parts, (msg->partCount+1)*sizeof(*msg->parts));
         if(newParts) {
             msg->parts = newParts;
@@ -34,6 +34,7 @@ typedef struct _flib_netbase flib_netbase;
 typedef struct {
     int partCount;
     char **parts;
+    void *block;    // Received messages keep parts and their text in this single allocation
 } flib_netmsg;
 
 /**
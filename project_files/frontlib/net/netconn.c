@@ -25,12 +25,22 @@
 #include "../md5/md5.h"
 #include "../base64/base64.h"
 #include "../model/mapcfg.h"
+#include "../eventloop.h"
 
 #include <stdlib.h>
 #include <string.h>
 #include <errno.h>
 #include <ctype.h>
 
+static bool eventloopTick(void *object) {
+    flib_netconn *conn = object;
+    if(conn->netconnState == NETCONN_STATE_DISCONNECTED) {
+        return false;
+    }
+    flib_netconn_tick(conn);
+    return true;
+}
+
 flib_netconn *flib_netconn_create(const char *playerName, const char *dataDirPath, const char *host, int port) {
     flib_netconn *result = NULL;
     if(!log_badargs_if4(playerName==NULL, host==NULL, port<1, port>65535)) {
@@ -46,8 +56,12 @@ flib_netconn *flib_netconn_create(const char *playerName, const char *dataDirPat
             newConn->map = flib_map_create_named("", "NoSuchMap");
             newConn->pendingTeamlist.teamCount = 0;
             newConn->pendingTeamlist.teams = NULL;
+            newConn->pendingTeamlist.teamCapacity = 0;
+            newConn->pendingTeamlist.nameIndex = flib_nameindex_create();
             newConn->teamlist.teamCount = 0;
             newConn->teamlist.teams = NULL;
+            newConn->teamlist.teamCapacity = 0;
+            newConn->teamlist.nameIndex = flib_nameindex_create();
             newConn->scheme = NULL;
             newConn->style = NULL;
             newConn->weaponset = NULL;
@@ -55,7 +69,9 @@ flib_netconn *flib_netconn_create(const char *playerName, const char *dataDirPat
             newConn->running = false;
             newConn->destroyRequested = false;
             netconn_clearCallbacks(newConn);
-            if(newConn->netBase && newConn->playerName && newConn->dataDirPath && newConn->map) {
+            if(newConn->netBase && newConn->playerName && newConn->dataDirPath && newConn->map
+                    && newConn->pendingTeamlist.nameIndex && newConn->teamlist.nameIndex
+                    && !flib_eventloop_register(newConn, eventloopTick)) {
                 result = newConn;
                 newConn = NULL;
             }
@@ -76,6 +92,7 @@ void flib_netconn_destroy(flib_netconn *conn) {
             netconn_clearCallbacks(conn);
             conn->destroyRequested = true;
         } else {
+            flib_eventloop_unregister(conn);
             flib_netbase_destroy(conn->netBase);
             free(conn->playerName);
             free(conn->dataDirPath);
@@ -83,6 +100,8 @@ void flib_netconn_destroy(flib_netconn *conn) {
             flib_map_destroy(conn->map);
             flib_teamlist_clear(&conn->pendingTeamlist);
             flib_teamlist_clear(&conn->teamlist);
+            flib_nameindex_destroy(conn->pendingTeamlist.nameIndex);
+            flib_nameindex_destroy(conn->teamlist.nameIndex);
             flib_scheme_destroy(conn->scheme);
             free(conn->style);
             flib_weaponset_destroy(conn->weaponset);
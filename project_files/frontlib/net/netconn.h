@@ -27,7 +27,8 @@
  * callbacks.
  *
  * In order to allow the netconn to run, you should regularly call flib_netconn_tick(), which
- * performs network I/O and calls your callbacks on interesting events.
+ * performs network I/O and calls your callbacks on interesting events. Alternatively, call
+ * flib_run_until() to run all open connections at once.
  *
  * When the connection is closed, you will receive the onDisconnect callback. This is the signal to
  * destroy the netconn and stop calling tick().
@@ -20,6 +20,7 @@
 #include "socket.h"
 #include "util/logging.h"
 #include "util/util.h"
+#include "util/list.h"
 #include <stdlib.h>
 #include <SDL_net.h>
 #include <time.h>
@@ -32,8 +33,43 @@ struct _flib_tcpsocket {
 struct _flib_acceptor {
     TCPsocket sock;
     uint16_t port;
+    bool waiting;       //!< Part of the flib_socket_wait set
 };
 
+/*
+ * All open sockets and acceptors, so that flib_socket_wait can wait for any of them at once.
+ * The SDL_net socket set for the wait is only rebuilt after this list changed.
+ */
+static TCPsocket *openSockets;
+static int openSocketCount;
+static int openSocketCapacity;
+static SDLNet_SocketSet waitSet;
+static bool waitSetStale;
+
+GENERATE_STATIC_LIST_INSERT(insertOpenSocket, TCPsocket)
+GENERATE_STATIC_LIST_DELETE(deleteOpenSocket, TCPsocket)
+
+static void trackSocket(TCPsocket sock) {
+    if(insertOpenSocket(&openSockets, &openSocketCount, &openSocketCapacity, sock, openSocketCount)) {
+        flib_log_w("flib_socket_wait will not wake up for a new socket.");
+    }
+    waitSetStale = true;
+}
+
+static void untrackSocket(TCPsocket sock) {
+    for(int i=0; i<openSocketCount; i++) {
+        if(openSockets[i] == sock) {
+            deleteOpenSocket(&openSockets, &openSocketCount, &openSocketCapacity, i);
+            break;
+        }
+    }
+    if(openSocketCount==0 && waitSet) {
+        SDLNet_FreeSocketSet(waitSet);
+        waitSet = NULL;
+    }
+    waitSetStale = true;
+}
+
 static uint32_t getPeerIp(TCPsocket sock) {
     IPaddress *addr = SDLNet_TCP_GetPeerAddress(sock);
     return SDLNet_Read32(&addr->host);
@@ -56,6 +92,7 @@ static flib_tcpsocket *createSocket(TCPsocket sdlsock) {
             result = NULL;
         } else {
             SDLNet_AddSocket(result->sockset, (SDLNet_GenericSocket)result->sock);
+            trackSocket(result->sock);
         }
     }
     return result;
@@ -92,6 +129,9 @@ flib_acceptor *flib_acceptor_create(uint16_t port) {
             flib_log_e("Failed to create acceptor.");
             free(result);
             result = NULL;
+        } else {
+            trackSocket(result->sock);
+            result->waiting = true;
         }
     }
     return result;
@@ -105,8 +145,23 @@ uint16_t flib_acceptor_listenport(flib_acceptor *acceptor) {
     return acceptor->port;
 }
 
+void flib_acceptor_setWaiting(flib_acceptor *acceptor, bool waiting) {
+    if(!acceptor) {
+        flib_log_e("Call to flib_acceptor_setWaiting with acceptor==null");
+    } else if(waiting && !acceptor->waiting) {
+        trackSocket(acceptor->sock);
+        acceptor->waiting = true;
+    } else if(!waiting && acceptor->waiting) {
+        untrackSocket(acceptor->sock);
+        acceptor->waiting = false;
+    }
+}
+
 void flib_acceptor_close(flib_acceptor *acceptor) {
     if(acceptor) {
+        if(acceptor->waiting) {
+            untrackSocket(acceptor->sock);
+        }
         SDLNet_TCP_Close(acceptor->sock);
         free(acceptor);
     }
@@ -158,6 +213,7 @@ flib_tcpsocket *flib_socket_connect(const char *host, uint16_t port) {
 
 void flib_socket_close(flib_tcpsocket *sock) {
     if(sock) {
+        untrackSocket(sock->sock);
         SDLNet_DelSocket(sock->sockset, (SDLNet_GenericSocket)sock->sock);
         SDLNet_TCP_Close(sock->sock);
         SDLNet_FreeSocketSet(sock->sockset);
@@ -189,3 +245,31 @@ int flib_socket_send(flib_tcpsocket *sock, const void *data, int len) {
     }
     return SDLNet_TCP_Send(sock->sock, data, len);
 }
+
+int flib_socket_wait(uint32_t timeout) {
+    if(waitSetStale) {
+        if(waitSet) {
+            SDLNet_FreeSocketSet(waitSet);
+            waitSet = NULL;
+        }
+        if(openSocketCount>0) {
+            waitSet = SDLNet_AllocSocketSet(openSocketCount);
+            if(!waitSet) {
+                flib_log_e("Can't allocate socket set: %s", SDLNet_GetError());
+                return -1;
+            }
+            for(int i=0; i<openSocketCount; i++) {
+                SDLNet_AddSocket(waitSet, (SDLNet_GenericSocket)openSockets[i]);
+            }
+        }
+        waitSetStale = false;
+    }
+    if(!waitSet) {
+        return 0;
+    }
+    int readySockets = SDLNet_CheckSockets(waitSet, timeout);
+    if(readySockets<0) {
+        flib_log_e("Error in select system call: %s", SDLNet_GetError());
+    }
+    return readySockets;
+}
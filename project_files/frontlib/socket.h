@@ -25,7 +25,8 @@
  * on a random unused port, if one can be found. To support this feature, you can also
  * query the local port that an acceptor is listening on.
  *
- * Further, we support nonblocking reads here.
+ * Further, we support nonblocking reads here, and waiting for activity on all open
+ * sockets and acceptors at once.
  */
 
 #ifndef SOCKET_H_
@@ -56,6 +57,13 @@ uint16_t flib_acceptor_listenport(flib_acceptor *acceptor);
  */
 void flib_acceptor_close(flib_acceptor *acceptor);
 
+/**
+ * Choose whether flib_socket_wait wakes up for connections waiting on this acceptor, which
+ * it does by default. Turn it off while nothing will be accepted anyway, otherwise a pending
+ * connection makes every wait return immediately.
+ */
+void flib_acceptor_setWaiting(flib_acceptor *acceptor, bool waiting);
+
 /**
  * Try to accept a connection from an acceptor (listening socket).
  * if localOnly is true, this will only accept connections which came from 127.0.0.1
@@ -88,4 +96,12 @@ int flib_socket_nbrecv(flib_tcpsocket *sock, void *data, int maxlen);
  */
 int flib_socket_send(flib_tcpsocket *sock, const void *data, int len);
 
+/**
+ * Block until any open socket has data to read (or was closed), any acceptor has a
+ * connection waiting, or the timeout (in milliseconds) has passed.
+ * Returns the number of ready sockets, 0 on timeout or if nothing is open, or a
+ * negative value on error.
+ */
+int flib_socket_wait(uint32_t timeout);
+
 #endif /* SOCKET_H_ */
@@ -30,23 +30,61 @@
 #include "util.h"
 #include "logging.h"
 
+/**
+ * Capacity a list is given when the first element is inserted.
+ */
+#define LIST_MIN_CAPACITY 8
+
+/**
+ * Generate a static function that makes sure a heap array of the given type has room for at
+ * least minCapacity elements, so that that many elements can be inserted without reallocating.
+ * The function takes a pointer to the array variable and a pointer to the capacity variable
+ * because both can be changed by this operation (realloc).
+ * The function returns 0 on success and leaves the array unchanged on error.
+ */
+#define GENERATE_STATIC_LIST_RESERVE(fname, type) \
+    static int fname(type **listPtr, int *listCapacityPtr, int minCapacity) { \
+        int result = -1; \
+        if(!log_badargs_if3(listPtr==NULL, listCapacityPtr==NULL, minCapacity < 0)) { \
+            if(minCapacity <= *listCapacityPtr) { \
+                result = 0; \
+            } else { \
+                type *newList = flib_realloc(*listPtr, ((size_t)minCapacity)*sizeof(type)); \
+                if(newList) { \
+                    *listPtr = newList; \
+                    *listCapacityPtr = minCapacity; \
+                    result = 0; \
+                } \
+            } \
+        } \
+        return result; \
+    }
+
 /**
  * Generate a static function that inserts a new value into a heap array of the given type,
- * using realloc and memmove to increase the capacity and shift existing values.
- * The function takes a pointer to the array variable and a pointer to the size variable
- * because both can be changed by this operation (realloc / increment).
+ * using memmove to shift existing values. When the array is full, its capacity is doubled,
+ * so appending to the end of the list takes amortized constant time.
+ * The function takes pointers to the array, size and capacity variables
+ * because all of them can be changed by this operation (realloc / increment).
  * The function returns 0 on success and leaves the array unchanged on error.
  */
 #define GENERATE_STATIC_LIST_INSERT(fname, type) \
-    static int fname(type **listptr, int *listSizePtr, type element, int pos) { \
+    static int fname(type **listPtr, int *listSizePtr, int *listCapacityPtr, type element, int pos) { \
         int result = -1; \
-        if(!log_badargs_if4(listptr==NULL, listSizePtr==NULL, pos < 0, pos > *listSizePtr)) { \
-            type *newList = flib_realloc(*listptr, ((*listSizePtr)+1)*sizeof(type)); \
-            if(newList) { \
-                memmove(newList + (pos+1), newList + pos, ((*listSizePtr)-pos)*sizeof(type)); \
-                newList[pos] = element; \
+        if(!log_badargs_if5(listPtr==NULL, listSizePtr==NULL, listCapacityPtr==NULL, pos < 0, pos > *listSizePtr)) { \
+            type *list = *listPtr; \
+            if(*listSizePtr == *listCapacityPtr) { \
+                int newCapacity = *listCapacityPtr < LIST_MIN_CAPACITY ? LIST_MIN_CAPACITY : 2*(*listCapacityPtr); \
+                list = flib_realloc(*listPtr, ((size_t)newCapacity)*sizeof(type)); \
+                if(list) { \
+                    *listPtr = list; \
+                    *listCapacityPtr = newCapacity; \
+                } \
+            } \
+            if(list) { \
+                memmove(list + (pos+1), list + pos, ((*listSizePtr)-pos)*sizeof(type)); \
+                list[pos] = element; \
                 (*listSizePtr)++; \
-                *listptr = newList; \
                 result = 0; \
             } \
         } \
@@ -55,23 +93,31 @@
 
 /**
  * Generate a static function that deletes a value from a heap array of the given type,
- * using realloc and memmove to decrease the capacity and shift existing values.
- * The function takes a pointer to the array variable and a pointer to the size variable
- * because both can be changed by this operation (realloc / decrement).
+ * using memmove to shift existing values. The capacity is halved once the array is only a
+ * quarter full, and the array is freed when it becomes empty.
+ * The function takes pointers to the array, size and capacity variables
+ * because all of them can be changed by this operation (realloc / decrement).
  * The function returns 0 on success and leaves the array unchanged on error.
  */
 #define GENERATE_STATIC_LIST_DELETE(fname, type) \
-    static int fname(type **listPtr, int *listSizePtr, int pos) { \
+    static int fname(type **listPtr, int *listSizePtr, int *listCapacityPtr, int pos) { \
         int result = -1; \
-        if(!log_badargs_if4(listPtr==NULL, listSizePtr==NULL, pos < 0, pos >= *listSizePtr)) { \
+        if(!log_badargs_if5(listPtr==NULL, listSizePtr==NULL, listCapacityPtr==NULL, pos < 0, pos >= *listSizePtr)) { \
             memmove((*listPtr) + pos, (*listPtr) + (pos+1), ((*listSizePtr)-(pos+1))*sizeof(type)); \
             (*listSizePtr)--; \
             \
-            size_t newCharSize = (*listSizePtr)*sizeof(type); \
-            type *newList = flib_realloc((*listPtr), newCharSize); \
-            if(newList || newCharSize==0) { \
-                (*listPtr) = newList; \
-            } /* If the realloc fails, just keep using the old buffer...*/ \
+            if(*listSizePtr == 0) { \
+                free(*listPtr); \
+                *listPtr = NULL; \
+                *listCapacityPtr = 0; \
+            } else if(*listCapacityPtr > LIST_MIN_CAPACITY && *listSizePtr <= (*listCapacityPtr)/4) { \
+                int newCapacity = (*listCapacityPtr)/2; \
+                type *newList = flib_realloc(*listPtr, ((size_t)newCapacity)*sizeof(type)); \
+                if(newList) { \
+                    *listPtr = newList; \
+                    *listCapacityPtr = newCapacity; \
+                } /* If the realloc fails, just keep using the old buffer...*/ \
+            } \
             result = 0; \
         } \
         return result; \
@@ -0,0 +1,193 @@
+/*
+ * Hedgewars, a free turn based strategy game
+ * Copyright (C) 2012 Simeon Maxein <smaxein@googlemail.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "nameindex.h"
+#include "logging.h"
+#include "util.h"
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MIN_INDEX_SIZE 16
+
+typedef struct {
+    char *name;     //!< NULL if the slot is free
+    uint32_t hash;
+    int pos;
+} nameslot;
+
+/**
+ * Open addressing hash table with linear probing. The table is kept at most half full.
+ */
+struct _flib_nameindex {
+    nameslot *slots;
+    int size;       //!< Number of slots, a power of two
+    int count;      //!< Number of names, equal to the size of the list
+};
+
+uint32_t flib_namehash(const char *name) {
+    uint32_t hash = 2166136261u;
+    for(const char *c=name; *c; c++) {
+        hash = (hash ^ (uint8_t)*c) * 16777619u;
+    }
+    return hash;
+}
+
+flib_nameindex *flib_nameindex_create() {
+    flib_nameindex *result = NULL;
+    flib_nameindex *tmpIndex = flib_calloc(1, sizeof(flib_nameindex));
+    if(tmpIndex) {
+        tmpIndex->slots = flib_calloc(MIN_INDEX_SIZE, sizeof(nameslot));
+        if(tmpIndex->slots) {
+            tmpIndex->size = MIN_INDEX_SIZE;
+            result = tmpIndex;
+            tmpIndex = NULL;
+        }
+    }
+    flib_nameindex_destroy(tmpIndex);
+    return result;
+}
+
+void flib_nameindex_destroy(flib_nameindex *index) {
+    if(index) {
+        flib_nameindex_clear(index);
+        free(index->slots);
+        free(index);
+    }
+}
+
+static void putSlot(nameslot *slots, int size, nameslot slot) {
+    uint32_t i = slot.hash & (size-1);
+    while(slots[i].name) {
+        i = (i+1) & (size-1);
+    }
+    slots[i] = slot;
+}
+
+static int setSize(flib_nameindex *index, int newSize) {
+    nameslot *newSlots = flib_calloc(newSize, sizeof(nameslot));
+    if(!newSlots) {
+        return -1;
+    }
+    for(int i=0; i<index->size; i++) {
+        if(index->slots[i].name) {
+            putSlot(newSlots, newSize, index->slots[i]);
+        }
+    }
+    free(index->slots);
+    index->slots = newSlots;
+    index->size = newSize;
+    return 0;
+}
+
+int flib_nameindex_insert(flib_nameindex *index, const char *name, int pos) {
+    if(log_badargs_if3(index==NULL, pos<0, pos>(index ? index->count : 0))) {
+        return -1;
+    }
+    nameslot slot;
+    slot.name = flib_strdupnull(name ? name : "");
+    if(!slot.name || (2*(index->count+1) > index->size && setSize(index, 2*index->size))) {
+        free(slot.name);
+        return -1;
+    }
+    slot.hash = flib_namehash(slot.name);
+    slot.pos = pos;
+    // Appending is the common case, and doesn't move anything.
+    if(pos < index->count) {
+        for(int i=0; i<index->size; i++) {
+            if(index->slots[i].name && index->slots[i].pos >= pos) {
+                index->slots[i].pos++;
+            }
+        }
+    }
+    putSlot(index->slots, index->size, slot);
+    index->count++;
+    return 0;
+}
+
+/**
+ * Free slot i and move later slots of the same probe sequence into the gap, so that
+ * lookups don't stop early at it.
+ */
+static void removeSlot(flib_nameindex *index, uint32_t i) {
+    uint32_t mask = index->size-1;
+    free(index->slots[i].name);
+    index->slots[i].name = NULL;
+    for(uint32_t j=(i+1)&mask; index->slots[j].name; j=(j+1)&mask) {
+        uint32_t home = index->slots[j].hash & mask;
+        // slot j may move to i unless its home position lies cyclically in (i, j]
+        bool stays = i<=j ? (i<home && home<=j) : (i<home || home<=j);
+        if(!stays) {
+            index->slots[i] = index->slots[j];
+            index->slots[j].name = NULL;
+            i = j;
+        }
+    }
+}
+
+int flib_nameindex_delete(flib_nameindex *index, int pos) {
+    if(log_badargs_if3(index==NULL, pos<0, pos>=(index ? index->count : 0))) {
+        return -1;
+    }
+    // The name at pos is not used to find its slot, so that renamed list entries
+    // can still be removed.
+    for(int i=0; i<index->size; i++) {
+        if(index->slots[i].name && index->slots[i].pos == pos) {
+            removeSlot(index, i);
+            break;
+        }
+    }
+    index->count--;
+    if(pos < index->count) {
+        for(int i=0; i<index->size; i++) {
+            if(index->slots[i].name && index->slots[i].pos > pos) {
+                index->slots[i].pos--;
+            }
+        }
+    }
+    if(index->size > MIN_INDEX_SIZE && 8*index->count < index->size) {
+        setSize(index, index->size/2);  // keep the larger table if this fails
+    }
+    return 0;
+}
+
+void flib_nameindex_clear(flib_nameindex *index) {
+    if(!log_badargs_if(index==NULL)) {
+        for(int i=0; i<index->size; i++) {
+            free(index->slots[i].name);
+            index->slots[i].name = NULL;
+        }
+        index->count = 0;
+    }
+}
+
+int flib_nameindex_find(const flib_nameindex *index, const char *name) {
+    int result = -1;
+    if(!log_badargs_if2(index==NULL, name==NULL)) {
+        uint32_t mask = index->size-1;
+        // names can occur more than once, so look at all of them
+        for(uint32_t i=flib_namehash(name)&mask; index->slots[i].name; i=(i+1)&mask) {
+            if((result<0 || index->slots[i].pos<result) && !strcmp(index->slots[i].name, name)) {
+                result = index->slots[i].pos;
+            }
+        }
+    }
+    return result;
+}
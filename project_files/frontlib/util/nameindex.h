@@ -0,0 +1,72 @@
+/*
+ * Hedgewars, a free turn based strategy game
+ * Copyright (C) 2012 Simeon Maxein <smaxein@googlemail.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+/**
+ * Hash index from names to positions in a list, so that the teams or schemes of a list can be
+ * found by name without comparing all of their names. The functions that insert into and
+ * delete from the list have to update the index in the same way.
+ */
+
+#ifndef NAMEINDEX_H_
+#define NAMEINDEX_H_
+
+#include <stdint.h>
+
+typedef struct _flib_nameindex flib_nameindex;
+
+/**
+ * Hash function used for names (FNV-1a).
+ */
+uint32_t flib_namehash(const char *name);
+
+/**
+ * Create a new, empty index. Needs to be destroyed again later with flib_nameindex_destroy.
+ * May return NULL if memory runs out.
+ */
+flib_nameindex *flib_nameindex_create();
+
+/**
+ * Free the memory of this index
+ */
+void flib_nameindex_destroy(flib_nameindex *index);
+
+/**
+ * Add a name at position pos, moving the names at pos and after it back by one position,
+ * just like inserting into the list. The index keeps a copy of the name.
+ * The index remains unchanged if this fails. Returns 0 on success.
+ */
+int flib_nameindex_insert(flib_nameindex *index, const char *name, int pos);
+
+/**
+ * Remove the name at position pos, moving the names after it forward by one position.
+ * Returns 0 on success.
+ */
+int flib_nameindex_delete(flib_nameindex *index, int pos);
+
+/**
+ * Remove all names.
+ */
+void flib_nameindex_clear(flib_nameindex *index);
+
+/**
+ * Returns the first position with this name, or -1 if there is none.
+ */
+int flib_nameindex_find(const flib_nameindex *index, const char *name);
+
+#endif /* NAMEINDEX_H_ */
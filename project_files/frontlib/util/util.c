@@ -39,7 +39,10 @@ char *flib_asprintf(const char *fmt, ...) {
 char *flib_vasprintf(const char *fmt, va_list args) {
     char *result = NULL;
     if(!log_badargs_if(fmt==NULL)) {
-        int requiredSize = vsnprintf(NULL, 0, fmt, args)+1;                 // Figure out how much memory we need,
+        va_list argsCopy;                                                   // args can only be used once
+        va_copy(argsCopy, args);
+        int requiredSize = vsnprintf(NULL, 0, fmt, argsCopy)+1;             // Figure out how much memory we need,
+        va_end(argsCopy);
         if(!log_e_if(requiredSize<0, "Error formatting string with template \"%s\"", fmt)) {
             char *tmpbuf = flib_malloc(requiredSize);                       // allocate it
             if(tmpbuf && vsnprintf(tmpbuf, requiredSize, fmt, args)>=0) {   // and then do the actual formatting.
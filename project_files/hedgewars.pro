@@ -77,6 +77,7 @@ HEADERS += ../QTfrontend/model/ThemeModel.h \
     ../QTfrontend/net/newnetclient.h \
     ../QTfrontend/net/netudpserver.h \
     ../QTfrontend/net/hwmap.h \
+    ../QTfrontend/util/MapPreviewCache.h \
     ../QTfrontend/util/namegen.h \
     ../QTfrontend/ui/page/AbstractPage.h \
     ../QTfrontend/drawmapscene.h \
@@ -94,12 +95,14 @@ HEADERS += ../QTfrontend/model/ThemeModel.h \
     ../QTfrontend/ui/mouseoverfilter.h \
     ../QTfrontend/ui/widget/qpushbuttonwithsound.h \
     ../QTfrontend/model/roomslistmodel.h \
+    ../QTfrontend/model/RoomsFilterProxyModel.h \
     ../QTfrontend/ui/dialog/input_password.h \
     ../QTfrontend/ui/widget/colorwidget.h \
     ../QTfrontend/model/HatModel.h \
     ../QTfrontend/model/GameStyleModel.h \
     ../QTfrontend/ui/page/pagevideos.h \
     ../QTfrontend/net/recorder.h \
+    ../QTfrontend/net/recorderscheduler.h \
     ../QTfrontend/ui/dialog/ask_quit.h \
     ../QTfrontend/ui/dialog/upload_video.h \
     ../QTfrontend/campaign.h \
@@ -175,6 +178,7 @@ SOURCES += ../QTfrontend/model/gameSchemeModel.cpp \
     ../QTfrontend/net/netregister.cpp \
     ../QTfrontend/net/proto.cpp \
     ../QTfrontend/net/hwmap.cpp \
+    ../QTfrontend/util/MapPreviewCache.cpp \
     ../QTfrontend/net/netudpserver.cpp \
     ../QTfrontend/net/newnetclient.cpp \
     ../QTfrontend/net/netudpwidget.cpp \
@@ -196,6 +200,7 @@ SOURCES += ../QTfrontend/model/gameSchemeModel.cpp \
     ../QTfrontend/ui/mouseoverfilter.cpp \
     ../QTfrontend/ui/widget/qpushbuttonwithsound.cpp \
     ../QTfrontend/model/roomslistmodel.cpp \
+    ../QTfrontend/model/RoomsFilterProxyModel.cpp \
     ../QTfrontend/ui/dialog/input_password.cpp \
     ../QTfrontend/ui/widget/colorwidget.cpp \
     ../QTfrontend/ui/widget/hatbutton.cpp \
@@ -204,6 +209,7 @@ SOURCES += ../QTfrontend/model/gameSchemeModel.cpp \
     ../QTfrontend/model/GameStyleModel.cpp \
     ../QTfrontend/ui/page/pagevideos.cpp \
     ../QTfrontend/net/recorder.cpp \
+    ../QTfrontend/net/recorderscheduler.cpp \
     ../QTfrontend/ui/dialog/ask_quit.cpp \
     ../QTfrontend/ui/dialog/upload_video.cpp \
     ../QTfrontend/campaign.cpp \
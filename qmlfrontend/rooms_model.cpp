@@ -59,7 +59,7 @@ int RoomsListModel::rowCount(const QModelIndex &parent) const {
   if (parent.isValid())
     return 0;
   else
-    return m_data.size();
+    return m_rooms.size();
 }
 
 int RoomsListModel::columnCount(const QModelIndex &parent) const {
@@ -77,7 +77,7 @@ QVariant RoomsListModel::data(const QModelIndex &index, int role) const {
   if (!index.isValid()) return QVariant();
 
   // invalid row
-  if ((row < 0) || (row >= m_data.size())) return QVariant();
+  if ((row < 0) || (row >= m_rooms.size())) return QVariant();
 
   // invalid column
   if ((column < 0) || (column >= c_nColumns)) return QVariant();
@@ -102,7 +102,7 @@ QVariant RoomsListModel::data(const QModelIndex &index, int role) const {
     const QIcon roomWaitingIconGreen(":/res/iconTimeLockG.png");
     const QIcon roomWaitingIconRed(":/res/iconTimeLockR.png");
 
-    QString flags = m_data.at(row).at(StateColumn);
+    const QString &flags = m_rooms.at(rowToPos(row)).flags;
 
     if (flags.contains("g")) {
       if (flags.contains("j"))
@@ -121,7 +121,7 @@ QVariant RoomsListModel::data(const QModelIndex &index, int role) const {
     }
   }
 
-  QString content = m_data.at(row).at(column);
+  const QString &content = m_rooms.at(rowToPos(row)).column(column);
 
   if (role == Qt::DisplayRole) {
     // display room names
@@ -166,19 +166,18 @@ QVariant RoomsListModel::data(const QModelIndex &index, int role) const {
 void RoomsListModel::setRoomsList(const QStringList &rooms) {
   beginResetModel();
 
-  m_data.clear();
+  int nRooms = rooms.size() / c_nColumns;
 
-  int nRooms = rooms.size();
+  m_rooms.clear();
+  m_rooms.resize(nRooms);
+  m_roomPos.clear();
+  m_roomPos.reserve(nRooms);
 
-  for (int i = 0; i < nRooms; i += c_nColumns) {
-    QStringList l;
-    l.reserve(c_nColumns);
-
-    for (int t = 0; t < c_nColumns; t++) {
-      l.append(rooms[i + t]);
-    }
-
-    m_data.append(l);
+  // the server lists rooms newest first
+  for (int row = 0; row < nRooms; ++row) {
+    int pos = rowToPos(row);
+    m_rooms[pos].set(rooms, row * c_nColumns);
+    m_roomPos.insert(m_rooms[pos].name, pos);
   }
 
   endResetModel();
@@ -187,45 +186,89 @@ void RoomsListModel::setRoomsList(const QStringList &rooms) {
 void RoomsListModel::addRoom(const QStringList &info) {
   beginInsertRows(QModelIndex(), 0, 0);
 
-  m_data.prepend(info);
+  Room room;
+  room.set(info);
+  m_roomPos.insert(room.name, m_rooms.size());
+  m_rooms.append(room);
 
   endInsertRows();
 }
 
 int RoomsListModel::rowOfRoom(const QString &name) {
-  int size = m_data.size();
-
-  if (size < 1) return -1;
+  int pos = m_roomPos.value(name, -1);
 
-  int i = 0;
+  if (pos < 0) return -1;
 
-  // search for record with matching room name
-  while (m_data[i].at(NameColumn) != name) {
-    i++;
-    if (i >= size) return -1;
-  }
-
-  return i;
+  return posToRow(pos);
 }
 
 void RoomsListModel::removeRoom(const QString &name) {
-  int i = rowOfRoom(name);
+  int pos = m_roomPos.value(name, -1);
 
-  if (i < 0) return;
+  if (pos < 0) return;
+
+  int i = posToRow(pos);
 
   beginRemoveRows(QModelIndex(), i, i);
 
-  m_data.removeAt(i);
+  m_roomPos.remove(name);
+  m_rooms.remove(pos);
+
+  // only rooms newer than the removed one move
+  for (int p = pos; p < m_rooms.size(); ++p) m_roomPos[m_rooms[p].name] = p;
 
   endRemoveRows();
 }
 
 void RoomsListModel::updateRoom(const QString &name, const QStringList &info) {
-  int i = rowOfRoom(name);
+  int pos = m_roomPos.value(name, -1);
 
-  if (i < 0) return;
+  if (pos < 0) return;
 
-  m_data[i] = info;
+  Room &room = m_rooms[pos];
+  room.set(info);
 
-  emit dataChanged(index(i, 0), index(i, columnCount(QModelIndex()) - 1));
+  // room might have been renamed
+  if (room.name != name) {
+    m_roomPos.remove(name);
+    m_roomPos.insert(room.name, pos);
+  }
+
+  int i = posToRow(pos);
+  emit dataChanged(index(i, 0), index(i, c_nColumns - 1));
+}
+
+void RoomsListModel::Room::set(const QStringList &info, int offset) {
+  flags = info[offset + StateColumn];
+  name = info[offset + NameColumn];
+  clients = info[offset + PlayerCountColumn];
+  teams = info[offset + TeamCountColumn];
+  owner = info[offset + OwnerColumn];
+  map = info[offset + MapColumn];
+  script = info[offset + ScriptColumn];
+  scheme = info[offset + SchemeColumn];
+  weapons = info[offset + WeaponsColumn];
+}
+
+const QString &RoomsListModel::Room::column(int column) const {
+  switch (column) {
+    case StateColumn:
+      return flags;
+    case NameColumn:
+      return name;
+    case PlayerCountColumn:
+      return clients;
+    case TeamCountColumn:
+      return teams;
+    case OwnerColumn:
+      return owner;
+    case MapColumn:
+      return map;
+    case ScriptColumn:
+      return script;
+    case SchemeColumn:
+      return scheme;
+    default:
+      return weapons;
+  }
 }
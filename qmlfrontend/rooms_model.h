@@ -25,7 +25,9 @@
 #define HEDGEWARS_ROOMSLISTMODEL_H
 
 #include <QAbstractTableModel>
+#include <QHash>
 #include <QStringList>
+#include <QVector>
 
 class RoomsListModel : public QAbstractTableModel {
   Q_OBJECT
@@ -39,6 +41,7 @@ class RoomsListModel : public QAbstractTableModel {
     TeamCountColumn,
     OwnerColumn,
     MapColumn,
+    ScriptColumn,
     SchemeColumn,
     WeaponsColumn
   };
@@ -59,9 +62,31 @@ class RoomsListModel : public QAbstractTableModel {
   int rowOfRoom(const QString &name);
 
  private:
+  // room record as announced by the server
+  struct Room {
+    QString flags;
+    QString name;
+    QString clients;
+    QString teams;
+    QString owner;
+    QString map;
+    QString script;
+    QString scheme;
+    QString weapons;
+
+    void set(const QStringList &info, int offset = 0);
+    const QString &column(int column) const;
+  };
+
   const int c_nColumns;
-  QList<QStringList> m_data;
+  // rooms are stored oldest first, while row 0 shows the newest one,
+  // so adding a room doesn't shift the stored positions of the others
+  QVector<Room> m_rooms;
+  QHash<QString, int> m_roomPos;  // room name -> position in m_rooms
   QStringList m_headerData;
+
+  int rowToPos(int row) const { return m_rooms.size() - 1 - row; }
+  int posToRow(int pos) const { return m_rooms.size() - 1 - pos; }
   // MapModel * m_staticMapModel;
   // MapModel * m_missionMapModel;
 };
@@ -0,0 +1,132 @@
+/*
+ * Hedgewars, a free turn based strategy game
+ * Copyright (c) 2004-2015 Andrey Korotaev <unC0Rr@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+// Streams files of different lengths through a small audio ring and reads
+// them back in frames whose size doesn't divide the ring size, so that reads
+// wrap around at different offsets and the last one is short. It is meant to
+// be run under ThreadSanitizer as well.
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "audioring.h"
+
+#define READ_SIZE 64
+#define RING_SIZE (4 * READ_SIZE)
+#define SAMPLE_SIZE 4  // 16 bit stereo
+
+static int g_Failures;
+
+static void Check(int Cond, const char* pWhat, int FileSize, int FrameSamples)
+{
+    if (!Cond)
+    {
+        printf("FAIL %i bytes, %i samples a frame: %s\n", FileSize, FrameSamples, pWhat);
+        g_Failures++;
+    }
+}
+
+static uint8_t Pattern(int Pos)
+{
+    // doesn't repeat with the ring size, unlike Pos itself
+    return (uint8_t)(Pos * 7 + Pos / 251);
+}
+
+// Writes FileSize pattern bytes after a header like the one of the sound
+// file, which the ring must skip since it reads from the current position.
+static FILE* CreateFile(int FileSize)
+{
+    FILE* pFile = tmpfile();
+    if (!pFile)
+        return NULL;
+    fwrite("HEADER..", 1, 8, pFile);
+    for (int i = 0; i < FileSize; i++)
+        fputc(Pattern(i), pFile);
+    fseek(pFile, 8, SEEK_SET);
+    return pFile;
+}
+
+static void ReadFile(int FileSize, int FrameSamples)
+{
+    FILE* pFile = CreateFile(FileSize);
+    if (!pFile)
+    {
+        Check(0, "could not create the file", FileSize, FrameSamples);
+        return;
+    }
+    if (AudioRing_Start(pFile, RING_SIZE, READ_SIZE) < 0)
+    {
+        Check(0, "could not start", FileSize, FrameSamples);
+        AudioRing_Stop();
+        fclose(pFile);
+        return;
+    }
+
+    uint8_t Frame[RING_SIZE];
+    int Pos = 0, Ok = 1;
+    for (;;)
+    {
+        int NumSamples = AudioRing_Read(Frame, FrameSamples, SAMPLE_SIZE);
+        for (int i = 0; i < NumSamples*SAMPLE_SIZE; i++)
+            Ok &= Frame[i] == Pattern(Pos + i);
+        Pos += NumSamples*SAMPLE_SIZE;
+        if (NumSamples < FrameSamples)
+            break;
+    }
+    Check(Ok, "wrong data", FileSize, FrameSamples);
+    // a trailing partial sample is dropped
+    Check(Pos == FileSize - FileSize % SAMPLE_SIZE, "wrong length", FileSize, FrameSamples);
+    Check(AudioRing_Read(Frame, FrameSamples, SAMPLE_SIZE) == 0, "data after the end", FileSize, FrameSamples);
+
+    AudioRing_Stop();
+    fclose(pFile);
+}
+
+// The reader must stop while it waits for room in the full ring.
+static void StopEarly(void)
+{
+    int FileSize = 16 * RING_SIZE;
+    FILE* pFile = CreateFile(FileSize);
+    if (!pFile || AudioRing_Start(pFile, RING_SIZE, READ_SIZE) < 0)
+        Check(0, "could not start", FileSize, 0);
+    else
+    {
+        uint8_t Frame[SAMPLE_SIZE];
+        Check(AudioRing_Read(Frame, 1, SAMPLE_SIZE) == 1, "no data", FileSize, 1);
+    }
+    AudioRing_Stop();
+    if (pFile)
+        fclose(pFile);
+}
+
+int main()
+{
+    // empty, shorter than one read, not a whole sample, several times the ring
+    static const int FileSizes[] = { 0, 3, 40, RING_SIZE, 10 * RING_SIZE + 2, 10 * RING_SIZE + 36 };
+    // 7 and 13 samples don't divide the ring, 64 samples fill it at once
+    static const int FrameSamples[] = { 1, 7, 13, 16, RING_SIZE / SAMPLE_SIZE };
+
+    for (size_t i = 0; i < sizeof(FileSizes) / sizeof(FileSizes[0]); i++)
+        for (size_t j = 0; j < sizeof(FrameSamples) / sizeof(FrameSamples[0]); j++)
+            ReadFile(FileSizes[i], FrameSamples[j]);
+    StopEarly();
+
+    printf("audioring: %s\n", g_Failures ? "FAILED" : "passed");
+    return g_Failures ? 1 : 0;
+}
@@ -0,0 +1,80 @@
+/*
+ * Hedgewars, a free turn based strategy game
+ * Copyright (c) 2004-2015 Andrey Korotaev <unC0Rr@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+// Times the RGBA to YUV conversion of whole frames with the scalar and, where
+// the CPU has it, the SSE2 code, in frames per second on one thread. This is
+// not run as a test, start it by hand to compare changes:
+//
+//   bench_avwrapper_yuv [frames]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "yuv.h"
+
+static double Seconds(void)
+{
+    return (double)clock() / CLOCKS_PER_SEC;
+}
+
+static void BenchSize(int Width, int Height, int Frames, int HaveSSE2)
+{
+    uint8_t* pRGB = malloc(Width * Height * 4);
+    int Linesizes[3] = { Width, (Width + 1) / 2, (Width + 1) / 2 };
+    int ChromaHeight = (Height + 1) / 2;
+    uint8_t* pPlanes[3] = {
+        malloc(Linesizes[0] * Height),
+        malloc(Linesizes[1] * ChromaHeight),
+        malloc(Linesizes[2] * ChromaHeight)
+    };
+
+    // noise, so that the result doesn't depend on a flat colour
+    for (int i = 0; i < Width * Height * 4; i++)
+        pRGB[i] = rand() & 0xff;
+
+    for (int UseSSE2 = 0; UseSSE2 <= HaveSSE2; UseSSE2++)
+    {
+        double Start = Seconds();
+        for (int i = 0; i < Frames; i++)
+            YUV_ConvertRows(pRGB, Width, Height, pPlanes, Linesizes, 0, Height, UseSSE2);
+        double Elapsed = Seconds() - Start;
+        printf("%4ix%-5i %-6s %8.3f s  %8.1f fps\n", Width, Height, UseSSE2 ? "SSE2" : "scalar",
+               Elapsed, Elapsed > 0 ? Frames / Elapsed : 0.0);
+    }
+
+    free(pRGB);
+    for (int i = 0; i < 3; i++)
+        free(pPlanes[i]);
+}
+
+int main(int argc, char** argv)
+{
+    static const int Sizes[][2] = { { 640, 360 }, { 1280, 720 }, { 1920, 1080 } };
+    int Frames = argc > 1 ? atoi(argv[1]) : 200;
+    if (Frames <= 0)
+    {
+        fprintf(stderr, "Usage: %s [frames]\n", argv[0]);
+        return 2;
+    }
+
+    srand(1);
+    for (size_t i = 0; i < sizeof(Sizes) / sizeof(Sizes[0]); i++)
+        BenchSize(Sizes[i][0], Sizes[i][1], Frames, YUV_HaveSSE2());
+    return 0;
+}
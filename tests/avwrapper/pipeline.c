@@ -0,0 +1,197 @@
+/*
+ * Hedgewars, a free turn based strategy game
+ * Copyright (c) 2004-2015 Andrey Korotaev <unC0Rr@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+// Runs frames through the conversion pipeline with different numbers of
+// threads and checks that they are written in order and equal the single
+// threaded conversion, and that the queue drains after a write failed.
+// It is meant to be run under ThreadSanitizer as well.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "pipeline.h"
+#include "yuv.h"
+
+#define NUM_FRAMES 24
+#define FAIL_AT 5
+
+typedef struct
+{
+    uint8_t* pPlanes[3];
+} Planes;
+
+static int g_Failures;
+static int g_Width, g_Height, g_UseSSE2;
+static int g_Linesizes[3];
+static uint8_t* g_pInputs[NUM_FRAMES];
+static Planes g_Expected[NUM_FRAMES];
+
+// only touched by the encoder thread while the pipeline runs
+static int g_Written;
+static int g_FailAt;
+static Planes g_Spare;
+
+static void Check(int Cond, const char* pWhat, int Frame)
+{
+    if (!Cond)
+    {
+        printf("FAIL %ix%i, frame %i: %s\n", g_Width, g_Height, Frame, pWhat);
+        g_Failures++;
+    }
+}
+
+static void AllocPlanes(Planes* pPlanes)
+{
+    int ChromaHeight = (g_Height + 1) / 2;
+    pPlanes->pPlanes[0] = malloc(g_Linesizes[0] * g_Height);
+    pPlanes->pPlanes[1] = malloc(g_Linesizes[1] * ChromaHeight);
+    pPlanes->pPlanes[2] = malloc(g_Linesizes[2] * ChromaHeight);
+}
+
+static void FreePlanes(Planes* pPlanes)
+{
+    for (int i = 0; i < 3; i++)
+        free(pPlanes->pPlanes[i]);
+}
+
+static int SamePlanes(uint8_t* const pA[3], uint8_t* const pB[3])
+{
+    for (int p = 0; p < 3; p++)
+    {
+        int Width = p ? (g_Width + 1) / 2 : g_Width;
+        int Height = p ? (g_Height + 1) / 2 : g_Height;
+        for (int y = 0; y < Height; y++)
+        {
+            if (memcmp(pA[p] + y * g_Linesizes[p], pB[p] + y * g_Linesizes[p], Width))
+                return 0;
+        }
+    }
+    return 1;
+}
+
+static int WriteTestFrame(PipelineFrame* pFrame)
+{
+    int Frame = g_Written++;
+    if (Frame == g_FailAt)
+        return -1;
+    Check(Frame < NUM_FRAMES && SamePlanes(pFrame->pPlanes, g_Expected[Frame].pPlanes),
+          "differs from the single threaded conversion or out of order", Frame);
+
+    // hand out other planes for the next picture, as a codec holding on to
+    // the frame would
+    Planes Written;
+    memcpy(Written.pPlanes, pFrame->pPlanes, sizeof(Written.pPlanes));
+    memcpy(pFrame->pPlanes, g_Spare.pPlanes, sizeof(g_Spare.pPlanes));
+    g_Spare = Written;
+    return 0;
+}
+
+static void SetSize(int Width, int Height)
+{
+    g_Width = Width;
+    g_Height = Height;
+    g_Linesizes[0] = Width + 32;
+    g_Linesizes[1] = g_Linesizes[2] = (Width + 1) / 2 + 16;
+    for (int i = 0; i < NUM_FRAMES; i++)
+    {
+        g_pInputs[i] = malloc(Width * Height * 4);
+        for (int j = 0; j < Width * Height * 4; j++)
+            g_pInputs[i][j] = rand() & 0xff;
+        AllocPlanes(&g_Expected[i]);
+        YUV_ConvertRows(g_pInputs[i], Width, Height, g_Expected[i].pPlanes, g_Linesizes,
+                        0, Height, g_UseSSE2);
+    }
+}
+
+static void FreeSize()
+{
+    for (int i = 0; i < NUM_FRAMES; i++)
+    {
+        free(g_pInputs[i]);
+        FreePlanes(&g_Expected[i]);
+    }
+}
+
+// Queues all frames, returns the number of them that were accepted.
+static int RunPipeline(int NumThreads, int FailAt)
+{
+    // one set of planes more than there are slots, WriteTestFrame swaps them around
+    Planes Pool[PIPELINE_QUEUE_SIZE + 1];
+    PipelineFrame Frames[PIPELINE_QUEUE_SIZE];
+    for (int i = 0; i <= PIPELINE_QUEUE_SIZE; i++)
+        AllocPlanes(&Pool[i]);
+    for (int i = 0; i < PIPELINE_QUEUE_SIZE; i++)
+    {
+        memcpy(Frames[i].pPlanes, Pool[i].pPlanes, sizeof(Frames[i].pPlanes));
+        memcpy(Frames[i].Linesizes, g_Linesizes, sizeof(g_Linesizes));
+        Frames[i].pUser = NULL;
+    }
+    g_Spare = Pool[PIPELINE_QUEUE_SIZE];
+    g_Written = 0;
+    g_FailAt = FailAt;
+
+    int Queued = 0;
+    Check(Pipeline_Start(g_Width, g_Height, g_UseSSE2, NumThreads, Frames, WriteTestFrame) == 0,
+          "pipeline not started", 0);
+    for (int i = 0; i < NUM_FRAMES; i++)
+    {
+        if (Pipeline_Queue(g_pInputs[i]) == 0)
+            Queued++;
+    }
+    int Stopped = Pipeline_Stop();
+    Pipeline_Free();
+
+    if (FailAt < 0)
+    {
+        Check(Stopped == 0, "pipeline failed", NUM_FRAMES);
+        Check(g_Written == NUM_FRAMES, "frames missing", g_Written);
+    }
+    else
+    {
+        Check(Stopped < 0, "error not reported", FailAt);
+        Check(g_Written == FailAt + 1, "frames written after the error", g_Written);
+    }
+
+    for (int i = 0; i <= PIPELINE_QUEUE_SIZE; i++)
+        FreePlanes(&Pool[i]);
+    return Queued;
+}
+
+int main()
+{
+    static const int Sizes[][2] = { { 33, 17 }, { 64, 2 }, { 640, 360 } };
+    g_UseSSE2 = YUV_HaveSSE2();
+
+    srand(1);
+    for (size_t i = 0; i < sizeof(Sizes) / sizeof(Sizes[0]); i++)
+    {
+        SetSize(Sizes[i][0], Sizes[i][1]);
+        for (int Threads = 1; Threads <= PIPELINE_MAX_THREADS; Threads++)
+        {
+            Check(RunPipeline(Threads, -1) == NUM_FRAMES, "frames not queued", NUM_FRAMES);
+            // the engine must not wait forever for a slot after the error
+            int Queued = RunPipeline(Threads, FAIL_AT);
+            Check(Queued > FAIL_AT && Queued < NUM_FRAMES, "queueing didn't stop after the error", Queued);
+        }
+        FreeSize();
+    }
+
+    printf("pipeline: %s\n", g_Failures ? "FAILED" : "passed");
+    return g_Failures ? 1 : 0;
+}
@@ -0,0 +1,227 @@
+/*
+ * Hedgewars, a free turn based strategy game
+ * Copyright (c) 2004-2015 Andrey Korotaev <unC0Rr@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+// Converts random and extreme frames of different sizes with the SSE2 and the
+// scalar code, which have to agree exactly, and checks that both stay within
+// 1 of the float conversion avwrapper used before.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "yuv.h"
+
+static int g_Failures;
+
+typedef struct
+{
+    int Width, Height;
+    uint8_t* pRGB;
+    uint8_t* pPlanes[3];
+    int Linesizes[3];
+} Frame;
+
+static void AllocFrame(Frame* pFrame, int Width, int Height)
+{
+    pFrame->Width = Width;
+    pFrame->Height = Height;
+    pFrame->pRGB = malloc(Width * Height * 4);
+    // padded lines like libav's, so that writes past the width would show up
+    pFrame->Linesizes[0] = Width + 32;
+    pFrame->Linesizes[1] = pFrame->Linesizes[2] = (Width + 1) / 2 + 16;
+    int ChromaHeight = (Height + 1) / 2;
+    pFrame->pPlanes[0] = malloc(pFrame->Linesizes[0] * Height);
+    pFrame->pPlanes[1] = malloc(pFrame->Linesizes[1] * ChromaHeight);
+    pFrame->pPlanes[2] = malloc(pFrame->Linesizes[2] * ChromaHeight);
+}
+
+static void FreeFrame(Frame* pFrame)
+{
+    free(pFrame->pRGB);
+    for (int i = 0; i < 3; i++)
+        free(pFrame->pPlanes[i]);
+}
+
+static void ClearPlanes(Frame* pFrame, uint8_t Value)
+{
+    memset(pFrame->pPlanes[0], Value, pFrame->Linesizes[0] * pFrame->Height);
+    memset(pFrame->pPlanes[1], Value, pFrame->Linesizes[1] * ((pFrame->Height + 1) / 2));
+    memset(pFrame->pPlanes[2], Value, pFrame->Linesizes[2] * ((pFrame->Height + 1) / 2));
+}
+
+static void Convert(Frame* pFrame, int UseSSE2)
+{
+    YUV_ConvertRows(pFrame->pRGB, pFrame->Width, pFrame->Height,
+                    pFrame->pPlanes, pFrame->Linesizes, 0, pFrame->Height, UseSSE2);
+}
+
+static inline uint8_t ClipUint8(int a)
+{
+    return a < 0 ? 0 : a > 255 ? 255 : a;
+}
+
+// The conversion avwrapper used before the fixed-point code. It reads past
+// the image for odd sizes, so it only runs on even ones.
+static void ConvertFloat(Frame* pFrame)
+{
+    int x, y, stride = pFrame->Width * 4;
+    uint8_t* data[3];
+    const uint8_t* buf = pFrame->pRGB + (pFrame->Height - 1) * stride;
+    memcpy(data, pFrame->pPlanes, sizeof(data));
+
+    for (y = 0; y < pFrame->Height; y++) {
+        for (x = 0; x < pFrame->Width; x++) {
+            int r = buf[x * 4 + 0];
+            int g = buf[x * 4 + 1];
+            int b = buf[x * 4 + 2];
+
+            int luma = (int)(0.299f * r +  0.587f * g + 0.114f * b);
+            data[0][x] = ClipUint8(luma);
+
+            if (!(x & 1) && !(y & 1)) {
+                int r = (buf[x * 4 + 0]          + buf[(x + 1) * 4 + 0] +
+                         buf[x * 4 + 0 - stride] + buf[(x + 1) * 4 + 0 - stride]) / 4;
+                int g = (buf[x * 4 + 1]          + buf[(x + 1) * 4 + 1] +
+                         buf[x * 4 + 1 - stride] + buf[(x + 1) * 4 + 1 - stride]) / 4;
+                int b = (buf[x * 4 + 2]          + buf[(x + 1) * 4 + 2] +
+                         buf[x * 4 + 2 - stride] + buf[(x + 1) * 4 + 2 - stride]) / 4;
+
+                int cr = (int)(-0.14713f * r - 0.28886f * g + 0.436f   * b);
+                int cb = (int)( 0.615f   * r - 0.51499f * g - 0.10001f * b);
+                data[1][x / 2] = ClipUint8(128 + cr);
+                data[2][x / 2] = ClipUint8(128 + cb);
+            }
+        }
+        buf += -stride;
+        data[0] += pFrame->Linesizes[0];
+        if (y & 1) {
+            data[1] += pFrame->Linesizes[1];
+            data[2] += pFrame->Linesizes[2];
+        }
+    }
+}
+
+// Compares the planes including their padding, returns the largest difference.
+static int CompareFrames(const Frame* pA, const Frame* pB)
+{
+    int MaxDiff = 0;
+    int Sizes[3] = {
+        pA->Linesizes[0] * pA->Height,
+        pA->Linesizes[1] * ((pA->Height + 1) / 2),
+        pA->Linesizes[2] * ((pA->Height + 1) / 2)
+    };
+    for (int p = 0; p < 3; p++)
+    {
+        for (int i = 0; i < Sizes[p]; i++)
+        {
+            int Diff = abs(pA->pPlanes[p][i] - pB->pPlanes[p][i]);
+            if (Diff > MaxDiff)
+                MaxDiff = Diff;
+        }
+    }
+    return MaxDiff;
+}
+
+enum { PATTERN_RANDOM, PATTERN_BLACK, PATTERN_WHITE, PATTERN_EXTREMES, PATTERN_COUNT };
+static const char* g_PatternNames[PATTERN_COUNT] = { "random", "black", "white", "extremes" };
+
+static void FillPattern(Frame* pFrame, int Pattern)
+{
+    int Size = pFrame->Width * pFrame->Height * 4;
+    for (int i = 0; i < Size; i++)
+    {
+        switch (Pattern)
+        {
+        case PATTERN_RANDOM:   pFrame->pRGB[i] = rand() & 0xff; break;
+        case PATTERN_BLACK:    pFrame->pRGB[i] = 0; break;
+        case PATTERN_WHITE:    pFrame->pRGB[i] = 255; break;
+        default:               pFrame->pRGB[i] = rand() & 1 ? 255 : 0; break;
+        }
+    }
+}
+
+static void Check(int Cond, const char* pWhat, int Width, int Height, const char* pPattern, int Diff)
+{
+    if (!Cond)
+    {
+        printf("FAIL %s, %ix%i %s: differs by %i\n", pWhat, Width, Height, pPattern, Diff);
+        g_Failures++;
+    }
+}
+
+static void TestSize(int Width, int Height, int HaveSSE2)
+{
+    Frame Scalar, Other;
+    AllocFrame(&Scalar, Width, Height);
+    AllocFrame(&Other, Width, Height);
+
+    for (int Pattern = 0; Pattern < PATTERN_COUNT; Pattern++)
+    {
+        const char* pName = g_PatternNames[Pattern];
+        FillPattern(&Scalar, Pattern);
+        memcpy(Other.pRGB, Scalar.pRGB, Width * Height * 4);
+
+        ClearPlanes(&Scalar, 0x5a);
+        Convert(&Scalar, 0);
+
+        if (HaveSSE2)
+        {
+            ClearPlanes(&Other, 0x5a);
+            Convert(&Other, 1);
+            int Diff = CompareFrames(&Scalar, &Other);
+            Check(Diff == 0, "SSE2 against scalar", Width, Height, pName, Diff);
+        }
+
+        // converting in slices of two rows at a time, as the conversion threads do
+        ClearPlanes(&Other, 0x5a);
+        for (int y = 0; y < Height; y += 2)
+            YUV_ConvertRows(Other.pRGB, Width, Height, Other.pPlanes, Other.Linesizes,
+                            y, y + 2 < Height ? y + 2 : Height, HaveSSE2);
+        int Diff = CompareFrames(&Scalar, &Other);
+        Check(Diff == 0, "slices against whole frame", Width, Height, pName, Diff);
+
+        if (!(Width & 1) && !(Height & 1))
+        {
+            ClearPlanes(&Other, 0x5a);
+            ConvertFloat(&Other);
+            Diff = CompareFrames(&Scalar, &Other);
+            Check(Diff <= 1, "fixed point against float", Width, Height, pName, Diff);
+        }
+    }
+
+    FreeFrame(&Scalar);
+    FreeFrame(&Other);
+}
+
+int main()
+{
+    static const int Sizes[][2] = {
+        { 1, 1 }, { 2, 2 }, { 7, 3 }, { 8, 2 }, { 9, 5 }, { 16, 16 }, { 33, 17 },
+        { 34, 18 }, { 640, 360 }, { 1279, 719 }, { 1920, 1080 }
+    };
+    int HaveSSE2 = YUV_HaveSSE2();
+    printf("SSE2 %s\n", HaveSSE2 ? "available, comparing it with the scalar code" : "not available");
+
+    srand(1);
+    for (size_t i = 0; i < sizeof(Sizes) / sizeof(Sizes[0]); i++)
+        TestSize(Sizes[i][0], Sizes[i][1], HaveSSE2);
+
+    printf("yuv: %s\n", g_Failures ? "FAILED" : "passed");
+    return g_Failures ? 1 : 0;
+}
@@ -0,0 +1,67 @@
+/*
+ * Hedgewars, a free turn based strategy game
+ * Copyright (c) 2004-2015 Andrey Korotaev <unC0Rr@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+// Times adding 10k lines to the chat log of a shown chat widget, each
+// followed by a pass of the event loop like lines arriving from the server.
+// This is not run as a test, start it by hand to compare changes
+// (set QT_QPA_PLATFORM=offscreen when there is no display):
+//
+//   bench_chat [lines]
+
+#include <QApplication>
+#include <QElapsedTimer>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "chatwidget.h"
+#include "playerslistmodel.h"
+
+int main(int argc, char *argv[])
+{
+    QApplication app(argc, argv);
+    int lines = argc > 1 ? atoi(argv[1]) : 10000;
+    if(lines < 1)
+        lines = 1;
+
+    // chat lines are only shown with a players list
+    PlayersListModel players;
+    HWChatWidget chat(0, false);
+    chat.setUsersModel(&players);
+    chat.setUser("bench");
+    chat.resize(800, 600);
+    chat.show();
+    app.processEvents();
+
+    QElapsedTimer timer;
+    timer.start();
+    for(int i = 0; i < lines; ++i)
+    {
+        if(i % 10)
+            chat.onChatMessage(QString("player%1").arg(i % 50),
+                               QString("line %1 of the benchmark, see https://www.hedgewars.org/").arg(i));
+        else
+            chat.onChatAction(QString("player%1").arg(i % 50), "waves");
+        app.processEvents();
+    }
+    qint64 nsecs = timer.nsecsElapsed();
+
+    double elapsed = nsecs / 1e9;
+    printf("%-16s %8.3f s  %12.0f lines/s\n", "chat lines", elapsed, lines / elapsed);
+    return 0;
+}
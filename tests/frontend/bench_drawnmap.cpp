@@ -0,0 +1,114 @@
+/*
+ * Hedgewars, a free turn based strategy game
+ * Copyright (c) 2004-2015 Andrey Korotaev <unC0Rr@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+// Times DrawMapScene::decode() and encode() on a drawn map of 100k points,
+// and HWProto::addDrawnMapToBuffer() on a drawn map of 1 MB.
+// This is not run as a test, start it by hand to compare changes:
+//
+//   bench_drawnmap [rounds]
+
+#include <QApplication>
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "drawmapscene.h"
+#include "net/proto.h"
+#include "randommap.h"
+
+static void report(const char * name, qint64 nsecs, long count, const char * unit)
+{
+    double elapsed = nsecs / 1e9;
+    printf("%-16s %8.3f s  %12.0f %s/s\n", name, elapsed, elapsed > 0 ? count / elapsed : 0.0, unit);
+}
+
+int main(int argc, char *argv[])
+{
+    QApplication app(argc, argv);
+    int rounds = argc > 1 ? atoi(argv[1]) : 10;
+    if(rounds < 1)
+        rounds = 1;
+
+    // strokes of up to 50 points like in a detailed hand drawn map
+    int points;
+    QByteArray data = randomMap(4, 3500, 50, points);
+    while(points < 100000)
+    {
+        int more;
+        data += randomMap(0, 1, 50, more);
+        points += more;
+    }
+    printf("%d points, %d bytes\n", points, data.size());
+
+    DrawMapScene scene;
+    QElapsedTimer timer;
+    qint64 decodeTime = 0;
+    qint64 encodeTime = 0;
+    QByteArray encoded;
+
+    for(int i = 0; i < rounds; ++i)
+    {
+        timer.start();
+        scene.decode(data);
+        decodeTime += timer.nsecsElapsed();
+
+        timer.start();
+        encoded = scene.encode();
+        encodeTime += timer.nsecsElapsed();
+    }
+
+    report("decode", decodeTime, (long)points * rounds, "points");
+    report("encode", encodeTime, (long)points * rounds, "points");
+
+    QByteArray bigMap;
+    while(bigMap.size() < 1024 * 1024)
+    {
+        int more;
+        bigMap += randomMap(0, 1, 50, more);
+    }
+    bigMap.truncate(1024 * 1024);
+
+    qint64 frameTime = 0;
+    QByteArray frames;
+    for(int i = 0; i < rounds; ++i)
+    {
+        frames.clear();
+        timer.start();
+        HWProto::addDrawnMapToBuffer(frames, bigMap);
+        frameTime += timer.nsecsElapsed();
+    }
+
+    report("edraw frames", frameTime, (long)rounds, "maps");
+
+    // keeps the work from being optimized away, and catches a broken build
+    if(encoded.size() != data.size())
+    {
+        printf("encoded %d bytes, expected %d\n", encoded.size(), data.size());
+        return 1;
+    }
+    // a length byte and "edraw " per 200 bytes
+    int framed = bigMap.size() + (bigMap.size() + 199) / 200 * 7;
+    if(frames.size() != framed)
+    {
+        printf("framed %d bytes, expected %d\n", frames.size(), framed);
+        return 1;
+    }
+    return 0;
+}
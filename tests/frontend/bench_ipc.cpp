@@ -0,0 +1,167 @@
+/*
+ * Hedgewars, a free turn based strategy game
+ * Copyright (c) 2004-2015 Andrey Korotaev <unC0Rr@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+// Times how fast TCPBase takes engine messages from a fake engine (see
+// fakeengine.c) streaming a million of them, and the round trip latency of
+// single messages, over a unix domain socket (if built with local IPC) and
+// over TCP.
+// This is not run as a test, start it by hand to compare changes:
+//
+//   bench_ipc [messages] [round trips]
+
+#include <QApplication>
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "enginelink.h"
+
+class StreamReader : public EngineLink
+{
+    public:
+        StreamReader(long count, long & received, qint64 & bytes) :
+            EngineLink(QStringList() << "stream" << QString::number(count)),
+            m_count(count),
+            m_received(received),
+            m_bytes(bytes)
+        {
+            m_received = -1; // the first message is not counted
+            m_bytes = 0;
+        }
+
+    protected:
+        void onClientRead()
+        {
+            QByteArray msg;
+            while(takeMessage(msg))
+            {
+                m_bytes += msg.size();
+                if(m_received++ < 0)
+                    SendIPC("go");
+                else if(m_received == m_count)
+                    SendIPC("!");
+            }
+        }
+
+    private:
+        long m_count;
+        long & m_received;
+        qint64 & m_bytes;
+};
+
+// sends a message and waits for the echo, again and again
+class EchoLink : public EngineLink
+{
+    public:
+        EchoLink(long rounds, long & done, qint64 & nsecs) :
+            EngineLink(QStringList() << "echo"),
+            m_rounds(rounds),
+            m_done(done),
+            m_nsecs(nsecs)
+        {
+            m_done = 0;
+            m_nsecs = 0;
+        }
+
+    protected:
+        void SendToClientFirst()
+        {
+            // the engine's start up is not timed
+            m_timer.start();
+            SendIPC("ping");
+        }
+
+        void onClientRead()
+        {
+            QByteArray msg;
+            while(takeMessage(msg))
+            {
+                if(++m_done < m_rounds)
+                    SendIPC("ping");
+                else
+                {
+                    m_nsecs = m_timer.nsecsElapsed();
+                    SendIPC("!");
+                }
+            }
+        }
+
+    private:
+        long m_rounds;
+        long & m_done;
+        qint64 & m_nsecs;
+        QElapsedTimer m_timer;
+};
+
+static void latency(const char * name, long rounds)
+{
+    long done;
+    qint64 nsecs;
+
+    EchoLink * link = new EchoLink(rounds, done, nsecs);
+    link->start(true);
+    if(!EngineLink::run(link, 600000) || done != rounds)
+    {
+        printf("%-16s %ld of %ld round trips\n", name, done, rounds);
+        return;
+    }
+    printf("%-16s %8.3f s  %12.1f us/round trip\n", name, nsecs / 1e9, nsecs / 1e3 / rounds);
+}
+
+static void stream(const char * name, long count)
+{
+    long received;
+    qint64 bytes;
+    QElapsedTimer timer;
+
+    StreamReader * reader = new StreamReader(count, received, bytes);
+    timer.start();
+    reader->start(true);
+    bool done = EngineLink::run(reader, 600000);
+    double elapsed = timer.nsecsElapsed() / 1e9;
+
+    if(!done || received != count)
+    {
+        printf("%-16s %ld of %ld messages received\n", name, received, count);
+        return;
+    }
+    printf("%-16s %8.3f s  %12.0f messages/s  %8.1f MB/s\n", name, elapsed,
+           count / elapsed, bytes / elapsed / (1024 * 1024));
+}
+
+int main(int argc, char *argv[])
+{
+    QApplication app(argc, argv);
+    long count = argc > 1 ? atol(argv[1]) : 1000000;
+    long rounds = argc > 2 ? atol(argv[2]) : 20000;
+    if(count < 1)
+        count = 1;
+    if(rounds < 1)
+        rounds = 1;
+
+#ifdef HW_LOCAL_IPC
+    stream("unix stream", count);
+    latency("unix latency", rounds);
+    qputenv("HEDGEWARS_IPC", "tcp");
+#endif
+    stream("tcp stream", count);
+    latency("tcp latency", rounds);
+    return 0;
+}
@@ -0,0 +1,201 @@
+/*
+ * Hedgewars, a free turn based strategy game
+ * Copyright (c) 2004-2015 Andrey Korotaev <unC0Rr@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+// Replays a synthetic lobby session to HWNewNet over a local connection and
+// times how fast it parses the server messages and applies them to the rooms
+// and players lists: a busy lobby of 500 players and 200 rooms with chat,
+// room updates, players coming and going and rooms being opened and closed.
+// This is not run as a test, start it by hand to compare changes:
+//
+//   bench_lobby [rounds]
+
+#include <QApplication>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTimer>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "hwconsts.h"
+#include "newnetclient.h"
+
+#define PLAYERS 500
+#define ROOMS 200
+#define MESSAGES_PER_ROUND 5000
+
+static long messages = 0;
+
+static void addMessage(QByteArray & trace, const QStringList & msg)
+{
+    trace.append(msg.join(delimiter).toUtf8());
+    trace.append("\n\n");
+    ++messages;
+}
+
+static QString nick(int i)
+{
+    return QString("player%1").arg(i);
+}
+
+// the fields of a room as sent in ROOMS and ROOM ADD/UPD
+static QStringList room(int i, int round)
+{
+    static const char * maps[] = {"+rnd+", "+maze+", "Bamboo", "Castle", "+drawn+", "NoSuchMap"};
+
+    return QStringList()
+        << ((i + round) % 3 ? "" : "g") + QString(i % 7 ? "" : "p")
+        << QString("room %1").arg(i)
+        << QString::number(1 + (i + round) % 8)
+        << QString::number((i + round) % 5)
+        << nick(i)
+        << maps[i % 6]
+        << "Normal"
+        << "Default"
+        << "Default"
+        << (i % 10 ? *cProtoVer : QString("47"));
+}
+
+static QByteArray lobbyTrace(int rounds)
+{
+    QByteArray trace;
+
+    addMessage(trace, QStringList() << "CONNECTED" << "Hedgewars server" << "100");
+
+    QStringList joined = QStringList() << "LOBBY:JOINED" << "bench";
+    for(int i = 0; i < PLAYERS; ++i)
+        joined << nick(i);
+    addMessage(trace, joined);
+
+    QStringList rooms = QStringList() << "ROOMS";
+    for(int i = 0; i < ROOMS; ++i)
+        rooms << room(i, 0);
+    addMessage(trace, rooms);
+
+    for(int r = 0; r < rounds; ++r)
+    {
+        for(int i = 0; i < MESSAGES_PER_ROUND; ++i)
+        {
+            int p = (r * MESSAGES_PER_ROUND + i) % PLAYERS;
+            int n = (r * MESSAGES_PER_ROUND + i) % ROOMS;
+            // same for all messages of a block of 20, so rooms added get removed
+            int b = (r * MESSAGES_PER_ROUND + i) / 20 % PLAYERS;
+
+            switch(i % 20)
+            {
+                case 0: case 1: case 2: case 3: case 4: case 5: case 6:
+                    addMessage(trace, QStringList() << "CHAT" << nick(p)
+                        << QString("message %1 in round %2, nothing to see here").arg(i).arg(r));
+                    break;
+                case 7:
+                    addMessage(trace, QStringList() << "CHAT" << nick(p) << "/me waves");
+                    break;
+                case 8: case 9: case 10: case 11: case 12:
+                    addMessage(trace, QStringList() << "ROOM" << "UPD" << QString("room %1").arg(n) << room(n, r + i));
+                    break;
+                case 13: case 14:
+                    addMessage(trace, QStringList() << "CLIENT_FLAGS" << (i % 2 ? "+i" : "-i") << nick(p) << nick((p + 1) % PLAYERS));
+                    break;
+                case 15:
+                    addMessage(trace, QStringList() << "LOBBY:LEFT" << nick(p) << "bye");
+                    addMessage(trace, QStringList() << "LOBBY:JOINED" << nick(p));
+                    break;
+                case 16:
+                    addMessage(trace, QStringList() << "ROOM" << "ADD" << room(ROOMS + b, r));
+                    break;
+                case 17:
+                    addMessage(trace, QStringList() << "ROOM" << "DEL" << QString("room %1").arg(ROOMS + b));
+                    break;
+                case 18:
+                    addMessage(trace, QStringList() << "CLIENT_FLAGS" << "+u" << nick(p));
+                    break;
+                default:
+                    addMessage(trace, QStringList() << "INFO" << nick(p) << "[]" << "0.9.25" << "[lobby]");
+            }
+        }
+    }
+
+    // noticed by the chat handler below
+    addMessage(trace, QStringList() << "CHAT" << "bench-end" << "done");
+
+    return trace;
+}
+
+int main(int argc, char *argv[])
+{
+    QApplication app(argc, argv);
+    int rounds = argc > 1 ? atoi(argv[1]) : 20;
+    if(rounds < 1)
+        rounds = 1;
+
+    QByteArray trace = lobbyTrace(rounds);
+    printf("%ld messages, %d bytes\n", messages, trace.size());
+
+    QTcpServer server;
+    if(!server.listen(QHostAddress::LocalHost))
+    {
+        printf("cannot listen: %s\n", qPrintable(server.errorString()));
+        return 1;
+    }
+
+    HWNewNet net;
+    QEventLoop loop;
+    bool done = false;
+    QObject::connect(&server, &QTcpServer::newConnection, &loop, &QEventLoop::quit);
+    QObject::connect(&net, &HWNewNet::lobbyChatMessage, [&](const QString & sender, const QString &)
+    {
+        if(sender == "bench-end")
+        {
+            done = true;
+            loop.quit();
+        }
+    });
+
+    net.Connect("127.0.0.1", server.serverPort(), false, "bench");
+    QTimer::singleShot(5000, &loop, &QEventLoop::quit);
+    loop.exec();
+    QTcpSocket * peer = server.nextPendingConnection();
+    if(!peer)
+    {
+        printf("no connection\n");
+        return 1;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    peer->write(trace);
+    while(!done && timer.elapsed() < 600000)
+    {
+        QTimer::singleShot(1000, &loop, &QEventLoop::quit);
+        loop.exec();
+    }
+    qint64 nsecs = timer.nsecsElapsed();
+
+    if(!done)
+    {
+        printf("the lobby trace was not read\n");
+        return 1;
+    }
+
+    double elapsed = nsecs / 1e9;
+    printf("%-16s %8.3f s  %12.0f messages/s  %8.1f MB/s\n", "lobby replay", elapsed,
+           messages / elapsed, trace.size() / elapsed / (1024 * 1024));
+    return 0;
+}
@@ -0,0 +1,126 @@
+/*
+ * Hedgewars, a free turn based strategy game
+ * Copyright (c) 2004-2015 Andrey Korotaev <unC0Rr@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+// Times repainting the rooms list with 500 rooms, through the same filter
+// proxy and table view setup as the rooms page, both on its own and after
+// a batch of room updates like the ones a busy server sends.
+// This is not run as a test, start it by hand to compare changes
+// (set QT_QPA_PLATFORM=offscreen when there is no display):
+//
+//   bench_roomslist [rounds]
+
+#include <QApplication>
+#include <QElapsedTimer>
+#include <QHeaderView>
+#include <QImage>
+#include <QTableView>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "hwconsts.h"
+#include "roomslistmodel.h"
+#include "RoomsFilterProxyModel.h"
+
+#define ROOMS 500
+
+static QStringList room(int i, int round)
+{
+    static const char * maps[] = {"+rnd+", "+maze+", "Bamboo", "Castle", "+drawn+", "NoSuchMap"};
+
+    return QStringList()
+        << ((i + round) % 3 ? "" : "g") + QString(i % 7 ? "" : "p")
+        << QString("room %1").arg(i)
+        << QString::number(1 + (i + round) % 8)
+        << QString::number((i + round) % 5)
+        << QString("player%1").arg(i)
+        << maps[i % 6]
+        << "Normal"
+        << "Default"
+        << "Default"
+        << (i % 10 ? *cProtoVer : QString("47"));
+}
+
+static void report(const char * name, qint64 nsecs, long count, const char * unit)
+{
+    double elapsed = nsecs / 1e9;
+    printf("%-16s %8.3f s  %12.0f %s/s\n", name, elapsed, elapsed > 0 ? count / elapsed : 0.0, unit);
+}
+
+int main(int argc, char *argv[])
+{
+    QApplication app(argc, argv);
+    int rounds = argc > 1 ? atoi(argv[1]) : 50;
+    if(rounds < 1)
+        rounds = 1;
+
+    RoomsListModel model;
+    QStringList rooms;
+    for(int i = 0; i < ROOMS; ++i)
+        rooms << room(i, 0);
+    model.setRoomsList(rooms);
+
+    // like PageRoomsList::setModel()
+    RoomsFilterProxyModel proxy;
+    proxy.sort(RoomsListModel::StateColumn, Qt::AscendingOrder);
+    proxy.setSourceModel(&model);
+
+    QTableView view;
+    view.setSelectionBehavior(QAbstractItemView::SelectRows);
+    view.verticalHeader()->setVisible(false);
+    view.setAlternatingRowColors(true);
+    view.setShowGrid(false);
+    view.setModel(&proxy);
+    view.horizontalHeader()->setSectionResizeMode(RoomsListModel::NameColumn, QHeaderView::Stretch);
+    view.hideColumn(RoomsListModel::StateColumn);
+
+    // tall enough to show every room
+    view.resize(1000, view.verticalHeader()->defaultSectionSize() * (ROOMS + 2));
+    view.show();
+    app.processEvents();
+
+    QImage image(view.size(), QImage::Format_ARGB32_Premultiplied);
+    QElapsedTimer timer;
+
+    qint64 paintTime = 0;
+    for(int r = 0; r < rounds; ++r)
+    {
+        timer.start();
+        view.render(&image);
+        paintTime += timer.nsecsElapsed();
+    }
+
+    qint64 updateTime = 0;
+    for(int r = 0; r < rounds; ++r)
+    {
+        timer.start();
+        // one read from the server updating every room
+        model.beginBatch();
+        for(int i = 0; i < ROOMS; ++i)
+            model.updateRoom(QString("room %1").arg(i), room(i, r + 1));
+        model.endBatch();
+        app.processEvents();
+        view.render(&image);
+        updateTime += timer.nsecsElapsed();
+    }
+
+    printf("%d rooms, %d shown\n", model.rowCount(QModelIndex()), proxy.rowCount(QModelIndex()));
+    report("repaint", paintTime, (long)rounds, "frames");
+    report("update+repaint", updateTime, (long)rounds, "frames");
+    return 0;
+}
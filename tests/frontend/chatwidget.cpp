@@ -0,0 +1,110 @@
+/*
+ * Hedgewars, a free turn based strategy game
+ * Copyright (c) 2004-2015 Andrey Korotaev <unC0Rr@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+// Checks that the chat log shows exactly the newest entries once more of
+// them were added than it keeps, also when entries take several text blocks.
+
+#include <QApplication>
+#include <QRegularExpression>
+#include <QStringList>
+#include <QTextBrowser>
+#include <stdio.h>
+
+#include "chatwidget.h"
+
+// MAX_CHAT_LINES in chatwidget.cpp
+static const int keptEntries = 250;
+
+static int failures = 0;
+
+// adds entry n, it is marked with #n# on each of its lines
+static void addEntry(HWChatWidget & chat, int n)
+{
+    switch(n % 3)
+    {
+        case 0:
+            chat.displayNotice(QString("#%1# notice").arg(n));
+            break;
+        case 1:
+            // a text block for each paragraph
+            chat.onServerMessage(QString("<p>#%1# first</p><p>#%1# second</p><p>#%1# third</p>").arg(n));
+            break;
+        default:
+            chat.displayWarning(QString("#%1# warning<br>#%1# next line").arg(n));
+    }
+}
+
+static int lines(int n)
+{
+    return n % 3 == 0 ? 1 : (n % 3 == 1 ? 3 : 2);
+}
+
+static void check(QTextBrowser * log, const char * name, int first, int last)
+{
+    QList<int> shown;
+    QRegularExpressionMatchIterator it = QRegularExpression("#(\\d+)#").globalMatch(log->toPlainText());
+    while(it.hasNext())
+        shown << it.next().captured(1).toInt();
+
+    QList<int> expected;
+    for(int n = first; n <= last; ++n)
+        for(int i = 0; i < lines(n); ++i)
+            expected << n;
+
+    if(shown != expected)
+    {
+        printf("FAIL %s: %d markers shown, expected %d (entries %d to %d)\n",
+               name, shown.size(), expected.size(), first, last);
+        ++failures;
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    QApplication app(argc, argv);
+    HWChatWidget chat(0, false);
+    QTextBrowser * log = chat.findChild<QTextBrowser *>("chatText");
+    if(!log)
+    {
+        printf("FAIL: no chat log\n");
+        return 1;
+    }
+
+    int n = 0;
+
+    for(; n < 10; ++n)
+        addEntry(chat, n);
+    check(log, "few entries", 0, n - 1);
+
+    for(; n < keptEntries; ++n)
+        addEntry(chat, n);
+    check(log, "full log", 0, n - 1);
+
+    addEntry(chat, n++);
+    check(log, "one entry dropped", n - keptEntries, n - 1);
+
+    for(; n < 3 * keptEntries + 7; ++n)
+        addEntry(chat, n);
+    check(log, "many entries dropped", n - keptEntries, n - 1);
+
+    if(failures)
+        return 1;
+    printf("chat log passed\n");
+    return 0;
+}
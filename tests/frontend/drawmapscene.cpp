@@ -0,0 +1,88 @@
+/*
+ * Hedgewars, a free turn based strategy game
+ * Copyright (c) 2004-2015 Andrey Korotaev <unC0Rr@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+// Checks that DrawMapScene::decode() reads back exactly what encode() writes.
+
+#include <QApplication>
+#include <QByteArray>
+#include <stdio.h>
+
+#include "drawmapscene.h"
+#include "randommap.h"
+
+static int failures = 0;
+
+static void check(DrawMapScene & scene, const char * name, const QByteArray & data, int points,
+                  const QByteArray & expected)
+{
+    scene.decode(data);
+    QByteArray encoded = scene.encode();
+    if(encoded != expected)
+    {
+        printf("FAIL %s: %d bytes encoded, expected %d\n", name, encoded.size(), expected.size());
+        ++failures;
+    }
+    if(scene.pointsCount() != points)
+    {
+        printf("FAIL %s: %d points decoded, expected %d\n", name, scene.pointsCount(), points);
+        ++failures;
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    QApplication app(argc, argv);
+    DrawMapScene scene;
+    int points;
+    QByteArray data;
+
+    check(scene, "empty map", QByteArray(), 0, QByteArray());
+
+    data = randomMap(0, 50, 1, points);
+    check(scene, "one point strokes", data, points, data);
+
+    data.clear();
+    points = 0;
+    appendPoint(data, 100, 200, 0x80 | 0x40 | 7, points);
+    appendPoint(data, 300, 400, 0, points);
+    appendPoint(data, -1, -1, 0x80 | 0x40 | 0x3f, points);
+    check(scene, "erasers", data, points, data);
+
+    data = randomMap(3, 0, 1, points);
+    check(scene, "special points only", data, 0, data);
+
+    data = randomMap(2, 10, 20, points);
+    check(scene, "truncated point", data + QByteArray("\x80\x01\x02", 3), points, data);
+
+    for(int i = 0; i < 20; ++i)
+    {
+        data = randomMap(randomInt(0, 4), randomInt(1, 200), randomInt(1, 100), points);
+        check(scene, "random strokes", data, points, data);
+    }
+
+    // decoding again must replace the previous map
+    scene.decode(randomMap(0, 100, 100, points));
+    data = randomMap(1, 5, 5, points);
+    check(scene, "decode twice", data, points, data);
+
+    if(failures)
+        return 1;
+    printf("drawn map round trip passed\n");
+    return 0;
+}
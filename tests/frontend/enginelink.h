@@ -0,0 +1,76 @@
+/*
+ * Hedgewars, a free turn based strategy game
+ * Copyright (c) 2004-2015 Andrey Korotaev <unC0Rr@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+// Connection to the fake engine of fakeengine.c for the TCPBase test and
+// benchmark, it is started as bindir/hwengine.
+
+#ifndef _ENGINELINK_H
+#define _ENGINELINK_H
+
+#include <QEventLoop>
+#include <QPointer>
+#include <QStringList>
+#include <QTimer>
+
+#include "hwconsts.h"
+#include "tcpBase.h"
+
+class EngineLink : public TCPBase
+{
+    public:
+        // mode: the fake engine's arguments after the IPC ones
+        explicit EngineLink(const QStringList & mode) :
+            TCPBase(false, false),
+            m_mode(mode)
+        {
+            bindir->setPath(FAKE_ENGINE_DIR);
+        }
+
+        // starts the fake engine, this deletes itself once it disconnected
+        void start(bool privately)
+        {
+            if(privately)
+                listenPrivately();
+            Start(false);
+        }
+
+        // runs the event loop until the link is gone, false on timeout
+        static bool run(EngineLink * link, int timeout)
+        {
+            QPointer<EngineLink> alive(link);
+            QEventLoop loop;
+            QObject::connect(link, &QObject::destroyed, &loop, &QEventLoop::quit);
+            QTimer::singleShot(timeout, &loop, &QEventLoop::quit);
+            loop.exec();
+            if(!alive)
+                return true;
+            delete link;
+            return false;
+        }
+
+    protected:
+        QStringList getArguments()
+        {
+            return ipcArguments() << m_mode;
+        }
+
+    private:
+        QStringList m_mode;
+};
+
+#endif // _ENGINELINK_H
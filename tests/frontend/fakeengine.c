@@ -0,0 +1,163 @@
+/*
+ * Hedgewars, a free turn based strategy game
+ * Copyright (c) 2004-2015 Andrey Korotaev <unC0Rr@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/*
+ * Stands in for hwengine in the TCPBase test and benchmark. It connects to
+ * the frontend like the engine does and exchanges length prefixed messages:
+ *
+ *   hwengine --port <port> | --ipc-socket <path>  echo
+ *       sends every message back until it gets "!"
+ *   hwengine --port <port> | --ipc-socket <path>  stream <count>
+ *       sends "first", waits for a message, sends <count> messages made by
+ *       streamMessage() in fakeengine.h and waits for "!"
+ */
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "fakeengine.h"
+
+static int sock = -1;
+static unsigned char out[64 * 1024];
+static size_t outSize = 0;
+
+static int connectTo(int argc, char *argv[])
+{
+    if(argc >= 3 && !strcmp(argv[1], "--port"))
+    {
+        struct sockaddr_in addr;
+        int one = 1;
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(atoi(argv[2]));
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        sock = socket(AF_INET, SOCK_STREAM, 0);
+        // like the engine, don't wait to fill packets
+        setsockopt(sock, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        return sock >= 0 && connect(sock, (struct sockaddr *)&addr, sizeof(addr)) == 0;
+    }
+    if(argc >= 3 && !strcmp(argv[1], "--ipc-socket"))
+    {
+        struct sockaddr_un addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sun_family = AF_UNIX;
+        strncpy(addr.sun_path, argv[2], sizeof(addr.sun_path) - 1);
+        sock = socket(AF_UNIX, SOCK_STREAM, 0);
+        return sock >= 0 && connect(sock, (struct sockaddr *)&addr, sizeof(addr)) == 0;
+    }
+    return 0;
+}
+
+static int flush(void)
+{
+    size_t done = 0;
+    while(done < outSize)
+    {
+        ssize_t n = write(sock, out + done, outSize - done);
+        if(n <= 0)
+            return 0;
+        done += n;
+    }
+    outSize = 0;
+    return 1;
+}
+
+// messages are collected and written in big chunks, call flush() to send them
+static int sendMessage(const unsigned char *msg, size_t len)
+{
+    if(outSize + 1 + len > sizeof(out) && !flush())
+        return 0;
+    out[outSize++] = (unsigned char)len;
+    memcpy(out + outSize, msg, len);
+    outSize += len;
+    return 1;
+}
+
+static int readFull(unsigned char *buf, size_t len)
+{
+    size_t done = 0;
+    while(done < len)
+    {
+        ssize_t n = read(sock, buf + done, len - done);
+        if(n <= 0)
+            return 0;
+        done += n;
+    }
+    return 1;
+}
+
+// reads the next message into buf, returns its length or -1
+static int receiveMessage(unsigned char *buf)
+{
+    unsigned char len;
+    if(!readFull(&len, 1) || !readFull(buf, len))
+        return -1;
+    return len;
+}
+
+static int isQuit(const unsigned char *msg, int len)
+{
+    return len == 1 && msg[0] == '!';
+}
+
+int main(int argc, char *argv[])
+{
+    unsigned char msg[256];
+    int len;
+
+    if(!connectTo(argc, argv) || argc < 4)
+    {
+        fprintf(stderr, "usage: hwengine --port <port> | --ipc-socket <path> echo | stream <count>\n");
+        return 1;
+    }
+
+    if(!strcmp(argv[3], "echo"))
+    {
+        while((len = receiveMessage(msg)) >= 0 && !isQuit(msg, len))
+            if(!sendMessage(msg, len) || !flush())
+                return 1;
+        return 0;
+    }
+
+    if(!strcmp(argv[3], "stream") && argc >= 5)
+    {
+        long count = atol(argv[4]);
+        if(!sendMessage((const unsigned char *)"first", 5) || !flush() || receiveMessage(msg) < 0)
+            return 1;
+        for(long i = 0; i < count; i++)
+        {
+            len = streamMessage(i, msg);
+            if(!sendMessage(msg, len))
+                return 1;
+        }
+        if(!flush())
+            return 1;
+        while((len = receiveMessage(msg)) >= 0 && !isQuit(msg, len))
+            ;
+        return 0;
+    }
+
+    return 1;
+}
@@ -0,0 +1,34 @@
+/*
+ * Hedgewars, a free turn based strategy game
+ * Copyright (c) 2004-2015 Andrey Korotaev <unC0Rr@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef _FAKEENGINE_H
+#define _FAKEENGINE_H
+
+/*
+ * Writes message i of the fake engine's stream to msg and returns its
+ * length: mostly a few bytes like most engine messages, some long ones.
+ */
+static inline int streamMessage(long i, unsigned char *msg)
+{
+    int len = i % 16 ? 1 + i % 9 : 1 + i % 255;
+    for(int j = 0; j < len; j++)
+        msg[j] = 'a' + (i + j) % 26;
+    return len;
+}
+
+#endif // _FAKEENGINE_H
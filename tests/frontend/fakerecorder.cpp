@@ -0,0 +1,82 @@
+/*
+ * Hedgewars, a free turn based strategy game
+ * Copyright (c) 2004-2015 Andrey Korotaev <unC0Rr@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+// Replaces the implementations of HWRecorder and TCPBase, so a recorder
+// neither needs a game config nor starts an engine: startEncoding() is only
+// recorded. Only what RecorderScheduler and the meta objects use is here.
+
+#include "fakerecorder.h"
+#include "hwconsts.h"
+
+QSize fakeResolution(1280, 720);
+QString fakeCodec("mpeg4");
+QList<HWRecorder *> startedRecorders;
+
+QDir * cfgdir = new QDir();
+
+TCPBase::TCPBase(bool demoMode, bool usesCustomLanguage, QObject * parent) :
+    QObject(parent)
+{
+    Q_UNUSED(demoMode);
+    Q_UNUSED(usesCustomLanguage);
+}
+
+TCPBase::~TCPBase() {}
+bool TCPBase::couldBeRemoved() { return false; }
+bool TCPBase::simultaneousRun() { return false; }
+void TCPBase::onClientRead() {}
+void TCPBase::onClientDisconnect() {}
+void TCPBase::SendToClientFirst() {}
+void TCPBase::NewConnection() {}
+void TCPBase::ClientDisconnect() {}
+void TCPBase::ClientRead() {}
+void TCPBase::FlushIPC() {}
+void TCPBase::StartProcessError(QProcess::ProcessError) {}
+void TCPBase::onEngineDeath(int, QProcess::ExitStatus) {}
+void TCPBase::tcpServerReady() {}
+
+HWRecorder::HWRecorder(GameUIConfig * config, const QString & prefix) :
+    TCPBase(false, false)
+{
+    this->config = config;
+    this->prefix = prefix;
+    item = 0;
+    finished = false;
+    aborted = false;
+}
+
+HWRecorder::~HWRecorder() {}
+QStringList HWRecorder::getArguments() { return QStringList(); }
+void HWRecorder::onClientRead() {}
+void HWRecorder::onClientDisconnect() {}
+bool HWRecorder::simultaneousRun() { return true; }
+
+void HWRecorder::startEncoding()
+{
+    startedRecorders.append(this);
+}
+
+QSize HWRecorder::resolution() const
+{
+    return fakeResolution;
+}
+
+QString HWRecorder::videoCodec() const
+{
+    return fakeCodec;
+}
@@ -0,0 +1,36 @@
+/*
+ * Hedgewars, a free turn based strategy game
+ * Copyright (c) 2004-2015 Andrey Korotaev <unC0Rr@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+// HWRecorder for the RecorderScheduler test, see fakerecorder.cpp.
+
+#ifndef _FAKERECORDER_H
+#define _FAKERECORDER_H
+
+#include <QList>
+#include <QSize>
+#include <QString>
+
+#include "net/recorder.h"
+
+// what every fake recorder reports to the scheduler
+extern QSize fakeResolution;
+extern QString fakeCodec;
+// recorders whose startEncoding() was called, in order
+extern QList<HWRecorder *> startedRecorders;
+
+#endif // _FAKERECORDER_H
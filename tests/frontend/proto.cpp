@@ -0,0 +1,79 @@
+/*
+ * Hedgewars, a free turn based strategy game
+ * Copyright (c) 2004-2015 Andrey Korotaev <unC0Rr@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+// Checks that HWProto::addDrawnMapToBuffer() frames drawn map data byte for
+// byte like the frontend did before, when it cut the data into copies of
+// 200 bytes and sent each one with TCPBase::SendIPC().
+
+#include <QByteArray>
+#include <stdio.h>
+
+#include "net/proto.h"
+#include "randommap.h"
+
+static QByteArray slicedDrawnMap(const QByteArray & drawnMap)
+{
+    QByteArray buf;
+    QByteArray data = drawnMap;
+    while(data.size() > 0)
+    {
+        QByteArray tmp = data;
+        tmp.truncate(200);
+        QByteArray msg = "edraw " + tmp;
+        char len = msg.size();
+        buf.append(&len, 1);
+        buf.append(msg);
+        data.remove(0, 200);
+    }
+    return buf;
+}
+
+static int failures = 0;
+
+static void check(int size)
+{
+    QByteArray drawnMap;
+    drawnMap.reserve(size);
+    for(int i = 0; i < size; ++i)
+        drawnMap.append(char(randomInt(0, 255)));
+
+    // appends to what is in the buffer already
+    QByteArray buf("\x05hello", 6);
+    HWProto::addDrawnMapToBuffer(buf, drawnMap);
+
+    QByteArray expected = QByteArray("\x05hello", 6) + slicedDrawnMap(drawnMap);
+    if(buf != expected)
+    {
+        printf("FAIL %d bytes of map: %d bytes framed, expected %d\n", size, buf.size(), expected.size());
+        ++failures;
+    }
+}
+
+int main()
+{
+    const int sizes[] = {0, 1, 5, 199, 200, 201, 399, 400, 401, 1000, 65536, 1024 * 1024};
+
+    for(unsigned int i = 0; i < sizeof(sizes) / sizeof(sizes[0]); ++i)
+        check(sizes[i]);
+
+    if(failures)
+        return 1;
+    printf("drawn map framing passed\n");
+    return 0;
+}
@@ -0,0 +1,71 @@
+/*
+ * Hedgewars, a free turn based strategy game
+ * Copyright (c) 2004-2015 Andrey Korotaev <unC0Rr@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+// Random drawn maps for the DrawMapScene test and benchmark.
+
+#ifndef _RANDOMMAP_H
+#define _RANDOMMAP_H
+
+#include <QByteArray>
+#include <QtEndian>
+#include <random>
+
+static std::mt19937 rng(20151);
+
+static inline int randomInt(int min, int max)
+{
+    return std::uniform_int_distribution<int>(min, max)(rng);
+}
+
+static inline void appendPoint(QByteArray & data, int x, int y, quint8 flags, int & points)
+{
+    qint16 px = qToBigEndian((qint16)x);
+    qint16 py = qToBigEndian((qint16)y);
+    data.append((const char *)&px, 2);
+    data.append((const char *)&py, 2);
+    data.append((const char *)&flags, 1);
+    ++points;
+}
+
+// a map in the format written by encode(): special points first, then the
+// strokes, each starting with a point that carries the width and eraser flag
+static inline QByteArray randomMap(int specialPoints, int strokes, int maxStrokePoints, int & points)
+{
+    QByteArray data;
+    int ignored = 0;
+    for(int i = 0; i < specialPoints; ++i)
+        appendPoint(data, randomInt(0, 4095), randomInt(0, 2047), 0, ignored);
+
+    points = 0;
+    for(int i = 0; i < strokes; ++i)
+    {
+        quint8 flags = 0x80 + randomInt(0, 0x3f);
+        if(randomInt(0, 3) == 0)
+            flags |= 0x40;
+        int count = randomInt(1, maxStrokePoints);
+        for(int j = 0; j < count; ++j)
+        {
+            // points outside of the map are allowed
+            appendPoint(data, randomInt(-32768, 32767), randomInt(-32768, 32767), j ? 0 : flags, points);
+        }
+    }
+    return data;
+}
+
+#endif // _RANDOMMAP_H
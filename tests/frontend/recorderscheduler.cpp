@@ -0,0 +1,143 @@
+/*
+ * Hedgewars, a free turn based strategy game
+ * Copyright (c) 2004-2015 Andrey Korotaev <unC0Rr@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+// Checks the queue of RecorderScheduler with fake recorders (see
+// fakerecorder.cpp): starting encodes, moving one to the front, pausing,
+// removing destroyed recorders and the estimated remaining time.
+
+#include <QCoreApplication>
+#include <QFile>
+#include <QTemporaryDir>
+#include <QThread>
+#include <stdio.h>
+#include <string.h>
+
+#include "fakerecorder.h"
+#include "net/recorderscheduler.h"
+
+static int failures = 0;
+
+#define CHECK(cond) \
+    do { \
+        if(!(cond)) { \
+            printf("FAIL line %d: %s\n", __LINE__, #cond); \
+            ++failures; \
+        } \
+    } while(0)
+
+// writes the camera file the scheduler takes the length of a recording from
+static void writeCameraFile(const QString & prefix, quint32 lastTicks)
+{
+    QFile file(cfgdir->absoluteFilePath("VideoTemp/" + prefix + ".txtin"));
+    file.open(QIODevice::WriteOnly);
+    char frame[20] = {0};
+    for(int i = 0; i < 9; ++i)
+        file.write(frame, sizeof(frame));
+    // the time stamp is at the start of the frame
+    memcpy(frame, &lastTicks, sizeof(lastTicks));
+    file.write(frame, sizeof(frame));
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QTemporaryDir dir;
+    cfgdir->setPath(dir.path());
+    cfgdir->mkpath("VideoTemp");
+
+    RecorderScheduler & scheduler = RecorderScheduler::instance();
+
+    // a picture this big leaves room for one encode at a time
+    fakeResolution = QSize(20000, 20000);
+    fakeCodec = "libx264";
+    CHECK(scheduler.maxRunning() == 1);
+
+    HWRecorder * a = new HWRecorder(0, "a");
+    HWRecorder * b = new HWRecorder(0, "b");
+    HWRecorder * c = new HWRecorder(0, "c");
+    HWRecorder * d = new HWRecorder(0, "d");
+
+    scheduler.enqueue(a);
+    scheduler.enqueue(b);
+    scheduler.enqueue(c);
+    CHECK(startedRecorders == QList<HWRecorder *>() << a);
+    CHECK(scheduler.numRunning() == 1);
+    CHECK(scheduler.numQueued() == 2);
+    CHECK(!scheduler.isQueued(a));
+    CHECK(scheduler.isQueued(b) && scheduler.isQueued(c));
+    CHECK(scheduler.remainingTime() == -1);
+
+    // c goes first once a is done
+    scheduler.prioritize(c);
+    delete a;
+    CHECK(startedRecorders == QList<HWRecorder *>() << a << c);
+    CHECK(scheduler.numRunning() == 1);
+    CHECK(scheduler.numQueued() == 1);
+
+    // a paused recorder is skipped
+    scheduler.setPaused(b, true);
+    CHECK(scheduler.isPaused(b));
+    writeCameraFile("d", 120000);
+    scheduler.enqueue(d);
+    delete c;
+    CHECK(startedRecorders.last() == d);
+    CHECK(scheduler.isQueued(b));
+
+    // destroying a queued recorder removes it
+    scheduler.setPaused(b, false);
+    CHECK(!scheduler.isPaused(b));
+    HWRecorder * e = new HWRecorder(0, "e");
+    scheduler.enqueue(e);
+    CHECK(scheduler.numQueued() == 2);
+    delete e;
+    CHECK(scheduler.numQueued() == 1);
+    CHECK(!scheduler.isQueued(e));
+
+    // d is 120 s long and half done, b is of unknown length, counted as 60 s
+    emit d->onProgress(0.5f);
+    CHECK(scheduler.remainingTime() == -1); // the first second is not used
+    QThread::msleep(1200);
+    double speed = scheduler.speed();
+    qint64 remaining = scheduler.remainingTime();
+    CHECK(speed > 0);
+    if(speed > 0)
+    {
+        qint64 expected = qint64((60000 + 60000) / speed);
+        // a millisecond may pass between the two calls
+        CHECK(qAbs(remaining - expected) <= 5);
+    }
+
+    // not counted while paused
+    scheduler.setPaused(b, true);
+    speed = scheduler.speed();
+    remaining = scheduler.remainingTime();
+    if(speed > 0)
+        CHECK(qAbs(remaining - qint64(60000 / speed)) <= 5);
+
+    delete d;
+    CHECK(scheduler.numRunning() == 0);
+    CHECK(scheduler.numQueued() == 1);
+    delete b;
+    CHECK(scheduler.numQueued() == 0);
+
+    if(failures)
+        return 1;
+    printf("recorder scheduler passed\n");
+    return 0;
+}
@@ -0,0 +1,148 @@
+/*
+ * Hedgewars, a free turn based strategy game
+ * Copyright (c) 2004-2015 Andrey Korotaev <unC0Rr@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+// Checks that TCPBase hands out engine messages complete and in order, also
+// when data arrives while onClientRead() runs a nested event loop: the
+// message taken before must stay intact and onClientRead() must not be
+// entered again meanwhile.
+
+#include <QApplication>
+#include <QByteArray>
+#include <QEventLoop>
+#include <QTimer>
+#include <stdio.h>
+#include <string.h>
+
+#include "enginelink.h"
+#include "fakeengine.h"
+
+struct Results
+{
+    long received;     ///< stream messages taken in order
+    bool inOrder;      ///< all of them matched streamMessage()
+    bool firstKept;    ///< the first message survived the nested event loop
+    int nestedReads;   ///< onClientRead() calls while another one ran
+    bool disconnected;
+};
+
+class StreamReader : public EngineLink
+{
+    public:
+        StreamReader(long count, Results & results) :
+            EngineLink(QStringList() << "stream" << QString::number(count)),
+            m_count(count),
+            m_started(false),
+            m_depth(0),
+            r(results)
+        {
+            memset(&r, 0, sizeof(r));
+            r.inOrder = true;
+            r.firstKept = true;
+        }
+
+    protected:
+        void onClientRead()
+        {
+            if(m_depth > 0)
+                ++r.nestedReads;
+            ++m_depth;
+
+            QByteArray msg;
+            while(takeMessage(msg))
+            {
+                if(!m_started)
+                {
+                    m_started = true;
+                    // the rest of the stream comes once the engine gets this,
+                    // which is while the nested event loop runs
+                    SendIPC("go");
+                    QEventLoop loop;
+                    QTimer::singleShot(200, &loop, &QEventLoop::quit);
+                    loop.exec();
+                    if(msg != QByteArray("\x05" "first", 6))
+                        r.firstKept = false;
+                    continue;
+                }
+
+                unsigned char expected[256];
+                int len = streamMessage(r.received, expected);
+                if(msg.size() != len + 1 || quint8(msg.at(0)) != len
+                    || memcmp(msg.constData() + 1, expected, len))
+                    r.inOrder = false;
+
+                if(++r.received == m_count)
+                    SendIPC("!");
+            }
+
+            --m_depth;
+        }
+
+        void onClientDisconnect()
+        {
+            r.disconnected = true;
+        }
+
+    private:
+        long m_count;
+        bool m_started;
+        int m_depth;
+        Results & r;
+};
+
+static int failures = 0;
+
+static void check(const char * name, bool privately, long count)
+{
+    Results r;
+    StreamReader * reader = new StreamReader(count, r);
+    reader->start(privately);
+
+    if(!EngineLink::run(reader, 60000))
+    {
+        printf("FAIL %s: timeout after %ld of %ld messages\n", name, r.received, count);
+        ++failures;
+        return;
+    }
+
+    if(!r.disconnected || r.received != count || !r.inOrder || !r.firstKept || r.nestedReads)
+    {
+        printf("FAIL %s: %ld of %ld messages, %s, first message %s, %d nested reads\n",
+               name, r.received, count, r.inOrder ? "in order" : "NOT in order",
+               r.firstKept ? "kept" : "CHANGED", r.nestedReads);
+        ++failures;
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    QApplication app(argc, argv);
+
+    check("private server", true, 100000);
+    check("shared server", false, 100000);
+#ifdef HW_LOCAL_IPC
+    // the same over TCP
+    qputenv("HEDGEWARS_IPC", "tcp");
+    check("private TCP server", true, 100000);
+#endif
+
+    if(failures)
+        return 1;
+    printf("engine messages passed\n");
+    return 0;
+}
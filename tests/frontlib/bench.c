@@ -0,0 +1,241 @@
+/*
+ * Hedgewars, a free turn based strategy game
+ * Copyright (C) 2012 Simeon Maxein <smaxein@googlemail.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+
+/**
+ * Times the frontlib's protocol and lookup code on synthetic data, without a network or
+ * engine: engine messages through flib_ipcbase, server messages through flib_netbase
+ * (both replayed from memory, see replaysocket.h) and name lookups in schemes, team lists
+ * and scheme lists. This is not run as a test, start it by hand to compare changes:
+ *
+ *   bench_frontlib [rounds]
+ */
+
+#include "ipc/ipcbase.h"
+#include "net/netbase.h"
+#include "model/scheme.h"
+#include "model/schemelist.h"
+#include "model/teamlist.h"
+#include "util/logging.h"
+#include "util/util.h"
+#include "replaysocket.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define ENGINE_STREAM_BYTES (32*1024*1024)
+#define SERVER_STREAM_BYTES (16*1024*1024)
+#define RECV_CHUNK (64*1024)
+#define LIST_ENTRIES 64
+#define LOOKUP_ROUNDS 20000
+
+static double seconds() {
+    return (double)clock()/CLOCKS_PER_SEC;
+}
+
+static void report(const char *name, double elapsed, long count, const char *unit, size_t bytes) {
+    printf("%-16s %8.3f s  %12.0f %s/s", name, elapsed, elapsed>0 ? count/elapsed : 0.0, unit);
+    if(bytes) {
+        printf("  %8.1f MB/s", elapsed>0 ? bytes/elapsed/(1024*1024) : 0.0);
+    }
+    printf("\n");
+}
+
+/**
+ * Engine messages as they arrive during a game: mostly a few bytes, some longer ones.
+ */
+static uint8_t *createEngineStream(size_t *len, long *count) {
+    uint8_t *result = flib_malloc(ENGINE_STREAM_BYTES);
+    size_t pos = 0;
+    *count = 0;
+    while(result && pos+256 <= ENGINE_STREAM_BYTES) {
+        int msglen = *count%16 ? 1+*count%9 : 1+*count%255;
+        result[pos++] = msglen;
+        for(int i=0; i<msglen; i++) {
+            result[pos++] = 'a'+(*count+i)%26;
+        }
+        (*count)++;
+    }
+    *len = pos;
+    return result;
+}
+
+/**
+ * Lobby traffic: chat lines, joins and room updates.
+ */
+static uint8_t *createServerStream(size_t *len, long *count) {
+    char *result = flib_malloc(SERVER_STREAM_BYTES);
+    size_t pos = 0;
+    *count = 0;
+    while(result && pos+256 <= SERVER_STREAM_BYTES) {
+        long i = *count;
+        switch(i%3) {
+        case 0:
+            pos += sprintf(result+pos, "CHAT\nplayer%li\nthis is chat line number %li\n\n", i%97, i);
+            break;
+        case 1:
+            pos += sprintf(result+pos, "LOBBY:JOINED\nplayer%li\nplayer%li\nplayer%li\n\n", i%97, (i+1)%97, (i+2)%97);
+            break;
+        default:
+            pos += sprintf(result+pos, "ROOM\nUPD\nroom%li\n0\nroom%li\n3\n8\nplayer%li\n+rnd+\nNature\nDefault\nDefault\nDefault\n\n",
+                    i%50, i%50, i%97);
+            break;
+        }
+        (*count)++;
+    }
+    *len = pos;
+    return (uint8_t*)result;
+}
+
+static double benchEngineStream(const uint8_t *stream, size_t len, long count) {
+    replay_setstream(stream, len, RECV_CHUNK, 1);
+    double start = seconds();
+    flib_ipcbase *ipc = flib_ipcbase_create();
+    flib_ipcbase_accept(ipc);
+    long received = 0;
+    while(ipc && flib_ipcbase_state(ipc) == IPC_CONNECTED) {
+        flib_ipcbase_receive(ipc);
+        uint8_t *msg;
+        while(flib_ipcbase_next_message(ipc, &msg) >= 0) {
+            received++;
+        }
+    }
+    flib_ipcbase_destroy(ipc);
+    double elapsed = seconds()-start;
+    if(received != count) {
+        printf("engine stream: %li of %li messages received\n", received, count);
+    }
+    return elapsed;
+}
+
+static double benchServerStream(const uint8_t *stream, size_t len, long count) {
+    replay_setstream(stream, len, RECV_CHUNK, 1);
+    double start = seconds();
+    flib_netbase *net = flib_netbase_create("localhost", 46631);
+    long received = 0;
+    flib_netmsg *msg;
+    while(net && ((msg = flib_netbase_recv_message(net)) || flib_netbase_connected(net))) {
+        if(msg) {
+            received++;
+            flib_netmsg_destroy(msg);
+        }
+    }
+    flib_netbase_destroy(net);
+    double elapsed = seconds()-start;
+    if(received != count) {
+        printf("server stream: %li of %li messages received\n", received, count);
+    }
+    return elapsed;
+}
+
+static double benchSchemeLookups(long *count) {
+    flib_scheme *scheme = flib_scheme_create("bench");
+    long lookups = 0;
+    double start = seconds();
+    for(int round=0; scheme && round<LOOKUP_ROUNDS; round++) {
+        for(int i=0; i<flib_meta.settingCount; i++) {
+            flib_scheme_get_setting(scheme, flib_meta.settings[i].name, 0);
+        }
+        for(int i=0; i<flib_meta.modCount; i++) {
+            flib_scheme_get_mod(scheme, flib_meta.mods[i].name);
+        }
+        lookups += flib_meta.settingCount+flib_meta.modCount;
+    }
+    double elapsed = seconds()-start;
+    *count = lookups;
+    flib_scheme_destroy(scheme);
+    return elapsed;
+}
+
+static double benchListLookups(long *count) {
+    flib_teamlist *teams = flib_teamlist_create();
+    flib_schemelist *schemes = flib_schemelist_create();
+    char names[LIST_ENTRIES][32];
+    for(int i=0; teams && schemes && i<LIST_ENTRIES; i++) {
+        snprintf(names[i], sizeof(names[i]), "entry number %i", i);
+        flib_team *team = flib_calloc(1, sizeof(flib_team));
+        if(team && (team->name = flib_strdupnull(names[i])) && !flib_teamlist_insert(teams, team, i)) {
+            team = NULL;
+        }
+        flib_team_destroy(team);
+        flib_scheme *scheme = flib_scheme_create(names[i]);
+        if(scheme && !flib_schemelist_insert(schemes, scheme, i)) {
+            scheme = NULL;
+        }
+        flib_scheme_destroy(scheme);
+    }
+
+    long found = 0;
+    double start = seconds();
+    for(int round=0; teams && schemes && round<LOOKUP_ROUNDS; round++) {
+        for(int i=0; i<LIST_ENTRIES; i++) {
+            found += flib_teamlist_find(teams, names[i]) != NULL;
+            found += flib_schemelist_find(schemes, names[i]) != NULL;
+        }
+    }
+    double elapsed = seconds()-start;
+    *count = found;
+    flib_teamlist_destroy(teams);
+    flib_schemelist_destroy(schemes);
+    return elapsed;
+}
+
+int main(int argc, char *argv[]) {
+    int rounds = argc>1 ? atoi(argv[1]) : 3;
+    if(rounds < 1) {
+        fprintf(stderr, "Usage: %s [rounds]\n", argv[0]);
+        return 2;
+    }
+    flib_log_setLevel(FLIB_LOGLEVEL_WARNING);
+
+    size_t engineLen, serverLen;
+    long engineCount, serverCount;
+    uint8_t *engineStream = createEngineStream(&engineLen, &engineCount);
+    uint8_t *serverStream = createServerStream(&serverLen, &serverCount);
+    if(!engineStream || !serverStream) {
+        free(engineStream);
+        free(serverStream);
+        return 1;
+    }
+
+    // Report the best round, the others only differ by noise
+    double engineTime = -1, serverTime = -1, schemeTime = -1, listTime = -1;
+    long schemeCount = 0, listCount = 0;
+    for(int i=0; i<rounds; i++) {
+        double t = benchEngineStream(engineStream, engineLen, engineCount);
+        engineTime = engineTime<0 || t<engineTime ? t : engineTime;
+        t = benchServerStream(serverStream, serverLen, serverCount);
+        serverTime = serverTime<0 || t<serverTime ? t : serverTime;
+        t = benchSchemeLookups(&schemeCount);
+        schemeTime = schemeTime<0 || t<schemeTime ? t : schemeTime;
+        t = benchListLookups(&listCount);
+        listTime = listTime<0 || t<listTime ? t : listTime;
+    }
+
+    report("ipcbase", engineTime, engineCount, "frames", engineLen);
+    report("netbase", serverTime, serverCount, "messages", serverLen);
+    report("scheme lookups", schemeTime, schemeCount, "lookups", 0);
+    report("list lookups", listTime, listCount, "lookups", 0);
+
+    free(engineStream);
+    free(serverStream);
+    return 0;
+}
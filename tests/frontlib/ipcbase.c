@@ -0,0 +1,201 @@
+/*
+ * Hedgewars, a free turn based strategy game
+ * Copyright (C) 2012 Simeon Maxein <smaxein@googlemail.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+
+/**
+ * Replays synthetic engine streams through flib_ipcbase in pieces of different sizes and
+ * checks that every message comes out whole and in order, both through the zero-copy
+ * flib_ipcbase_next_message and the copying flib_ipcbase_recv_message.
+ */
+
+#include "ipc/ipcbase.h"
+#include "replaysocket.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MESSAGE_COUNT 5000
+
+static int failures;
+
+#define CHECK(cond, ...) do { \
+        if(!(cond)) { \
+            failures++; \
+            printf("FAIL line %i: ", __LINE__); \
+            printf(__VA_ARGS__); \
+            printf("\n"); \
+        } \
+    } while(0)
+
+static const int chunkSizes[] = {1, 7, 255, 700, 100000};
+
+static int messageLength(int index) {
+    // Mostly short messages like the engine sends, every length between 0 and 255 included
+    return index%8 ? index%13 : index%256;
+}
+
+static uint8_t messageByte(int index, int pos) {
+    return (uint8_t)(index*31+pos);
+}
+
+/**
+ * Builds a stream of count messages, followed by truncatedBytes of an incomplete one.
+ */
+static uint8_t *createStream(int count, int truncatedBytes, size_t *len) {
+    uint8_t *result = malloc(count*256 + truncatedBytes);
+    size_t pos = 0;
+    if(result) {
+        for(int i=0; i<count; i++) {
+            int msglen = messageLength(i);
+            result[pos++] = msglen;
+            for(int j=0; j<msglen; j++) {
+                result[pos++] = messageByte(i, j);
+            }
+        }
+        if(truncatedBytes > 0) {
+            result[pos++] = 255;
+            memset(result+pos, 0, truncatedBytes-1);
+            pos += truncatedBytes-1;
+        }
+    }
+    *len = pos;
+    return result;
+}
+
+static bool checkMessage(const uint8_t *msg, int size, int index) {
+    if(size != messageLength(index)+1 || msg[0] != messageLength(index)) {
+        return false;
+    }
+    for(int j=0; j<msg[0]; j++) {
+        if(msg[1+j] != messageByte(index, j)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static flib_ipcbase *acceptEngine(flib_ipcbase *ipc) {
+    if(ipc) {
+        flib_ipcbase_accept(ipc);
+        CHECK(flib_ipcbase_state(ipc) == IPC_CONNECTED, "not connected");
+    }
+    return ipc;
+}
+
+static void testNextMessage(int chunkSize, int truncatedBytes) {
+    size_t len;
+    uint8_t *stream = createStream(MESSAGE_COUNT, truncatedBytes, &len);
+    replay_setstream(stream, len, chunkSize, chunkSize);
+    flib_ipcbase *ipc = acceptEngine(flib_ipcbase_create());
+
+    int received = 0;
+    bool inOrder = true;
+    for(size_t ticks=0; ipc && flib_ipcbase_state(ipc)==IPC_CONNECTED && ticks<=len; ticks++) {
+        flib_ipcbase_receive(ipc);
+        uint8_t *msg;
+        int size;
+        while((size = flib_ipcbase_next_message(ipc, &msg)) >= 0) {
+            inOrder &= checkMessage(msg, size, received);
+            // Callers may modify the message in place
+            msg[0] = 0;
+            received++;
+        }
+    }
+    CHECK(inOrder, "next_message, pieces of %i: messages out of order or damaged", chunkSize);
+    CHECK(received == MESSAGE_COUNT, "next_message, pieces of %i: %i messages received, expected %i",
+            chunkSize, received, MESSAGE_COUNT);
+    CHECK(ipc && flib_ipcbase_state(ipc) == IPC_NOT_CONNECTED, "next_message: still connected after the stream ended");
+
+    flib_ipcbase_destroy(ipc);
+    free(stream);
+}
+
+static void testRecvMessage(int chunkSize) {
+    size_t len;
+    uint8_t *stream = createStream(MESSAGE_COUNT, 0, &len);
+    replay_setstream(stream, len, chunkSize, chunkSize);
+    flib_ipcbase *ipc = acceptEngine(flib_ipcbase_create());
+
+    int received = 0;
+    bool inOrder = true;
+    uint8_t msg[256];
+    for(size_t calls=0; ipc && received<MESSAGE_COUNT && calls<=2*len; calls++) {
+        int size = flib_ipcbase_recv_message(ipc, msg);
+        if(size >= 0) {
+            inOrder &= checkMessage(msg, size, received);
+            received++;
+        }
+    }
+    CHECK(inOrder, "recv_message, pieces of %i: messages out of order or damaged", chunkSize);
+    CHECK(received == MESSAGE_COUNT, "recv_message, pieces of %i: %i messages received, expected %i",
+            chunkSize, received, MESSAGE_COUNT);
+
+    flib_ipcbase_destroy(ipc);
+    free(stream);
+}
+
+/**
+ * A map preview is one unframed block of IPCBASE_MAPMSG_BYTES. A reusable ipcbase has to
+ * take the next engine on the same port once the first one disconnected, and must not wake
+ * up flib_socket_wait for its port while an engine is connected.
+ */
+static void testMapReusable(int chunkSize) {
+    uint8_t stream[IPCBASE_MAPMSG_BYTES];
+    for(int i=0; i<IPCBASE_MAPMSG_BYTES; i++) {
+        stream[i] = messageByte(i, i/256);
+    }
+    flib_ipcbase *ipc = flib_ipcbase_create_reusable();
+    uint16_t port = flib_ipcbase_port(ipc);
+
+    for(int engine=0; ipc && engine<3; engine++) {
+        replay_setstream(stream, sizeof(stream), chunkSize, chunkSize+engine);
+        CHECK(flib_ipcbase_state(ipc) == IPC_LISTENING, "map engine %i: not listening", engine);
+        CHECK(replay_waitingacceptors() == 1, "map engine %i: not waiting for a connection", engine);
+        acceptEngine(ipc);
+        CHECK(replay_waitingacceptors() == 0, "map engine %i: waiting for a connection while connected", engine);
+
+        uint8_t map[IPCBASE_MAPMSG_BYTES];
+        int size = -1;
+        for(int calls=0; size<0 && calls<=IPCBASE_MAPMSG_BYTES; calls++) {
+            size = flib_ipcbase_recv_map(ipc, map);
+        }
+        CHECK(size == IPCBASE_MAPMSG_BYTES && !memcmp(map, stream, sizeof(map)),
+                "map engine %i, pieces of %i: map damaged", engine, chunkSize);
+
+        // The engine quits after sending the map
+        uint8_t *msg;
+        flib_ipcbase_receive(ipc);
+        CHECK(flib_ipcbase_next_message(ipc, &msg) < 0, "map engine %i: message after the map", engine);
+        CHECK(flib_ipcbase_port(ipc) == port, "map engine %i: port changed", engine);
+    }
+    flib_ipcbase_destroy(ipc);
+    CHECK(replay_waitingacceptors() == 0, "acceptor left open");
+}
+
+int main() {
+    for(size_t i=0; i<sizeof(chunkSizes)/sizeof(chunkSizes[0]); i++) {
+        testNextMessage(chunkSizes[i], 0);
+        testNextMessage(chunkSizes[i], 100);
+        testRecvMessage(chunkSizes[i]);
+        testMapReusable(chunkSizes[i]);
+    }
+    printf("ipcbase: %s\n", failures ? "FAILED" : "passed");
+    return failures ? 1 : 0;
+}
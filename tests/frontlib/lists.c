@@ -0,0 +1,285 @@
+/*
+ * Hedgewars, a free turn based strategy game
+ * Copyright (C) 2012 Simeon Maxein <smaxein@googlemail.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+/**
+ * Inserts into and deletes from the team, scheme and weapon set lists across
+ * the points where their arrays grow and shrink, and checks that the lists
+ * keep their elements in order.
+ */
+
+#include "model/teamlist.h"
+#include "model/schemelist.h"
+#include "model/weapon.h"
+#include "util/util.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_ITEMS 300
+
+/**
+ * The operations on one kind of list, so that all of them can run the same checks.
+ */
+typedef struct {
+    const char *name;
+    void *(*create)();
+    void (*destroy)(void *list);
+    int (*insert)(void *list, const char *name, int pos);
+    int (*delete)(void *list, int pos);
+    int (*reserve)(void *list, int capacity);
+    int (*count)(void *list);
+    int (*capacity)(void *list);
+    void *(*array)(void *list);
+    const char *(*nameAt)(void *list, int pos);
+    const void *(*find)(void *list, const char *name);  //!< NULL if the list can't search by name
+} listtype;
+
+static void *teamlistCreate() { return flib_teamlist_create(); }
+static void teamlistDestroy(void *list) { flib_teamlist_destroy(list); }
+static int teamlistInsert(void *list, const char *name, int pos) {
+    flib_team *team = flib_calloc(1, sizeof(flib_team));
+    if(!team) {
+        return -1;
+    }
+    team->name = flib_strdupnull(name);
+    if(flib_teamlist_insert(list, team, pos)) {
+        flib_team_destroy(team);
+        return -1;
+    }
+    return 0;
+}
+static int teamlistDelete(void *list, int pos) {
+    flib_teamlist *teamlist = list;
+    if(pos >= teamlist->teamCount) {
+        return -1;
+    }
+    return flib_teamlist_delete(teamlist, teamlist->teams[pos]->name);
+}
+static int teamlistReserve(void *list, int capacity) { return flib_teamlist_reserve(list, capacity); }
+static int teamlistCount(void *list) { return ((flib_teamlist*)list)->teamCount; }
+static int teamlistCapacity(void *list) { return ((flib_teamlist*)list)->teamCapacity; }
+static void *teamlistArray(void *list) { return ((flib_teamlist*)list)->teams; }
+static const char *teamlistNameAt(void *list, int pos) { return ((flib_teamlist*)list)->teams[pos]->name; }
+static const void *teamlistFind(void *list, const char *name) { return flib_teamlist_find(list, name); }
+
+static void *schemelistCreate() { return flib_schemelist_create(); }
+static void schemelistDestroy(void *list) { flib_schemelist_destroy(list); }
+static int schemelistInsert(void *list, const char *name, int pos) {
+    flib_scheme *scheme = flib_scheme_create(name);
+    if(!scheme || flib_schemelist_insert(list, scheme, pos)) {
+        flib_scheme_destroy(scheme);
+        return -1;
+    }
+    return 0;
+}
+static int schemelistDelete(void *list, int pos) { return flib_schemelist_delete(list, pos); }
+static int schemelistReserve(void *list, int capacity) { return flib_schemelist_reserve(list, capacity); }
+static int schemelistCount(void *list) { return ((flib_schemelist*)list)->schemeCount; }
+static int schemelistCapacity(void *list) { return ((flib_schemelist*)list)->schemeCapacity; }
+static void *schemelistArray(void *list) { return ((flib_schemelist*)list)->schemes; }
+static const char *schemelistNameAt(void *list, int pos) { return ((flib_schemelist*)list)->schemes[pos]->name; }
+static const void *schemelistFind(void *list, const char *name) { return flib_schemelist_find(list, name); }
+
+static void *weaponsetlistCreate() { return flib_weaponsetlist_create(); }
+static void weaponsetlistDestroy(void *list) { flib_weaponsetlist_destroy(list); }
+static int weaponsetlistInsert(void *list, const char *name, int pos) {
+    flib_weaponset *set = flib_weaponset_create(name);
+    if(!set || flib_weaponsetlist_insert(list, set, pos)) {
+        flib_weaponset_destroy(set);
+        return -1;
+    }
+    return 0;
+}
+static int weaponsetlistDelete(void *list, int pos) { return flib_weaponsetlist_delete(list, pos); }
+static int weaponsetlistReserve(void *list, int capacity) { return flib_weaponsetlist_reserve(list, capacity); }
+static int weaponsetlistCount(void *list) { return ((flib_weaponsetlist*)list)->weaponsetCount; }
+static int weaponsetlistCapacity(void *list) { return ((flib_weaponsetlist*)list)->weaponsetCapacity; }
+static void *weaponsetlistArray(void *list) { return ((flib_weaponsetlist*)list)->weaponsets; }
+static const char *weaponsetlistNameAt(void *list, int pos) { return ((flib_weaponsetlist*)list)->weaponsets[pos]->name; }
+
+static const listtype listtypes[] = {
+    {"teamlist", teamlistCreate, teamlistDestroy, teamlistInsert, teamlistDelete, teamlistReserve,
+            teamlistCount, teamlistCapacity, teamlistArray, teamlistNameAt, teamlistFind},
+    {"schemelist", schemelistCreate, schemelistDestroy, schemelistInsert, schemelistDelete, schemelistReserve,
+            schemelistCount, schemelistCapacity, schemelistArray, schemelistNameAt, schemelistFind},
+    {"weaponsetlist", weaponsetlistCreate, weaponsetlistDestroy, weaponsetlistInsert, weaponsetlistDelete, weaponsetlistReserve,
+            weaponsetlistCount, weaponsetlistCapacity, weaponsetlistArray, weaponsetlistNameAt, NULL}
+};
+
+static int failures;
+
+#define CHECK(cond, ...) do { \
+        if(!(cond)) { \
+            failures++; \
+            printf("FAIL %s:%d: ", __FILE__, __LINE__); \
+            printf(__VA_ARGS__); \
+            printf("\n"); \
+            return; \
+        } \
+    } while(0)
+
+/**
+ * The list as it should be: the ids of its elements in order.
+ */
+typedef struct {
+    int ids[MAX_ITEMS];
+    int count;
+} reference;
+
+static void itemName(char *buf, int id) {
+    sprintf(buf, "item %d", id);
+}
+
+static void checkList(const listtype *type, void *list, const reference *ref, const char *step) {
+    char name[32];
+    int count = type->count(list);
+    int capacity = type->capacity(list);
+    CHECK(count == ref->count, "%s %s: %i elements, expected %i", type->name, step, count, ref->count);
+    CHECK(capacity >= count, "%s %s: capacity %i for %i elements", type->name, step, capacity, count);
+    CHECK((count == 0) == (type->array(list) == NULL), "%s %s: array allocated for %i elements", type->name, step, count);
+    for(int i=0; i<count; i++) {
+        itemName(name, ref->ids[i]);
+        CHECK(!strcmp(type->nameAt(list, i), name), "%s %s: \"%s\" at %i, expected \"%s\"",
+                type->name, step, type->nameAt(list, i), i, name);
+        if(type->find) {
+            CHECK(type->find(list, name) != NULL, "%s %s: \"%s\" not found", type->name, step, name);
+        }
+    }
+}
+
+static void insertAt(const listtype *type, void *list, reference *ref, int id, int pos) {
+    char name[32];
+    itemName(name, id);
+    CHECK(!type->insert(list, name, pos), "%s: inserting at %i of %i failed", type->name, pos, ref->count);
+    memmove(ref->ids+pos+1, ref->ids+pos, (ref->count-pos)*sizeof(int));
+    ref->ids[pos] = id;
+    ref->count++;
+}
+
+static void deleteAt(const listtype *type, void *list, reference *ref, int pos) {
+    char name[32];
+    itemName(name, ref->ids[pos]);
+    CHECK(!type->delete(list, pos), "%s: deleting at %i of %i failed", type->name, pos, ref->count);
+    memmove(ref->ids+pos, ref->ids+pos+1, (ref->count-pos-1)*sizeof(int));
+    ref->count--;
+    if(type->find) {
+        CHECK(type->find(list, name) == NULL, "%s: \"%s\" still found after deleting it", type->name, name);
+    }
+}
+
+static void testList(const listtype *type) {
+    reference ref = {{0}, 0};
+    void *list = type->create();
+    CHECK(list, "%s: create failed", type->name);
+    checkList(type, list, &ref, "when new");
+
+    // Grow one element at a time, at the end, at the front and in the middle,
+    // so that the array is reallocated several times.
+    int nextId = 0;
+    int grown = 0;
+    for(int i=0; i<MAX_ITEMS; i++) {
+        int oldCapacity = type->capacity(list);
+        int pos = i%3==0 ? ref.count : i%3==1 ? 0 : ref.count/2;
+        insertAt(type, list, &ref, nextId++, pos);
+        if(type->capacity(list) != oldCapacity) {
+            grown++;
+        }
+        checkList(type, list, &ref, "after insert");
+    }
+    // doubling needs only a few reallocations, not one per insert
+    CHECK(grown > 1 && grown < 10, "%s: capacity changed %i times for %i inserts", type->name, grown, MAX_ITEMS);
+
+    // Invalid positions must leave the list alone.
+    CHECK(type->insert(list, "invalid", ref.count+1), "%s: insert behind the end succeeded", type->name);
+    CHECK(type->insert(list, "invalid", -1), "%s: insert at -1 succeeded", type->name);
+    CHECK(type->delete(list, ref.count), "%s: delete behind the end succeeded", type->name);
+    checkList(type, list, &ref, "after invalid operations");
+
+    // Shrink from alternating ends and the middle, through all the points where
+    // the array is reallocated to a smaller size, down to an empty list.
+    int shrunk = 0;
+    for(int i=0; ref.count>0; i++) {
+        int oldCapacity = type->capacity(list);
+        int pos = i%3==0 ? ref.count-1 : i%3==1 ? 0 : ref.count/2;
+        deleteAt(type, list, &ref, pos);
+        if(type->capacity(list) < oldCapacity) {
+            shrunk++;
+        }
+        checkList(type, list, &ref, "after delete");
+    }
+    CHECK(shrunk > 1, "%s: capacity never shrunk", type->name);
+    CHECK(type->capacity(list) == 0, "%s: capacity %i when empty", type->name, type->capacity(list));
+
+    // Reserving must not change the contents, and inserting up to the reserved
+    // capacity must not move the array.
+    for(int i=0; i<5; i++) {
+        insertAt(type, list, &ref, nextId++, ref.count);
+    }
+    CHECK(!type->reserve(list, 100), "%s: reserve failed", type->name);
+    CHECK(type->capacity(list) >= 100, "%s: capacity %i after reserving 100", type->name, type->capacity(list));
+    checkList(type, list, &ref, "after reserve");
+    void *array = type->array(list);
+    while(ref.count < 100) {
+        insertAt(type, list, &ref, nextId++, ref.count/3);
+    }
+    CHECK(type->array(list) == array, "%s: array moved while filling the reserved capacity", type->name);
+    CHECK(!type->reserve(list, 10), "%s: reserving less than the size failed", type->name);
+    checkList(type, list, &ref, "after filling the reserved capacity");
+
+    type->destroy(list);
+}
+
+/**
+ * Teams with the same name can be in a list, deleting and finding a team by name
+ * uses the first of them.
+ */
+static void testDuplicateNames() {
+    reference ref = {{0}, 0};
+    const listtype *type = &listtypes[0];
+    flib_teamlist *list = type->create();
+    CHECK(list, "duplicate names: create failed");
+    for(int i=0; i<40; i++) {
+        insertAt(type, list, &ref, i%4, ref.count);
+    }
+    char name[32];
+    for(int i=0; i<4; i++) {
+        itemName(name, i);
+        CHECK(flib_teamlist_find(list, name) == list->teams[i], "duplicate names: \"%s\" is not the first", name);
+    }
+    itemName(name, 2);
+    CHECK(!flib_teamlist_delete(list, name), "duplicate names: deleting \"%s\" failed", name);
+    memmove(ref.ids+2, ref.ids+3, (ref.count-3)*sizeof(int));
+    ref.count--;
+    checkList(type, list, &ref, "after deleting a duplicate");
+    CHECK(flib_teamlist_find(list, name) == list->teams[5], "duplicate names: \"%s\" is not the next one", name);
+    type->destroy(list);
+}
+
+int main() {
+    for(size_t i=0; i<sizeof(listtypes)/sizeof(listtypes[0]); i++) {
+        int oldFailures = failures;
+        testList(&listtypes[i]);
+        printf("%s: %s\n", listtypes[i].name, failures==oldFailures ? "passed" : "FAILED");
+    }
+    int oldFailures = failures;
+    testDuplicateNames();
+    printf("duplicate names: %s\n", failures==oldFailures ? "passed" : "FAILED");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,146 @@
+/*
+ * Hedgewars, a free turn based strategy game
+ * Copyright (C) 2012 Simeon Maxein <smaxein@googlemail.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+
+/**
+ * Runs flib_mapbatch against replayed engines: every engine that connects sends the same
+ * map preview and quits. Checks that each map is reported exactly once, and that maps whose
+ * engine never connects fail after the connect timeout instead of holding up the batch.
+ */
+
+#include "frontlib.h"
+#include "ipc/ipcbase.h"
+#include "replaysocket.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define MAP_COUNT 7
+#define WORKER_COUNT 3
+#define HOG_COUNT 17
+
+static int failures;
+
+#define CHECK(cond, ...) do { \
+        if(!(cond)) { \
+            failures++; \
+            printf("FAIL line %i: ", __LINE__); \
+            printf(__VA_ARGS__); \
+            printf("\n"); \
+        } \
+    } while(0)
+
+typedef struct {
+    int engineStarts;
+    int previews[MAP_COUNT];
+    int failures[MAP_COUNT];
+    const uint8_t *expectedMap;
+} batchresults;
+
+static void handleStartEngine(void *context, int port) {
+    batchresults *results = context;
+    results->engineStarts++;
+}
+
+static void handlePreview(void *context, int index, const uint8_t *bitmap, int numHedgehogs) {
+    batchresults *results = context;
+    results->previews[index]++;
+    CHECK(!memcmp(bitmap, results->expectedMap, IPCBASE_MAPMSG_BYTES-1), "map %i: preview damaged", index);
+    CHECK(numHedgehogs == HOG_COUNT, "map %i: %i hedgehogs", index, numHedgehogs);
+}
+
+static void handleFailure(void *context, int index, const char *errormessage) {
+    batchresults *results = context;
+    results->failures[index]++;
+}
+
+/**
+ * Runs a batch of MAP_COUNT maps until it is finished, for at most 10 seconds.
+ */
+static void runBatch(batchresults *results, int connectTimeout) {
+    flib_map *maps[MAP_COUNT];
+    for(int i=0; i<MAP_COUNT; i++) {
+        char seed[32];
+        snprintf(seed, sizeof(seed), "mapbatch%i", i);
+        maps[i] = flib_map_create_regular(seed, "Nature", TEMPLATEFILTER_ALL);
+    }
+
+    flib_mapbatch *batch = flib_mapbatch_create((const flib_map**)maps, MAP_COUNT, WORKER_COUNT);
+    CHECK(batch, "batch not created");
+    if(batch) {
+        flib_mapbatch_onStartEngine(batch, handleStartEngine, results);
+        flib_mapbatch_onPreview(batch, handlePreview, results);
+        flib_mapbatch_onFailure(batch, handleFailure, results);
+        flib_mapbatch_setConnectTimeout(batch, connectTimeout);
+
+        time_t start = time(NULL);
+        while(!flib_mapbatch_finished(batch) && difftime(time(NULL), start) < 10) {
+            flib_run_until(0);
+        }
+        CHECK(flib_mapbatch_finished(batch), "batch not finished");
+    }
+    flib_mapbatch_destroy(batch);
+    for(int i=0; i<MAP_COUNT; i++) {
+        flib_map_destroy(maps[i]);
+    }
+}
+
+static void testPreviews() {
+    uint8_t stream[IPCBASE_MAPMSG_BYTES];
+    for(int i=0; i<IPCBASE_MAPMSG_BYTES-1; i++) {
+        stream[i] = (uint8_t)(i*7);
+    }
+    stream[IPCBASE_MAPMSG_BYTES-1] = HOG_COUNT;
+    replay_setstream(stream, sizeof(stream), 1000, 1);
+
+    batchresults results = {.expectedMap = stream};
+    size_t sentBefore = replay_sentbytes();
+    runBatch(&results, 30);
+
+    CHECK(results.engineStarts == MAP_COUNT, "%i engines started", results.engineStarts);
+    for(int i=0; i<MAP_COUNT; i++) {
+        CHECK(results.previews[i] == 1 && results.failures[i] == 0, "map %i: %i previews, %i failures",
+                i, results.previews[i], results.failures[i]);
+    }
+    CHECK(replay_sentbytes() > sentBefore, "no map config sent");
+    CHECK(replay_waitingacceptors() == 0, "acceptors left open");
+}
+
+static void testConnectTimeout() {
+    replay_setaccepting(false);
+    batchresults results = {.expectedMap = NULL};
+    runBatch(&results, 0);
+    replay_setaccepting(true);
+
+    CHECK(results.engineStarts == MAP_COUNT, "%i engines started", results.engineStarts);
+    for(int i=0; i<MAP_COUNT; i++) {
+        CHECK(results.previews[i] == 0 && results.failures[i] == 1, "map %i: %i previews, %i failures",
+                i, results.previews[i], results.failures[i]);
+    }
+}
+
+int main() {
+    flib_log_setLevel(FLIB_LOGLEVEL_NONE);
+    testPreviews();
+    testConnectTimeout();
+    printf("mapbatch: %s\n", failures ? "FAILED" : "passed");
+    return failures ? 1 : 0;
+}
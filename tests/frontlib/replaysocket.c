@@ -0,0 +1,135 @@
+/*
+ * Hedgewars, a free turn based strategy game
+ * Copyright (C) 2012 Simeon Maxein <smaxein@googlemail.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+
+#include "replaysocket.h"
+#include "util/util.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+struct _flib_tcpsocket {
+    size_t pos;
+};
+
+struct _flib_acceptor {
+    uint16_t port;
+    bool waiting;
+};
+
+static const uint8_t *stream;
+static size_t streamLen;
+static int streamMaxChunk = 1;
+static unsigned chunkState;
+static size_t sentBytes;
+static bool accepting = true;
+static int waitingAcceptors;
+
+void replay_setstream(const uint8_t *data, size_t len, int maxChunk, unsigned seed) {
+    stream = data;
+    streamLen = len;
+    streamMaxChunk = maxChunk>0 ? maxChunk : 1;
+    chunkState = seed;
+}
+
+size_t replay_sentbytes() {
+    return sentBytes;
+}
+
+void replay_setaccepting(bool enabled) {
+    accepting = enabled;
+}
+
+int replay_waitingacceptors() {
+    return waitingAcceptors;
+}
+
+// Small LCG instead of rand(), so the pieces don't depend on the C library
+static int nextChunkSize() {
+    chunkState = chunkState*1103515245u + 12345u;
+    return 1 + (int)((chunkState>>16) % (unsigned)streamMaxChunk);
+}
+
+flib_acceptor *flib_acceptor_create(uint16_t port) {
+    flib_acceptor *result = flib_calloc(1, sizeof(flib_acceptor));
+    if(result) {
+        result->port = port>0 ? port : 49152;
+        result->waiting = true;
+        waitingAcceptors++;
+    }
+    return result;
+}
+
+uint16_t flib_acceptor_listenport(flib_acceptor *acceptor) {
+    return acceptor ? acceptor->port : 0;
+}
+
+void flib_acceptor_setWaiting(flib_acceptor *acceptor, bool waiting) {
+    if(acceptor && acceptor->waiting != waiting) {
+        acceptor->waiting = waiting;
+        waitingAcceptors += waiting ? 1 : -1;
+    }
+}
+
+void flib_acceptor_close(flib_acceptor *acceptor) {
+    if(acceptor) {
+        flib_acceptor_setWaiting(acceptor, false);
+        free(acceptor);
+    }
+}
+
+flib_tcpsocket *flib_socket_accept(flib_acceptor *acceptor, bool localOnly) {
+    return acceptor && accepting ? flib_calloc(1, sizeof(flib_tcpsocket)) : NULL;
+}
+
+flib_tcpsocket *flib_socket_connect(const char *host, uint16_t port) {
+    return host && port>0 ? flib_calloc(1, sizeof(flib_tcpsocket)) : NULL;
+}
+
+void flib_socket_close(flib_tcpsocket *sock) {
+    free(sock);
+}
+
+int flib_socket_nbrecv(flib_tcpsocket *sock, void *data, int maxlen) {
+    if(!sock || (maxlen>0 && !data) || sock->pos >= streamLen) {
+        return -1;
+    }
+    size_t size = nextChunkSize();
+    if(size > (size_t)maxlen) {
+        size = maxlen;
+    }
+    if(size > streamLen-sock->pos) {
+        size = streamLen-sock->pos;
+    }
+    memcpy(data, stream+sock->pos, size);
+    sock->pos += size;
+    return (int)size;
+}
+
+int flib_socket_send(flib_tcpsocket *sock, const void *data, int len) {
+    if(!sock || (len>0 && !data)) {
+        return -1;
+    }
+    sentBytes += len;
+    return len;
+}
+
+int flib_socket_wait(uint32_t timeout) {
+    return 1;
+}
@@ -0,0 +1,62 @@
+/*
+ * Hedgewars, a free turn based strategy game
+ * Copyright (C) 2012 Simeon Maxein <smaxein@googlemail.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+
+/**
+ * A stand-in for the frontlib's SDL_net sockets that replays a byte stream from memory,
+ * so that the IPC and net protocol code can be tested and timed without a network.
+ *
+ * Every socket that is accepted or connected reads the stream set with replay_setstream,
+ * handed out in pieces of a random size between 1 and maxChunk bytes, like a TCP stream
+ * would arrive. Once the stream is used up the socket reports the connection as closed.
+ * Everything sent to a socket is counted and thrown away. Acceptors have a connection
+ * waiting whenever one is accepted, unless that is turned off with replay_setaccepting.
+ */
+
+#ifndef REPLAYSOCKET_H_
+#define REPLAYSOCKET_H_
+
+#include "socket.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Replay the len bytes at data (which must stay valid) on the next socket, in pieces of
+ * at most maxChunk bytes. The same seed gives the same pieces every time.
+ */
+void replay_setstream(const uint8_t *data, size_t len, int maxChunk, unsigned seed);
+
+/**
+ * The number of bytes sent to replay sockets so far.
+ */
+size_t replay_sentbytes();
+
+/**
+ * Whether acceptors have a connection waiting, true by default.
+ */
+void replay_setaccepting(bool enabled);
+
+/**
+ * The number of acceptors flib_socket_wait would wake up for.
+ */
+int replay_waitingacceptors();
+
+#endif /* REPLAYSOCKET_H_ */
@@ -0,0 +1,153 @@
+/*
+ * Hedgewars, a free turn based strategy game
+ * Copyright (c) 2004-2015 Andrey Korotaev <unC0Rr@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+/*
+ * hwrender: renders every demo of a directory to a video without the
+ * frontend, running several engines at once, and prints a JSON report.
+ *
+ * Only demos that were recorded with the video key can be rendered: the
+ * engine replays the camera positions saved in <demo>.txtout next to the
+ * demo (and the sound in <demo>.sw, if any), so copy those along with the
+ * .hwd files from VideoTemp/.
+ *
+ * Example:
+ *   hwrender --data-dir /usr/share/hedgewars/Data --software --jobs 4 demos/
+ */
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QTemporaryDir>
+#include <QThread>
+#include <QDir>
+#include <QFile>
+#include <QTextStream>
+
+#include "renderer.h"
+
+static int fatal(const QString & message)
+{
+    QTextStream(stderr) << "hwrender: " << message << "\n";
+    return 2;
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("hwrender");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Renders all demos of a directory to videos.");
+    parser.addHelpOption();
+    parser.addPositionalArgument("demos", "Directory with the .hwd files and their .txtout camera files.");
+
+    QCommandLineOption engineOption("engine", "Engine executable.", "path", "hwengine");
+    QCommandLineOption dataOption("data-dir", "Hedgewars Data directory.", "path");
+    QCommandLineOption userOption("user-dir", "User directory for the engine (a temporary one by default).", "path");
+    QCommandLineOption outputOption("output", "Directory for the videos (default: the demo directory).", "path");
+    QCommandLineOption jobsOption("jobs", "Number of engines running at once.", "n",
+                                  QString::number(qMax(1, QThread::idealThreadCount()/2)));
+    QCommandLineOption formatOption("format", "Container format.", "format", "mp4");
+    QCommandLineOption vcodecOption("vcodec", "Video codec.", "codec", "libx264");
+    QCommandLineOption acodecOption("acodec", "Audio codec, \"no\" for silent videos.", "codec", "aac");
+    QCommandLineOption widthOption("width", "Video width.", "pixels", "1280");
+    QCommandLineOption heightOption("height", "Video height.", "pixels", "720");
+    QCommandLineOption framerateOption("framerate", "Frames per second.", "fps", "30");
+    QCommandLineOption bitrateOption("bitrate", "Video bitrate in kbit/s.", "kbit", "1000");
+    QCommandLineOption softwareOption("software", "Use software OpenGL and no display, for servers.");
+    QCommandLineOption reportOption("report", "Write the JSON report to a file instead of stdout.", "file");
+    QCommandLineOption verboseOption("verbose", "Show the output of the engines.");
+    parser.addOption(engineOption);
+    parser.addOption(dataOption);
+    parser.addOption(userOption);
+    parser.addOption(outputOption);
+    parser.addOption(jobsOption);
+    parser.addOption(formatOption);
+    parser.addOption(vcodecOption);
+    parser.addOption(acodecOption);
+    parser.addOption(widthOption);
+    parser.addOption(heightOption);
+    parser.addOption(framerateOption);
+    parser.addOption(bitrateOption);
+    parser.addOption(softwareOption);
+    parser.addOption(reportOption);
+    parser.addOption(verboseOption);
+    parser.process(app);
+
+    if (parser.positionalArguments().size() != 1)
+        parser.showHelp(2);
+    if (!parser.isSet(dataOption))
+        return fatal("--data-dir is required");
+
+    QDir demoDir(parser.positionalArguments().first());
+    if (!demoDir.exists())
+        return fatal("no such directory: " + demoDir.path());
+
+    RenderSettings settings;
+    settings.engine = parser.value(engineOption);
+    settings.dataDir = QDir(parser.value(dataOption)).absolutePath();
+    settings.format = parser.value(formatOption);
+    settings.videoCodec = parser.value(vcodecOption);
+    settings.audioCodec = parser.value(acodecOption);
+    settings.width = parser.value(widthOption).toInt();
+    settings.height = parser.value(heightOption).toInt();
+    settings.framerate = parser.value(framerateOption).toInt();
+    settings.bitrate = parser.value(bitrateOption).toInt();
+    settings.software = parser.isSet(softwareOption);
+    settings.verbose = parser.isSet(verboseOption);
+    int jobs = parser.value(jobsOption).toInt();
+    if (settings.width <= 0 || settings.height <= 0 || settings.framerate <= 0 ||
+        settings.bitrate <= 0 || jobs <= 0)
+        return fatal("sizes, frame rate, bitrate and jobs must be positive numbers");
+
+    QTemporaryDir tempDir;
+    if (parser.isSet(userOption))
+        settings.userDir = QDir(parser.value(userOption)).absolutePath();
+    else if (tempDir.isValid())
+        settings.userDir = tempDir.path();
+    else
+        return fatal("could not create a temporary user directory");
+    if (!QDir().mkpath(settings.userDir + "/VideoTemp"))
+        return fatal("could not create " + settings.userDir + "/VideoTemp");
+
+    settings.outputDir = QDir(parser.isSet(outputOption) ?
+                              parser.value(outputOption) : demoDir.path()).absolutePath();
+    if (!QDir().mkpath(settings.outputDir))
+        return fatal("could not create " + settings.outputDir);
+
+    Renderer renderer(settings, jobs);
+    QStringList demos = demoDir.entryList(QStringList("*.hwd"), QDir::Files, QDir::Name);
+    foreach (const QString & demo, demos)
+        renderer.addDemo(demoDir.absoluteFilePath(demo));
+
+    QObject::connect(&renderer, SIGNAL(done()), &app, SLOT(quit()), Qt::QueuedConnection);
+    renderer.start();
+    app.exec();
+
+    QByteArray report = renderer.report();
+    if (parser.isSet(reportOption))
+    {
+        QFile file(parser.value(reportOption));
+        if (!file.open(QIODevice::WriteOnly) || file.write(report) != report.size())
+            return fatal("could not write " + file.fileName());
+    }
+    else
+        QTextStream(stdout) << report;
+
+    return renderer.allSucceeded() ? 0 : 1;
+}
@@ -0,0 +1,481 @@
+/*
+ * Hedgewars, a free turn based strategy game
+ * Copyright (c) 2004-2015 Andrey Korotaev <unC0Rr@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QHostAddress>
+#include <QFile>
+#include <QFileInfo>
+#include <QDir>
+#include <QProcessEnvironment>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QTextStream>
+
+#include "renderer.h"
+
+// size of TFrame in uVideoRec.pas, the records of the camera file
+static const int cameraFrameSize = 20;
+
+static void printLine(const QString & line)
+{
+    QTextStream(stderr) << line << "\n";
+}
+
+// the camera file recorded along with a demo, empty if there is none
+static QString cameraFile(const QString & demoPath)
+{
+    QFileInfo info(demoPath);
+    QString base = info.dir().absoluteFilePath(info.completeBaseName());
+    if (QFile::exists(base + ".txtout"))
+        return base + ".txtout";
+    if (QFile::exists(base + ".txtin"))
+        return base + ".txtin";
+    return QString();
+}
+
+// length of a recording in ms, read from the time stamp of the last camera position
+static qint64 recordedDuration(const QString & path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly))
+        return 0;
+    qint64 frames = file.size() / cameraFrameSize;
+    quint32 realTicks;
+    if (frames == 0 || !file.seek((frames - 1) * cameraFrameSize) ||
+        file.read((char*)&realTicks, sizeof(realTicks)) != sizeof(realTicks))
+        return 0;
+    return realTicks;
+}
+
+RenderJob::RenderJob(const RenderSettings & settings, const QString & demoPath) :
+    m_settings(settings)
+{
+    this->demoPath = demoPath;
+    name = QFileInfo(demoPath).completeBaseName();
+    skipped = false;
+    succeeded = false;
+    progress = 0;
+    duration = 0;
+    elapsed = 0;
+    size = 0;
+    m_process = 0;
+    m_done = false;
+    m_ended = false;
+}
+
+RenderJob::~RenderJob()
+{
+    if (m_process && m_process->state() != QProcess::NotRunning)
+    {
+        m_process->kill();
+        m_process->waitForFinished(1000);
+    }
+}
+
+// puts the demo and what was recorded along with it where the engine expects them
+bool RenderJob::prepare()
+{
+    QString camera = cameraFile(demoPath);
+    if (camera.isEmpty())
+    {
+        // the recorder replays the camera positions of the original game,
+        // they are only saved when the game was recorded with the video key
+        skipped = true;
+        error = "no camera file (.txtout) next to the demo";
+        return false;
+    }
+    duration = recordedDuration(camera);
+
+    QFile demoFile(demoPath);
+    if (!demoFile.open(QIODevice::ReadOnly) || (m_demo = demoFile.readAll()).isEmpty())
+    {
+        error = "could not read the demo";
+        return false;
+    }
+    // same as HWRecorder::EncodeVideo: play the demo as a video recording
+    m_demo.replace(QByteArray("\x02TD"), QByteArray("\x02TV"));
+    m_demo.replace(QByteArray("\x02TL"), QByteArray("\x02TV"));
+    m_demo.replace(QByteArray("\x02TN"), QByteArray("\x02TV"));
+    m_demo.replace(QByteArray("\x02TS"), QByteArray("\x02TV"));
+
+    QDir temp(m_settings.userDir + "/VideoTemp");
+    temp.remove(name + ".txtin");
+    if (!QFile::copy(camera, temp.absoluteFilePath(name + ".txtin")))
+    {
+        error = "could not copy the camera file to " + temp.absolutePath();
+        return false;
+    }
+    QString sound = QFileInfo(demoPath).dir().absoluteFilePath(name + ".sw");
+    temp.remove(name + ".sw");
+    if (m_settings.audioCodec != "no" && QFile::exists(sound))
+        QFile::copy(sound, temp.absoluteFilePath(name + ".sw"));
+    return true;
+}
+
+// same as HWRecorder::getArguments with the default frontend options
+QStringList RenderJob::arguments() const
+{
+    QStringList arguments;
+    arguments << "--internal";
+    arguments << "--port";
+    arguments << QString::number(m_server->serverPort());
+    arguments << "--prefix";
+    arguments << m_settings.dataDir;
+    arguments << "--user-prefix";
+    arguments << m_settings.userDir;
+    arguments << "--locale";
+    arguments << "en.txt";
+    arguments << "--frame-interval";
+    arguments << "8";
+    arguments << "--width";
+    arguments << QString::number(m_settings.width);
+    arguments << "--height";
+    arguments << QString::number(m_settings.height);
+    arguments << "--nosound";
+    arguments << "--raw-quality";
+    arguments << "0";
+    arguments << "--stereo";
+    arguments << "0";
+    arguments << "--nomusic";
+    arguments << "--volume";
+    arguments << "0";
+    arguments << "--recorder";
+    arguments << QString::number(m_settings.framerate); //cVideoFramerateNum
+    arguments << "1"; //cVideoFramerateDen
+    arguments << name;
+    arguments << m_settings.format;
+    arguments << m_settings.videoCodec;
+    arguments << QString::number(m_settings.bitrate*1024);
+    arguments << m_settings.audioCodec;
+    arguments << "--chat-size";
+    arguments << "100";
+    return arguments;
+}
+
+void RenderJob::start()
+{
+    m_timer.start();
+    if (!prepare())
+    {
+        end();
+        return;
+    }
+
+    m_server = new QTcpServer(this);
+    m_server->setMaxPendingConnections(1);
+    if (!m_server->listen(QHostAddress::LocalHost))
+    {
+        fail("could not listen for the engine: " + m_server->errorString());
+        return;
+    }
+    connect(m_server, SIGNAL(newConnection()), this, SLOT(newConnection()));
+
+    m_process = new QProcess(this);
+    connect(m_process, SIGNAL(errorOccurred(QProcess::ProcessError)),
+            this, SLOT(processError(QProcess::ProcessError)));
+    connect(m_process, SIGNAL(finished(int, QProcess::ExitStatus)),
+            this, SLOT(processFinished(int, QProcess::ExitStatus)));
+    if (m_settings.verbose)
+        m_process->setProcessChannelMode(QProcess::ForwardedChannels);
+    else
+    {
+        m_process->setStandardOutputFile(QProcess::nullDevice());
+        m_process->setStandardErrorFile(QProcess::nullDevice());
+    }
+    if (m_settings.software)
+    {
+        QProcessEnvironment env = QProcessEnvironment::systemEnvironment();
+        env.insert("LIBGL_ALWAYS_SOFTWARE", "1");
+        if (!env.contains("SDL_VIDEODRIVER"))
+            env.insert("SDL_VIDEODRIVER", "offscreen");
+        m_process->setProcessEnvironment(env);
+    }
+    m_process->start(m_settings.engine, arguments());
+}
+
+void RenderJob::newConnection()
+{
+    if (m_socket)
+        return;
+    m_socket = m_server->nextPendingConnection();
+    if (!m_socket)
+        return;
+    // nobody else is expected
+    m_server->close();
+
+    connect(m_socket, SIGNAL(readyRead()), this, SLOT(readyRead()));
+    m_socket->write(m_demo);
+}
+
+void RenderJob::readyRead()
+{
+    m_readBuffer.append(m_socket->readAll());
+
+    // messages are a length byte followed by that many bytes
+    int pos = 0;
+    while (pos < m_readBuffer.size() && pos + 1 + quint8(m_readBuffer.at(pos)) <= m_readBuffer.size())
+    {
+        int len = quint8(m_readBuffer.at(pos));
+        QByteArray msg = m_readBuffer.mid(pos + 1, len);
+        pos += 1 + len;
+        if (msg.isEmpty())
+            continue;
+
+        switch (msg.at(0))
+        {
+        case '?':
+            m_socket->write(QByteArray("\x01!", 2));
+            break;
+        case 'p':
+            if (msg.size() >= 3)
+                progress = (quint8(msg.at(1))*256.0 + quint8(msg.at(2)))*0.0001;
+            break;
+        case 'v':
+            m_done = true;
+            break;
+        case 'E':
+            error = QString::fromUtf8(msg.mid(1));
+            break;
+        }
+    }
+    m_readBuffer.remove(0, pos);
+}
+
+void RenderJob::processError(QProcess::ProcessError processError)
+{
+    if (processError == QProcess::FailedToStart)
+        fail("could not start " + m_settings.engine + ": " + m_process->errorString());
+}
+
+void RenderJob::processFinished(int exitCode, QProcess::ExitStatus exitStatus)
+{
+    if (m_socket)
+        readyRead();
+    if (!m_done)
+    {
+        if (error.isEmpty())
+            error = exitStatus == QProcess::CrashExit ? QString("engine crashed") :
+                QString("engine exited with code %1 before the video was complete").arg(exitCode);
+        fail(error);
+        return;
+    }
+    collectOutput();
+    cleanup();
+    end();
+}
+
+// moves the finished video from VideoTemp to the output directory
+void RenderJob::collectOutput()
+{
+    QDir temp(m_settings.userDir + "/VideoTemp");
+    QStringList candidates = temp.entryList(QStringList(name + ".*"), QDir::Files);
+    foreach (const QString & file, candidates)
+    {
+        // The engine adds the first extension of the container format, which is not
+        // always the format name (matroska writes .mkv), so accept any extension.
+        // But it has to be a single one: game.2.mp4 belongs to the job of game.2.hwd
+        // which may be running at the same time, not to the one of game.hwd.
+        QString extension = file.mid(name.length() + 1);
+        if (extension.contains('.') || extension == "txtin" || extension == "sw")
+            continue;
+        QString destination = QDir(m_settings.outputDir).absoluteFilePath(file);
+        QFile::remove(destination);
+        if (!QFile::rename(temp.absoluteFilePath(file), destination) &&
+            !(QFile::copy(temp.absoluteFilePath(file), destination) && temp.remove(file)))
+        {
+            error = "could not move the video to " + destination;
+            return;
+        }
+        outputPath = destination;
+        size = QFileInfo(destination).size();
+        succeeded = true;
+        return;
+    }
+    error = "the engine did not write a video";
+}
+
+void RenderJob::cleanup()
+{
+    QDir temp(m_settings.userDir + "/VideoTemp");
+    temp.remove(name + ".txtin");
+    temp.remove(name + ".sw");
+}
+
+void RenderJob::fail(const QString & message)
+{
+    error = message;
+    succeeded = false;
+    if (m_process && m_process->state() != QProcess::NotRunning)
+        m_process->kill();
+    cleanup();
+    end();
+}
+
+void RenderJob::end()
+{
+    if (m_ended)
+        return;
+    m_ended = true;
+    elapsed = m_timer.elapsed();
+    if (m_server)
+        m_server->close();
+    if (m_socket)
+        m_socket->close();
+    emit finished();
+}
+
+Renderer::Renderer(const RenderSettings & settings, int maxEngines) :
+    m_settings(settings)
+{
+    m_maxEngines = qMax(1, maxEngines);
+    m_running = 0;
+    m_numFinished = 0;
+    m_elapsed = 0;
+}
+
+Renderer::~Renderer()
+{
+    qDeleteAll(m_jobs);
+}
+
+void Renderer::addDemo(const QString & demoPath)
+{
+    RenderJob * job = new RenderJob(m_settings, demoPath);
+    connect(job, SIGNAL(finished()), this, SLOT(jobFinished()), Qt::QueuedConnection);
+    m_jobs.append(job);
+    m_queue.append(job);
+}
+
+void Renderer::start()
+{
+    m_timer.start();
+    if (m_jobs.isEmpty())
+    {
+        emit done();
+        return;
+    }
+    while (m_running < m_maxEngines && !m_queue.isEmpty())
+        startNext();
+}
+
+void Renderer::startNext()
+{
+    RenderJob * job = m_queue.takeFirst();
+    m_running++;
+    job->start();
+}
+
+void Renderer::jobFinished()
+{
+    RenderJob * job = (RenderJob*)sender();
+    m_running--;
+    m_numFinished++;
+
+    QString status;
+    if (job->succeeded)
+        status = QString("done in %1 s").arg(job->elapsed/1000.0, 0, 'f', 1);
+    else
+        status = QString(job->skipped ? "skipped: " : "failed: ") + job->error;
+    printLine(QString("[%1/%2] %3: %4").arg(m_numFinished).arg(m_jobs.size()).arg(job->name).arg(status));
+
+    if (!m_queue.isEmpty())
+        startNext();
+    else if (m_running == 0)
+    {
+        m_elapsed = m_timer.elapsed();
+        emit done();
+    }
+}
+
+bool Renderer::allSucceeded() const
+{
+    foreach (const RenderJob * job, m_jobs)
+        if (!job->succeeded)
+            return false;
+    return true;
+}
+
+QByteArray Renderer::report() const
+{
+    QJsonObject settings;
+    settings["format"] = m_settings.format;
+    settings["video_codec"] = m_settings.videoCodec;
+    settings["audio_codec"] = m_settings.audioCodec;
+    settings["width"] = m_settings.width;
+    settings["height"] = m_settings.height;
+    settings["framerate"] = m_settings.framerate;
+    settings["bitrate_kbit"] = m_settings.bitrate;
+    settings["software_rendering"] = m_settings.software;
+
+    QJsonArray jobs;
+    int numDone = 0, numFailed = 0, numSkipped = 0;
+    qint64 recorded = 0;
+    qint64 bytes = 0;
+    foreach (const RenderJob * job, m_jobs)
+    {
+        QJsonObject entry;
+        entry["demo"] = job->demoPath;
+        if (job->succeeded)
+        {
+            entry["status"] = QString("done");
+            entry["output"] = job->outputPath;
+            entry["size_bytes"] = (double)job->size;
+            numDone++;
+            recorded += job->duration;
+            bytes += job->size;
+        }
+        else
+        {
+            entry["status"] = QString(job->skipped ? "skipped" : "failed");
+            entry["error"] = job->error;
+            if (job->skipped)
+                numSkipped++;
+            else
+                numFailed++;
+        }
+        entry["recorded_seconds"] = job->duration/1000.0;
+        entry["render_seconds"] = job->elapsed/1000.0;
+        entry["video_frames"] = (double)(job->duration * m_settings.framerate / 1000);
+        if (job->succeeded && job->elapsed > 0)
+            entry["speed"] = (double)job->duration / job->elapsed;
+        jobs.append(entry);
+    }
+
+    QJsonObject result;
+    result["settings"] = settings;
+    result["engines"] = m_maxEngines;
+    result["videos"] = m_jobs.size();
+    result["done"] = numDone;
+    result["failed"] = numFailed;
+    result["skipped"] = numSkipped;
+    result["wall_seconds"] = m_elapsed/1000.0;
+    result["recorded_seconds"] = recorded/1000.0;
+    result["output_bytes"] = (double)bytes;
+    if (m_elapsed > 0)
+    {
+        // how much faster than real time the whole batch was rendered
+        result["speed"] = (double)recorded / m_elapsed;
+        result["video_frames_per_second"] = recorded * m_settings.framerate / (double)m_elapsed;
+    }
+    result["jobs"] = jobs;
+
+    return QJsonDocument(result).toJson();
+}
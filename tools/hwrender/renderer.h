@@ -0,0 +1,138 @@
+/*
+ * Hedgewars, a free turn based strategy game
+ * Copyright (c) 2004-2015 Andrey Korotaev <unC0Rr@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#ifndef RENDERER_H
+#define RENDERER_H
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QByteArray>
+#include <QList>
+#include <QElapsedTimer>
+#include <QPointer>
+#include <QProcess>
+
+class QTcpServer;
+class QTcpSocket;
+
+// settings shared by all videos of a batch
+struct RenderSettings
+{
+    QString engine;
+    QString dataDir;
+    QString userDir;   // the engine reads and writes VideoTemp/ in here
+    QString outputDir;
+    QString format;
+    QString videoCodec;
+    QString audioCodec; // "no" for silent videos
+    int width;
+    int height;
+    int framerate;
+    int bitrate;       // in kbit/s
+    bool software;     // render with Mesa's software rasterizer, without a display
+    bool verbose;      // show engine output
+};
+
+// One video being rendered by its own engine, talking the same IPC protocol
+// as HWRecorder in the frontend.
+class RenderJob : public QObject
+{
+        Q_OBJECT
+
+    public:
+        RenderJob(const RenderSettings & settings, const QString & demoPath);
+        ~RenderJob();
+
+        void start();
+
+        QString name;       // demo file name without extension
+        QString demoPath;
+        QString outputPath; // set once the video is done
+        QString error;      // empty unless the job failed or was skipped
+        bool skipped;
+        bool succeeded;
+        float progress;
+        qint64 duration;    // length of the recording in ms, 0 if unknown
+        qint64 elapsed;     // time spent rendering in ms
+        qint64 size;        // size of the video in bytes
+
+    signals:
+        void finished();
+
+    private:
+        const RenderSettings & m_settings;
+        QPointer<QTcpServer> m_server;
+        QPointer<QTcpSocket> m_socket;
+        QProcess * m_process;
+        QByteArray m_demo;
+        QByteArray m_readBuffer;
+        QElapsedTimer m_timer;
+        bool m_done;  // engine reported that the video is complete
+        bool m_ended; // finished() was emitted
+
+        bool prepare();
+        QStringList arguments() const;
+        void fail(const QString & message);
+        void collectOutput();
+        void cleanup();
+        void end();
+
+    private slots:
+        void newConnection();
+        void readyRead();
+        void processFinished(int exitCode, QProcess::ExitStatus exitStatus);
+        void processError(QProcess::ProcessError error);
+};
+
+// Renders a list of demos with a fixed number of engines running at once.
+class Renderer : public QObject
+{
+        Q_OBJECT
+
+    public:
+        Renderer(const RenderSettings & settings, int maxEngines);
+        ~Renderer();
+
+        void addDemo(const QString & demoPath);
+        void start();
+
+        QByteArray report() const; // JSON summary, valid once done() was emitted
+        bool allSucceeded() const;
+
+    signals:
+        void done();
+
+    private:
+        RenderSettings m_settings;
+        int m_maxEngines;
+        int m_running;
+        int m_numFinished;
+        QList<RenderJob*> m_jobs;
+        QList<RenderJob*> m_queue;
+        QElapsedTimer m_timer;
+        qint64 m_elapsed;
+
+        void startNext();
+
+    private slots:
+        void jobFinished();
+};
+
+#endif // RENDERER_H